@@ -0,0 +1,42 @@
+#pragma once
+// 基准程序（bench/*.cpp）的公共部分：计时与堆分配计数
+// - 整段运行（程序跑到停止、一轮调度等）用 seconds 计时；可重复 ops 次的操作用 measure 预热后计时
+// 替换全局 operator new / delete，只能被每个基准程序中的一个源文件包含
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace Bench{
+    inline std::atomic<uint64_t> allocations{0};
+
+    inline double seconds(std::chrono::steady_clock::time_point t0){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    // 调用 f(ops) 一次预热，再计时调用一次，按 ops 个操作换算；items 非 0 时额外报告每秒 items 数
+    // （指令数、字节数等，单位由 unit 给出）
+    template<typename F>
+    void measure(const char* name, uint64_t ops, F f, double items = 0, const char* unit = nullptr){
+        f(ops / 10 + 1);
+        uint64_t a0 = allocations.load(std::memory_order_relaxed);
+        auto t0 = std::chrono::steady_clock::now();
+        f(ops);
+        double t = seconds(t0);
+        double allocs = double(allocations.load(std::memory_order_relaxed) - a0) / ops;
+
+        printf("  %-28s %10.2f ns/op %9.2f allocs/op", name, t * 1e9 / ops, allocs);
+        if (items > 0) printf("  %9.1f M%s/s", items * ops / t / 1e6, unit);
+        printf("\n");
+    }
+}
+
+void* operator new(size_t size){
+    Bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
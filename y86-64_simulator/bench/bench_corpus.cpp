@@ -0,0 +1,80 @@
+// 吞吐量语料（corpus/，make corpus 生成）在各执行引擎上的 MIPS，同时核对参考终态
+//   用法：bench_corpus [最大指令数]
+//   默认跳过超过 10^8 条指令的程序；SEQ 只运行不超过 10^7 条的程序
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "bench.h"
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// 与 y86gen --final 的输出格式相同
+static std::string finalJSON(const CPU& cpu, uint64_t steps) {
+    std::string out = "{\n  \"STEPS\": " + std::to_string(steps) + ",\n  \"FINAL\":\n";
+    appendStateJSON(out, cpu, 1);
+    return out + "\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t limit = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 100000000;
+
+    std::vector<std::string> names;
+    if (DIR* d = opendir("corpus")) {
+        while (struct dirent* e = readdir(d)) {
+            std::string name = e->d_name;
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, ".yo") == 0) names.push_back(name.substr(0, name.size() - 3));
+        }
+        closedir(d);
+    }
+    if (names.empty()) {
+        printf("no programs in corpus/ (run make corpus)\n");
+        return 1;
+    }
+    std::sort(names.begin(), names.end());
+
+    printf("%-14s %12s %10s %10s %10s\n", "program", "steps", "SEQ", "THREADED", "JIT");
+    bool allOk = true;
+    for (const auto& name : names) {
+        std::string text = readFile("corpus/" + name + ".yo");
+        std::string expected = readFile("corpus/" + name + ".final.json");
+        size_t at = expected.find("\"STEPS\": ");
+        uint64_t steps = at == std::string::npos ? 0 : std::strtoull(expected.c_str() + at + 9, nullptr, 10);
+        if (steps > limit) continue;
+
+        printf("%-14s %12llu", name.c_str(), static_cast<unsigned long long>(steps));
+        for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+            if (engine == Engine::SEQ && steps > 10000000) {
+                printf(" %10s", "-");
+                continue;
+            }
+            Memory mem;
+            CPU cpu(mem);
+            Loader::load(text.data(), text.size(), mem);
+            cpu.engine = engine;
+
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t n = cpu.run(UINT64_MAX);
+            double t = Bench::seconds(t0);
+            bool ok = finalJSON(cpu, n) == expected;
+            allOk = allOk && ok;
+            printf(ok ? " %10.1f" : " %9.1f!", n / t / 1e6);
+        }
+        printf("\n");
+    }
+    printf("(MIPS；! 表示终态与 .final.json 不一致)\n");
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// 常驻模式的请求延迟：同一进程内的服务线程 + 阻塞式客户端，经 Unix 域套接字往返
+//   用法：bench_daemon [请求数]
+//   STEP：单步并返回状态与本步写过的内存字；RESET + RUN：从镜像恢复后整段运行；STATE_JSON：完整状态
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../include/global.h"
+#include "../include/daemon.h"
+#include "bench.h"
+
+using namespace DaemonProto;
+
+// 计数循环：STEP 不会很快停下
+static const char* PROGRAM =
+    "0x000: 30f0ffffffffffffff00 | irmovq $N, %rax\n"
+    "0x00a: 30f30100000000000000 | irmovq $1, %rbx\n"
+    "0x014: 6130                 | loop: subq %rbx, %rax\n"
+    "0x016: 400f0001000000000000 | rmmovq %rax, 0x100\n"
+    "0x020: 741400000000000000   | jne loop\n"
+    "0x029: 00                   | halt\n";
+
+// 发送 n 次同一请求，返回每次往返的耗时（微秒），排序后便于取分位数
+static std::vector<double> measure(DaemonClient& client, uint8_t op, const std::string& payload, int n) {
+    std::vector<double> us;
+    uint8_t result;
+    std::string reply;
+    for (int i = 0; i < n; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (!client.call(op, 1, payload, result, reply) || result != OK) {
+            fprintf(stderr, "request failed\n");
+            exit(1);
+        }
+        us.push_back(Bench::seconds(t0) * 1e6);
+    }
+    std::sort(us.begin(), us.end());
+    return us;
+}
+
+static void report(const char* name, const std::vector<double>& us) {
+    double sum = 0;
+    for (double v : us) sum += v;
+    printf("%-12s %7.2f us mean, p50 %6.2f, p99 %6.2f\n", name, sum / us.size(), us[us.size() / 2],
+           us[us.size() * 99 / 100]);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    std::string path = "/tmp/bench_daemon." + std::to_string(getpid()) + ".sock";
+    DaemonOptions options;
+    options.engine = Engine::THREADED;
+    Daemon daemon(options);
+    if (!daemon.listen(path)) {
+        fprintf(stderr, "cannot listen on %s\n", path.c_str());
+        return 1;
+    }
+    std::thread server([&] { daemon.serve(); });
+
+    DaemonClient client;
+    uint8_t result;
+    std::string reply;
+    if (!client.connect(path) || !client.call(LOAD, 1, PROGRAM, result, reply) || result != OK) {
+        fprintf(stderr, "cannot load program\n");
+        return 1;
+    }
+
+    measure(client, STEP, "", n / 10);  // 预热
+    report("STEP", measure(client, STEP, "", n));
+    report("STATE_JSON", measure(client, STATE_JSON, "", n / 10));
+
+    uint64_t budget = 1000;
+    std::string run(reinterpret_cast<const char*>(&budget), 8);
+    std::vector<double> us;
+    for (int i = 0; i < n / 10; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        client.call(RESET, 1, "", result, reply);
+        client.call(RUN, 1, run, result, reply);
+        us.push_back(Bench::seconds(t0) * 1e6);
+    }
+    std::sort(us.begin(), us.end());
+    report("RESET+RUN1k", us);
+
+    daemon.stop();
+    server.join();
+    return 0;
+}
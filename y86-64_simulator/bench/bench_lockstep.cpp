@@ -0,0 +1,95 @@
+// 多实例锁步执行与 N 个独立 CPU 的对比：同一程序、每个实例不同输入，报告每秒执行的 lane 指令数
+//   用法：bench_lockstep [循环轮数]
+//   converged：所有实例循环次数相同（始终同一 PC）；divergent：循环次数与分支方向随输入变化
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/lockstep.h"
+#include "bench.h"
+
+// %rdi 轮的混合运算循环，结果写入内存；奇数轮多走一个分支
+static const char* PROGRAM =
+    "0x000: 30f30100000000000000 | irmovq $1, %rbx\n"
+    "0x00a: 30f50300000000000000 | irmovq $3, %rbp\n"
+    "0x014: 6277                 | loop: andq %rdi, %rdi\n"
+    "0x016: 734e00000000000000   | je done\n"
+    "0x01f: 6060                 | addq %rsi, %rax\n"
+    "0x021: 6306                 | xorq %rax, %rsi\n"
+    "0x023: 2071                 | rrmovq %rdi, %rcx\n"
+    "0x025: 6231                 | andq %rbx, %rcx\n"
+    "0x027: 734100000000000000   | je even\n"
+    "0x030: 6050                 | addq %rbp, %rax\n"
+    "0x032: 2562                 | cmovge %rsi, %rdx\n"
+    "0x034: 6120                 | subq %rdx, %rax\n"
+    "0x036: 6137                 | subq %rbx, %rdi\n"
+    "0x038: 701400000000000000   | jmp loop\n"
+    "0x041: 6060                 | even: addq %rsi, %rax\n"
+    "0x043: 6137                 | subq %rbx, %rdi\n"
+    "0x045: 701400000000000000   | jmp loop\n"
+    "0x04e: 40000008000000000000 | done: rmmovq %rax, 0x800\n"
+    "0x058: 00                   | halt\n";
+
+static word_t rounds(size_t lane, uint64_t base, bool divergent) {
+    return static_cast<word_t>(divergent ? base / 2 + (lane * 7919) % base : base);
+}
+
+static double runScalar(const std::string& text, size_t lanes, uint64_t base, bool divergent, Engine engine) {
+    std::vector<std::unique_ptr<Memory>> mems;
+    std::vector<std::unique_ptr<CPU>> cpus;
+    for (size_t i = 0; i < lanes; i++) {
+        mems.emplace_back(new Memory());
+        cpus.emplace_back(new CPU(*mems.back()));
+        Loader::load(text.data(), text.size(), *mems.back());
+        cpus.back()->engine = engine;
+        cpus.back()->reg.setReg(Reg::RDI, rounds(i, base, divergent));
+        cpus.back()->reg.setReg(Reg::RSI, static_cast<word_t>(i));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t steps = 0;
+    for (auto& cpu : cpus) steps += cpu->run(UINT64_MAX);
+    return steps / Bench::seconds(t0);
+}
+
+static double runLockstep(const std::string& text, size_t lanes, uint64_t base, bool divergent, uint64_t& groups) {
+    LockstepCPU ls(lanes);
+    ls.load(text.data(), text.size());
+    for (size_t i = 0; i < lanes; i++) {
+        ls.setReg(i, Reg::RDI, rounds(i, base, divergent));
+        ls.setReg(i, Reg::RSI, static_cast<word_t>(i));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t steps = ls.run(UINT64_MAX);
+    double rate = steps / Bench::seconds(t0);
+    groups = steps / std::max<uint64_t>(ls.groups(), 1);  // 每组平均 lane 数
+    return rate;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t base = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 20000;
+    std::string text = PROGRAM;
+
+    printf("%-10s %6s %12s %12s %12s %12s %8s\n", "workload", "lanes", "seq", "threaded", "jit", "lockstep",
+           "avg/grp");
+    for (bool divergent : {false, true}) {
+        for (size_t lanes : {4, 16, 64, 256}) {
+            uint64_t perLane = base * 64 / lanes;  // 各行总指令数大致相同
+            uint64_t width;
+            double seq = runScalar(text, lanes, perLane, divergent, Engine::SEQ);
+            double threaded = runScalar(text, lanes, perLane, divergent, Engine::THREADED);
+            double jit = runScalar(text, lanes, perLane, divergent, Engine::JIT);
+            double ls = runLockstep(text, lanes, perLane, divergent, width);
+            printf("%-10s %6zu %9.1f M/s %9.1f M/s %9.1f M/s %9.1f M/s %8llu\n", divergent ? "divergent" : "converged",
+                   lanes, seq / 1e6, threaded / 1e6, jit / 1e6, ls / 1e6, static_cast<unsigned long long>(width));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+// 内存字访问微基准：
+//   1. 访问层本身：逐字节拼装（原实现）与 Memory::readWord / writeWord 在栈式访问模式下的对比
+//   2. 放大的 test/pushtest.yo：pushq / popq / call / ret 密集的循环在各执行引擎上的 MIPS
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "bench.h"
+
+// 原实现的逐字节读写（只保留热路径，用作对照）
+static word_t loopRead(const byte_t* data, addr_t addr) {
+    word_t value = 0;
+    for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(data[addr + i]) << (8 * i);
+    return value;
+}
+
+static void loopWrite(byte_t* data, addr_t addr, word_t val) {
+    for (int i = 0; i < 8; i++) data[addr + i] = val >> (8 * i) & 0xFF;
+}
+
+// 模拟 push / pop：在 [0x1000, 0x2000) 内上下移动的栈指针
+static void benchAccessors(uint64_t n) {
+    Memory mem;
+    byte_t* raw = mem.data.data();
+    bool error;
+    word_t sum = 0;
+
+    printf("accessors (write + read pair):\n");
+    Bench::measure("byte loop", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) {
+            addr_t sp = 0x1000 + (i & 0x1FF) * 8;
+            loopWrite(raw, sp, static_cast<word_t>(i));
+            sum += loopRead(raw, sp);
+        }
+    });
+    Bench::measure("Memory::writeWord/readWord", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) {
+            addr_t sp = 0x1000 + (i & 0x1FF) * 8;
+            mem.writeWord(sp, static_cast<word_t>(i));
+            sum -= mem.readWord(sp, error);
+        }
+    });
+    printf("  (checksum %lld)\n", static_cast<long long>(sum));
+}
+
+// pushtest.yo 放大为 N 轮循环：每轮 pushq / popq 各 4 次，外加 call / ret
+static std::string pushProgram(uint64_t iterations) {
+    char imm[17];
+    snprintf(imm, sizeof(imm), "%016llx", static_cast<unsigned long long>(iterations));
+    std::string le;
+    for (int i = 7; i >= 0; i--) le += std::string(imm + 2 * i, 2);  // 小端序立即数
+
+    return
+        "0x000: 30f40020000000000000 | irmovq $0x2000, %rsp\n"
+        "0x00a: 30f0" + le + " | irmovq $N, %rax\n"
+        "0x014: 30f30100000000000000 | irmovq $1, %rbx\n"
+        "0x01e: a00f                 | loop: pushq %rax\n"
+        "0x020: a03f                 | pushq %rbx\n"
+        "0x022: a04f                 | pushq %rsp\n"
+        "0x024: a06f                 | pushq %rsi\n"
+        "0x026: 805000000000000000   | call func\n"
+        "0x02f: b06f                 | popq %rsi\n"
+        "0x031: b02f                 | popq %rdx\n"
+        "0x033: b03f                 | popq %rbx\n"
+        "0x035: b00f                 | popq %rax\n"
+        "0x037: 6130                 | subq %rbx, %rax\n"
+        "0x039: 741e00000000000000   | jne loop\n"
+        "0x042: 00                   | halt\n"
+        "0x050: 90                   | func: ret\n";
+}
+
+static void benchEngine(const char* name, Engine engine, const std::string& prog) {
+    Memory mem;
+    CPU cpu(mem);
+    std::string yo = prog;
+    if (!Loader::load(yo, mem)) {
+        printf("%s: load failed\n", name);
+        return;
+    }
+    cpu.engine = engine;
+
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t steps = cpu.run(UINT64_MAX);
+    double t = Bench::seconds(t0);
+    printf("%-9s %llu steps, %.1f MIPS (stat %d)\n", name, static_cast<unsigned long long>(steps),
+           steps / t / 1e6, static_cast<int>(cpu.stat));
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 2000000;
+
+    benchAccessors(iterations * 8);
+
+    std::string prog = pushProgram(iterations);
+    benchEngine("seq", Engine::SEQ, prog);
+    benchEngine("threaded", Engine::THREADED, prog);
+    benchEngine("jit", Engine::JIT, prog);
+    return 0;
+}
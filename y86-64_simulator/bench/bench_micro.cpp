@@ -0,0 +1,253 @@
+// 热点函数的微基准：每项报告 ns/op、每个操作的堆分配次数，以及每秒的指令数 / 字节数
+//   用法：bench_micro [规模倍数]
+//   1. CPU::step 按指令类别（SEQ / THREADED 逐条 step），另附 THREADED / JIT 的 run
+//   2. Memory::readWord / writeWord：连续区顺序与随机访问、分页区访问
+//   3. Loader::load：test/ 下的小程序、生成的大程序（.yo 与 .ybo）
+//   4. printStateJSON / appendStateJSON：稀疏与稠密内存
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/yo_builder.h"
+#include "bench.h"
+
+static const int BODY = 32;  // 循环体内同类指令的条数
+
+// 计数循环：循环体为 BODY 条（组）同类指令，%r14 为剩余轮数
+static std::string opcodeLoop(const std::function<void(YoBuilder&, int)>& body, uint64_t iterations) {
+    YoBuilder b;
+    b.irmovq(iterations, Reg::R14);
+    b.irmovq(1, Reg::R13);
+    b.irmovq(0x1800, Reg::RSP);
+    b.irmovq(0x1000, Reg::RBP);
+    b.irmovq(5, Reg::RAX);
+    b.label("loop");
+    for (int i = 0; i < BODY; i++) body(b, i);
+    b.opq(ALU::SUB, Reg::R13, Reg::R14);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+    b.org(0x0f00);
+    b.label("func");
+    b.ret();
+    return b.text();
+}
+
+struct OpcodeClass {
+    const char* name;
+    int perItem;  // 每组的指令条数
+    std::function<void(YoBuilder&, int)> body;
+};
+
+static const std::vector<OpcodeClass>& opcodeClasses() {
+    static const std::vector<OpcodeClass> classes = {
+        {"nop", 1, [](YoBuilder& b, int) { b.nop(); }},
+        {"irmovq", 1, [](YoBuilder& b, int) { b.irmovq(7, Reg::RCX); }},
+        {"rrmovq", 1, [](YoBuilder& b, int) { b.rrmovq(Reg::RAX, Reg::RCX); }},
+        {"cmovle", 1, [](YoBuilder& b, int) { b.cmov(Cond::LE, Reg::RAX, Reg::RCX); }},
+        {"OPq", 1, [](YoBuilder& b, int) { b.opq(ALU::ADD, Reg::RAX, Reg::RCX); }},
+        {"rmmovq", 1, [](YoBuilder& b, int i) { b.rmmovq(Reg::RAX, i * 8, Reg::RBP); }},
+        {"mrmovq", 1, [](YoBuilder& b, int i) { b.mrmovq(i * 8, Reg::RBP, Reg::RCX); }},
+        {"jXX (taken)", 1, [](YoBuilder& b, int i) {
+            std::string next = "j" + std::to_string(i);
+            b.jxx(Cond::GE, next);
+            b.label(next);
+        }},
+        {"pushq+popq", 2, [](YoBuilder& b, int) { b.pushq(Reg::RAX); b.popq(Reg::RCX); }},
+        {"call+ret", 2, [](YoBuilder& b, int) { b.call("func"); }},
+    };
+    return classes;
+}
+
+// 每个类别执行约 instructions 条指令
+static void benchStep(uint64_t instructions) {
+    printf("CPU::step by opcode class (ns per instruction / MIPS):\n");
+    printf("  %-14s %14s %14s %14s %14s %7s\n", "", "SEQ step", "THREADED step", "THREADED run", "JIT run", "allocs");
+    for (const OpcodeClass& c : opcodeClasses()) {
+        uint64_t perIter = BODY * c.perItem + 2;
+        std::string text = opcodeLoop(c.body, instructions / perIter + 1);
+        printf("  %-14s", c.name);
+
+        uint64_t allocs = 0;
+        for (int mode = 0; mode < 4; mode++) {
+            Memory mem;
+            CPU cpu(mem);
+            if (!Loader::load(text.data(), text.size(), mem)) {
+                printf(" load failed\n");
+                return;
+            }
+            cpu.engine = mode == 0 ? Engine::SEQ : mode == 3 ? Engine::JIT : Engine::THREADED;
+
+            uint64_t a0 = Bench::allocations.load();
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t steps = 0;
+            if (mode < 2) {
+                while (cpu.stat == Stat::AOK) {
+                    cpu.step();
+                    steps++;
+                }
+            }
+            else {
+                steps = cpu.run(UINT64_MAX);
+            }
+            double t = Bench::seconds(t0);
+            allocs += Bench::allocations.load() - a0;
+            if (cpu.stat != Stat::HLT) printf(" (stat %d)", static_cast<int>(cpu.stat));
+            printf(" %7.2f / %5.0f", t * 1e9 / steps, steps / t / 1e6);
+        }
+        // 分配只在 JIT 首次翻译等一次性的场合发生，按四列的总次数报告
+        printf(" %7llu\n", static_cast<unsigned long long>(allocs));
+    }
+}
+
+static void benchMemory(uint64_t n) {
+    printf("Memory::readWord / writeWord:\n");
+    bool error;
+    word_t sum = 0;
+
+    Memory dense;
+    Bench::measure("writeWord dense seq", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) dense.writeWord((i * 8) & 0x1ff8, i);
+    });
+    Bench::measure("readWord dense seq", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) sum += dense.readWord((i * 8) & 0x1ff8, error);
+    });
+    Bench::measure("readWord dense random", n, [&](uint64_t k) {
+        uint64_t x = 88172645463325252ull;
+        for (uint64_t i = 0; i < k; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sum += dense.readWord(x & 0x1ff8, error);
+        }
+    });
+    Bench::measure("readWord out of range", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) sum += dense.readWord(0x10000 + i, error);
+    });
+
+    Memory paged(addr_t(1) << 24);
+    Bench::measure("writeWord paged (16 pages)", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) paged.writeWord(0x100000 + ((i * 8) & 0xfff8), i);
+    });
+    Bench::measure("readWord paged (16 pages)", n, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) sum += paged.readWord(0x100000 + ((i * 8) & 0xfff8), error);
+    });
+    if (sum == 42) printf("\n");  // 防止读取被优化掉
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void benchLoader(uint64_t n) {
+    printf("Loader::load:\n");
+
+    std::vector<std::string> small;
+    size_t smallBytes = 0;
+    if (DIR* d = opendir("test")) {
+        while (struct dirent* e = readdir(d)) {
+            std::string name = e->d_name;
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, ".yo") == 0) {
+                small.push_back(readFile("test/" + name));
+                smallBytes += small.back().size();
+            }
+        }
+        closedir(d);
+    }
+    if (!small.empty()) {
+        Memory mem;
+        Bench::measure("test/*.yo (per file)", n / 10 * small.size(), [&](uint64_t k) {
+            for (uint64_t i = 0; i < k; i++) Loader::load(small[i % small.size()].data(), small[i % small.size()].size(), mem);
+        }, double(smallBytes) / small.size(), "B");
+    }
+
+    // 约 10000 条指令、约 0.5 MB 的 .yo
+    YoBuilder b;
+    b.irmovq(1, Reg::RAX);
+    for (int i = 0; i < 10000; i++) {
+        if (i % 3 == 0) b.irmovq(i, Reg::RCX);
+        else if (i % 3 == 1) b.rmmovq(Reg::RCX, i * 8, Reg::NONE);
+        else b.opq(ALU::ADD, Reg::RCX, Reg::RAX);
+    }
+    b.halt();
+    std::string large = b.text();
+    Memory mem(0x40000);
+    Image info;
+    Loader::load(large.data(), large.size(), mem, &info);
+    std::string image = Loader::buildImage(mem, info);
+
+    Bench::measure("large .yo", n / 1000 + 1, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) Loader::load(large.data(), large.size(), mem);
+    }, large.size(), "B");
+    Bench::measure("large .ybo", n / 100 + 1, [&](uint64_t k) {
+        for (uint64_t i = 0; i < k; i++) Loader::load(image.data(), image.size(), mem);
+    }, image.size(), "B");
+}
+
+// 丢弃写入的 streambuf：计时只包含格式化，不包含终端 / 文件 I/O
+class NullBuf : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+static void benchJSON(uint64_t n) {
+    printf("printStateJSON / appendStateJSON:\n");
+
+    Memory sparse;
+    CPU small(sparse);
+    std::string prog = readFile("test/prog1.yo");
+    Loader::load(prog.data(), prog.size(), sparse);
+    small.run(10000);
+
+    Memory full;
+    CPU dense(full);
+    for (addr_t a = 0; a < full.size(); a += 8) full.writeWord(a, a * 0x0101010101);
+    for (int r = 0; r < Reg::NONE; r++) dense.reg.setReg(static_cast<Reg::ID>(r), -r * 1000003);
+
+    NullBuf null;
+    std::streambuf* saved = std::cout.rdbuf(&null);
+    std::string out;
+    for (auto& c : {std::make_pair("sparse", &small), std::make_pair("dense", &dense)}) {
+        size_t words = 0;
+        c.second->mem.forEachLiveWord([&](addr_t, word_t) { words++; });
+        std::string name = std::string("print ") + c.first + " (" + std::to_string(words) + " words)";
+        uint64_t ops = words > 100 ? n / 100 : n / 10;
+        Bench::measure(name.c_str(), ops, [&](uint64_t k) {
+            for (uint64_t i = 0; i < k; i++) printStateJSON(*c.second, 2);
+        });
+        out.clear();
+        appendStateJSON(out, *c.second, 2);
+        size_t bytes = out.size();
+        name = std::string("append ") + c.first;
+        Bench::measure(name.c_str(), ops, [&](uint64_t k) {
+            for (uint64_t i = 0; i < k; i++) {
+                out.clear();
+                appendStateJSON(out, *c.second, 2);
+            }
+        }, bytes, "B");
+    }
+    std::cout.rdbuf(saved);
+}
+
+int main(int argc, char* argv[]) {
+    double scale = argc > 1 ? std::atof(argv[1]) : 1;
+    uint64_t n = static_cast<uint64_t>(1000000 * scale) + 1;
+
+    benchStep(n * 5);
+    benchMemory(n * 20);
+    benchLoader(n / 10);
+    benchJSON(n / 10);
+    return 0;
+}
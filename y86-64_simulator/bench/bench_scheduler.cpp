@@ -0,0 +1,101 @@
+// 工作窃取调度器的扩展性：长短混合的程序集在 1..N 个线程上的墙钟时间与加速比
+//   用法：bench_scheduler [最大线程数] [长程序轮数]
+//   少量长程序（约 3 * 轮数 步）混在大量短程序中，比较分片（默认 4096 条）与不分片
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/scheduler.h"
+#include "bench.h"
+
+// 计数循环：约 3 * n 步
+static std::string countdown(uint64_t n) {
+    char imm[17];
+    snprintf(imm, sizeof(imm), "%016llx", static_cast<unsigned long long>(n));
+    std::string le;
+    for (int i = 7; i >= 0; i--) le += std::string(imm + 2 * i, 2);  // 小端序立即数
+
+    return "0x000: 30f0" + le + " | irmovq $N, %rax\n"
+           "0x00a: 30f30100000000000000 | irmovq $1, %rbx\n"
+           "0x014: 6130                 | loop: subq %rbx, %rax\n"
+           "0x016: 400f0001000000000000 | rmmovq %rax, 0x100\n"
+           "0x020: 741400000000000000   | jne loop\n"
+           "0x029: 00                   | halt\n";
+}
+
+class ProgramTask : public SliceTask {
+    public:
+        explicit ProgramTask(const std::string& text) : text(text) {}
+
+        bool resume(uint64_t budget) override {
+            if (!cpu) {
+                mem.reset(new Memory());
+                cpu.reset(new CPU(*mem));
+                cpu->engine = Engine::THREADED;
+                if (!Loader::load(text.data(), text.size(), *mem)) return true;
+            }
+            steps += cpu->run(budget);
+            if (cpu->stat == Stat::AOK) return false;
+            cpu.reset();
+            mem.reset();
+            return true;
+        }
+
+        std::string text;
+        uint64_t steps = 0;
+
+    private:
+        std::unique_ptr<Memory> mem;
+        std::unique_ptr<CPU> cpu;
+};
+
+static double runCorpus(const std::vector<std::string>& corpus, unsigned threads, uint64_t slice, uint64_t& steps,
+                        uint64_t& steals) {
+    std::vector<std::unique_ptr<ProgramTask>> tasks;
+    std::vector<SliceTask*> ptrs;
+    for (const auto& text : corpus) {
+        tasks.emplace_back(new ProgramTask(text));
+        ptrs.push_back(tasks.back().get());
+    }
+
+    WorkStealingScheduler scheduler(threads, slice);
+    auto t0 = std::chrono::steady_clock::now();
+    scheduler.run(ptrs);
+    double t = Bench::seconds(t0);
+
+    steps = 0;
+    for (const auto& task : tasks) steps += task->steps;
+    steals = scheduler.steals();
+    return t;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned maxThreads = argc > 1 ? std::atoi(argv[1]) : std::max(4u, std::thread::hardware_concurrency());
+    uint64_t longRounds = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 2000000;
+
+    // 每 50 个程序中 1 个长程序，其余为 10..1000 轮的短程序
+    std::vector<std::string> corpus;
+    for (int i = 0; i < 400; i++) corpus.push_back(countdown(i % 50 == 0 ? longRounds : 10 + (i * 37) % 990));
+
+    printf("corpus: %zu programs, hardware threads %u\n", corpus.size(), std::thread::hardware_concurrency());
+    for (uint64_t slice : {uint64_t(0), WorkStealingScheduler::DEFAULT_SLICE}) {
+        double base = 0;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            uint64_t steps, steals;
+            double t = runCorpus(corpus, threads, slice, steps, steals);
+            if (threads == 1) base = t;
+            printf("slice %-5llu threads %-3u %8.1f ms  speedup %5.2fx  %7.1f MIPS  %llu steals\n",
+                   static_cast<unsigned long long>(slice), threads, t * 1e3, base / t, steps / t / 1e6,
+                   static_cast<unsigned long long>(steals));
+        }
+    }
+    return 0;
+}
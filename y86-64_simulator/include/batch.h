@@ -0,0 +1,58 @@
+#pragma once
+#include "global.h"
+#include "cpu.h"
+#include "scheduler.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 批量运行中的一个程序及其结果
+struct BatchJob{
+    std::string name;      // 文件名（不含目录）
+    std::string path;
+    bool loaded = false;
+    uint64_t steps = 0;
+    Stat stat = Stat::AOK;
+    addr_t PC = 0;
+    double seconds = 0;    // 装载 + 运行 + 写出 trace 的耗时
+};
+
+struct BatchOptions{
+    Engine engine = Engine::SEQ;
+    unsigned threads = 0;             // 0 表示硬件线程数
+    uint64_t maxSteps = 10000;        // 与单程序模式相同的步数上限
+    addr_t memSize = Memory::MAX_SIZE;
+    std::string outDir;               // 非空时把每个程序的完整 trace 写到 outDir/<程序名>.json
+    uint64_t slice = WorkStealingScheduler::DEFAULT_SLICE;  // 每片执行的指令数，长程序执行一片后放回队列；0 表示不分片
+};
+
+// 进程内批量运行：程序交给工作窃取调度器（scheduler.h）分片执行，每个程序独立的 Memory + CPU，
+// 第一片执行时装载、最后一片执行完写出 trace 并释放
+// 结果按文件名排序，与线程数、分片大小和完成顺序无关；trace 与单程序模式逐字节相同
+class BatchRunner{
+    public:
+        explicit BatchRunner(const BatchOptions& options) : options(options) {}
+
+        // 加入 dir 下所有 .yo / .ybo 文件，无法打开目录时返回 false
+        bool addDir(const std::string& dir);
+        void addFile(const std::string& path);
+
+        void run();
+
+        // 每个程序一行结果，最后一行为汇总耗时
+        void report(std::ostream& out) const;
+
+        const std::vector<BatchJob>& jobs() const { return list; }
+        unsigned threadCount() const { return threads; }
+        double wallSeconds() const { return wall; }
+        uint64_t slices() const { return sliceCount; }
+        uint64_t steals() const { return stealCount; }
+
+    private:
+        BatchOptions options;
+        std::vector<BatchJob> list;
+        unsigned threads = 0;
+        double wall = 0;
+        uint64_t sliceCount = 0;
+        uint64_t stealCount = 0;
+};
@@ -2,47 +2,236 @@
 #include "global.h"
 #include "register.h"
 #include "memory.h"
+#include "jit.h"
+#include <memory>
+#include <type_traits>
 
-struct ConditionCode{
-    bool zf = true; // zero flag
-    bool sf = false; // signed flag
-    bool of = false; // overflow flag
+// ISA 语义：BasicCPU 与多实例引擎 LockstepCPU（lockstep.h）共用同一份定义
+// T 可以是 word_t，也可以是一次处理多个实例的向量类型（比较与逻辑运算得到逐元素的全 1 / 全 0 掩码）
+// 始终内联：LockstepCPU 在按 AVX2 编译的函数中以向量调用这些模板，不内联时（如 -O0）两边的向量调用约定不一致
+#if defined(__GNUC__)
+#define ISA_INLINE inline __attribute__((always_inline))
+#else
+#define ISA_INLINE inline
+#endif
+
+namespace ISA{
+    // 与 T 等宽的无符号类型：加减按补码回绕，避免有符号溢出（否则与 overflow 内联在一起时可能被当作不会发生）
+    // 向量类型由使用方特化
+    template<typename T>
+    struct UnsignedOf{ using type = typename std::make_unsigned<T>::type; };
+
+    // e = b OP a；op 只能是 ALU::ADD ~ ALU::XOR
+    template<typename T>
+    ISA_INLINE T alu(ALU::Op op, T a, T b){
+        using U = typename UnsignedOf<T>::type;
+        switch (op){
+            case ALU::ADD: return (T)((U)b + (U)a);
+            case ALU::SUB: return (T)((U)b - (U)a);
+            case ALU::AND: return b & a;
+            default:       return b ^ a;
+        }
+    }
+
+    // e = b OP a 是否溢出（AND / XOR 不溢出）
+    template<typename T>
+    ISA_INLINE auto overflow(ALU::Op op, T a, T b, T e){
+        switch (op){
+            case ALU::ADD:
+                // b + a 溢出
+                return (a > 0 && b > 0 && e < 0) || (a < 0 && b < 0 && e > 0);
+            case ALU::SUB:
+                // b - a 溢出 (注意永远是 b Op a , 顺序不要搞反!!!)
+                return (a < 0 && b > 0 && e < 0) || (a > 0 && b < 0 && e > 0);
+            default:
+                return a != a;  // 恒为假
+        }
+    }
+
+    // 条件 fn 是否成立；fn 只能是 Cond::None ~ Cond::G
+    // f 提供 zf() / sf() / of()，只在需要时调用（保持 ConditionCode 的惰性求值）
+    template<typename F>
+    ISA_INLINE auto cond(int fn, const F& f){
+        // bool类型实则占1byte，而非1bit
+        // 故需要用 !,!=,||,&& 取代 ~,^,|,&
+        switch (fn){
+            case Cond::LE: return (f.sf() != f.of()) || f.zf();
+            case Cond::L:  return f.sf() != f.of();         // b < a
+            case Cond::E:  return f.zf();
+            case Cond::NE: return !f.zf();
+            case Cond::GE: return !(f.sf() != f.of());
+            case Cond::G:  return !(f.sf() != f.of()) && !f.zf();   // b > a
+            default:       return f.zf() == f.zf();          // Cond::None：恒为真
+        }
+    }
+}
+
+// 条件码（惰性求值）：OPq 只记录运算与操作数，ZF / SF / OF 在被读取时才计算
+class ConditionCode{
+    public:
+        bool zf() const { return lazy ? e == 0 : zf_; } // zero flag
+        bool sf() const { return lazy ? e < 0 : sf_; }  // signed flag
+        bool of() const { return lazy ? overflow() : of_; } // overflow flag
+
+        void set(bool zf, bool sf, bool of){
+            zf_ = zf;
+            sf_ = sf;
+            of_ = of;
+            lazy = false;
+        }
+
+        // 记录一次 OPq：e = b OP a
+        void record(ALU::Op op, word_t a, word_t b, word_t e){
+            this->op = op;
+            this->a = a;
+            this->b = b;
+            this->e = e;
+            lazy = true;
+        }
+
+        // 把记录的运算固化为三个标志位（JIT 生成的代码直接读写标志位）
+        void materialize(){
+            if (lazy) set(zf(), sf(), of());
+        }
+
+    private:
+        friend class JIT;
+
+        bool zf_ = true;
+        bool sf_ = false;
+        bool of_ = false;
+        bool lazy = false;
+        ALU::Op op = ALU::ADD;
+        word_t a = 0, b = 0, e = 0;
+
+        bool overflow() const { return ISA::overflow(op, a, b, e); }
+};
+
+// 执行引擎
+enum class Engine{
+    SEQ,       // 六阶段 SEQ 参考模型，逐阶段维护全部中间信号
+    THREADED,  // 每条指令只按 icode 分派一次到对应 handler，只维护架构状态
+    JIT        // run() 把基本块翻译为本机代码执行；step() 与 THREADED 相同
 };
 
-class CPU{
+// 插桩策略：BasicCPU 在每条指令执行前调用 onStep，取指成功后调用 onExec，
+// 条件跳转 / 条件传送求出条件后调用 onCond（jmp 与 rrmovq 不调用），在每次成功的数据读写后调用 onRead / onWrite
+// （取指不算数据访问；JIT 执行的本机代码不经过插桩）
+// 不需要插桩时使用 NoHooks，空的内联函数在编译后不留下任何代码
+struct NoHooks{
+    void onStep(addr_t) {}
+    void onExec(int) {}
+    void onCond(int, bool) {}
+    void onRead(addr_t, word_t) {}
+    void onWrite(addr_t, word_t) {}
+};
+
+// 统计执行的指令条数与数据读写次数
+struct CountingHooks{
+    uint64_t steps = 0, reads = 0, writes = 0;
+
+    void onStep(addr_t) { steps++; }
+    void onExec(int) {}
+    void onCond(int, bool) {}
+    void onRead(addr_t, word_t) { reads++; }
+    void onWrite(addr_t, word_t) { writes++; }
+};
+
+// 以内存模型 M 与插桩策略 Hooks 为参数的 CPU
+// M 需要提供 Memory 的读写接口、icache 与 markCode（见 BasicMemory）；Engine::JIT 只对默认实例 CPU 可用，
+// 其他实例按 THREADED 执行。成员定义在 cpu_impl.h 中
+template<typename M = Memory, typename Hooks = NoHooks>
+class BasicCPU{
     public:
-        Memory& mem;
+        M& mem;
         Register reg;
         ConditionCode cc;
+        Hooks hooks;
 
         addr_t PC = 0;
         Stat stat = Stat::AOK;
 
         // 中间信号
         int icode = ICode::NOP;
-        int ifunc;
+        int ifunc = 0;
         Reg::ID rA = Reg::NONE, rB = Reg::NONE;
         word_t valA = 0, valB = 0, valC = 0, valE = 0, valM = 0;
         addr_t valP = 0;
         bool Cnd = false;
 
-        CPU(Memory& memory);
+        Engine engine = Engine::SEQ;
+
+        BasicCPU(M& memory);
+        ~BasicCPU();
         void reset();
-        void step(); // 一套SEQ流程
+        void step(); // 执行一条指令（SEQ 为一套完整流程）
+        uint64_t run(uint64_t maxSteps); // 连续执行至多 maxSteps 条指令，返回实际执行条数
+
+        // 解码 pc 处的指令而不执行（供 JIT / 提前编译器使用）
+        static bool predecode(const M& mem, addr_t pc, DecodedInst& d);
+
+        // JIT 引擎，首次以 Engine::JIT 调用 run() 时创建
+        std::unique_ptr<class JIT> jit;
+
+        // THREADED / JIT 只维护架构状态，上面的中间信号停留在更早的指令上；last 指向最后执行的指令，
+        // 回退到 SEQ 流程（取指未命中预解码缓存）之前据此恢复中间信号，使取指出错时 SEQ 重放的
+        // 译码 / 执行 / 访存 / 写回阶段与一直按 SEQ 执行时相同。len 为 0 表示只记录了 pc（JIT），恢复时重新解码
+        const DecodedInst* last = nullptr;
+
+        // 非法运算 / 条件等诊断信息的输出位置；异步 trace 把它换成自己的缓冲，按步插入输出
+        std::ostream* diag = &std::cout;
 
     private:
+        void stepSEQ();
         bool fetch();
+        bool fetchSlow();
+        void cacheDecoded(uint8_t len);
         bool decode();
         bool execute();
         bool memory_stage();
         bool writeback();
         void updatePC();
 
+        // 经过插桩的数据读写
+        word_t load(addr_t addr, bool& error){
+            word_t val = mem.readWord(addr, error);
+            if (!error) hooks.onRead(addr, val);
+            return val;
+        }
+
+        bool store(addr_t addr, word_t val){
+            bool error = mem.writeWord(addr, val);
+            if (!error) hooks.onWrite(addr, val);
+            return error;
+        }
+
         // execute阶段辅助函数
         void setALU(word_t& aluA, word_t& aluB, ALU::Op& op);
         word_t execALU(const word_t& aluA, const word_t& aluB, const ALU::Op& op);
         void setCC(word_t& aluA, word_t& aluB, ALU::Op& op);
 
         // writeback阶段辅助函数
-        bool cond();
-};
\ No newline at end of file
+        bool cond(int fn) const;
+
+        // THREADED 引擎：每个 icode 一个 handler，直接作用于预解码记录
+        using Handler = void (BasicCPU::*)(const DecodedInst& d);
+        static const Handler handlers[16];
+
+        void opHalt(const DecodedInst& d);
+        void opNop(const DecodedInst& d);
+        void opRrmovq(const DecodedInst& d);
+        void opIrmovq(const DecodedInst& d);
+        void opRmmovq(const DecodedInst& d);
+        void opMrmovq(const DecodedInst& d);
+        void opOpq(const DecodedInst& d);
+        void opJxx(const DecodedInst& d);
+        void opCall(const DecodedInst& d);
+        void opRet(const DecodedInst& d);
+        void opPushq(const DecodedInst& d);
+        void opPopq(const DecodedInst& d);
+        void opInvalid(const DecodedInst& d);
+};
+
+// 默认实例：运行时大小的分页内存，不插桩；在 src/cpu.cpp 中显式实例化
+using CPU = BasicCPU<>;
+extern template class BasicCPU<>;
@@ -0,0 +1,650 @@
+#pragma once
+// BasicCPU 的成员定义。默认实例 CPU 在 src/cpu.cpp 中显式实例化；
+// 使用其他内存模型 / 插桩策略实例化时包含本文件
+#include "global.h"
+#include "register.h"
+#include "memory.h"
+#include "cpu.h"
+#include "jit.h"
+#include <type_traits>
+
+// CHECK_ERR 宏的辅助函数
+inline bool setAddrError(Stat &stat) {
+    stat = Stat::ADR;
+    return false;
+}
+
+// do {...} while (0) 是宏安全标准的封装格式
+// 用于简便的检查错误
+// 避免每次都写 if (error == 1) { stat = Stat::ADR; return false; }
+#define CHECK_ERR(error, stat) \
+    do {                        \
+        if (error)              \
+            return setAddrError(stat); \
+    } while (0)
+
+
+
+// 正式类函数定义的开始
+template<typename M, typename Hooks>
+BasicCPU<M, Hooks>::BasicCPU(M& memory) : mem(memory) {}
+
+template<typename M, typename Hooks>
+BasicCPU<M, Hooks>::~BasicCPU() = default;  // JIT 在这里才是完整类型
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::reset(){
+    reg.reset();
+    cc = ConditionCode();
+    PC = 0;
+    stat = Stat::AOK;
+    // 中间信号回到初始值：复位后第一次取指出错时不重放上一个程序的指令
+    icode = ICode::NOP;
+    ifunc = 0;
+    rA = rB = Reg::NONE;
+    valC = 0;
+    valP = 0;
+    last = nullptr;
+}
+
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::fetch(){
+    // 快路径：命中预解码缓存，直接取出 fetch 阶段的全部信号
+    const DecodedInst* d = mem.icache.lookup(PC);
+    if (d == nullptr) return fetchSlow();
+
+    icode = d->icode;
+    ifunc = d->ifunc;
+    rA = static_cast<Reg::ID>(d->rA);
+    rB = static_cast<Reg::ID>(d->rB);
+    valC = d->valC;
+    valP = d->valP;
+
+    if (icode == ICode::HALT) stat = Stat::HLT;
+
+    return true;
+}
+
+// 未命中缓存：逐字节读取并解析，成功后写入预解码缓存
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::fetchSlow(){
+    // 取得 icode & ifunc
+    bool error;
+    byte_t b0 = mem.readByte(PC, error);
+    CHECK_ERR(error, stat);
+
+    icode = (b0 >> 4) & 0xF;
+    ifunc = b0 & 0xF;
+
+    valP = PC + 1; // 读取 icode & ifunc 后更新 valP 位置
+
+    // 判断类型，执行对应操作
+
+    // 特殊情况 (不需额外读取字节)
+    if (icode == ICode::HALT){
+        stat = Stat::HLT;
+        valP = PC;
+        rA = Reg::NONE;
+        rB = Reg::NONE;
+        cacheDecoded(1);
+        return true;
+    }
+
+    // 其他情况:
+    // 判断需要读取多少字节
+    bool needReg = (icode == ICode::RRMOVQ
+                || icode == ICode::IRMOVQ
+                || icode == ICode::RMMOVQ
+                || icode == ICode::MRMOVQ
+                || icode == ICode::OPQ
+                || icode == ICode::PUSHQ
+                || icode == ICode::POPQ);
+
+    bool needValC = (icode == ICode::IRMOVQ
+                || icode == ICode::MRMOVQ
+                || icode == ICode::RMMOVQ
+                || icode == ICode::JXX
+                || icode == ICode::CALL);
+
+    if (needReg){
+        byte_t b1 = mem.readByte(valP, error);
+        CHECK_ERR(error, stat);
+
+        rA = static_cast<Reg::ID>((b1 >> 4) & 0xF);
+        rB = static_cast<Reg::ID>(b1 & 0xF);
+
+        valP += 1;  // 读取 rA & rB 后更新 valP 位置
+    }
+    else{
+        rA = Reg::NONE;
+        rB = Reg::NONE;
+    }
+
+    if (needValC){
+        valC = mem.readWord(valP, error);
+        CHECK_ERR(error, stat);
+
+        valP += 8;  // 读取 valC 后更新 valP 位置
+    }
+
+    cacheDecoded(static_cast<uint8_t>(valP - PC));
+
+    return true;
+}
+
+// 与 fetchSlow 相同的取指规则，但不修改 CPU 状态；任何字节越界都返回 false
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::predecode(const M& mem, addr_t pc, DecodedInst& d){
+    bool error = false;
+    byte_t b0 = mem.readByte(pc, error);
+    if (error) return false;
+
+    d = DecodedInst();
+    d.pc = pc;
+    d.icode = (b0 >> 4) & 0xF;
+    d.ifunc = b0 & 0xF;
+    addr_t p = pc + 1;
+
+    bool needReg = (d.icode == ICode::RRMOVQ || d.icode == ICode::IRMOVQ
+                 || d.icode == ICode::RMMOVQ || d.icode == ICode::MRMOVQ
+                 || d.icode == ICode::OPQ || d.icode == ICode::PUSHQ
+                 || d.icode == ICode::POPQ);
+    bool needValC = (d.icode == ICode::IRMOVQ || d.icode == ICode::MRMOVQ
+                  || d.icode == ICode::RMMOVQ || d.icode == ICode::JXX
+                  || d.icode == ICode::CALL);
+
+    if (needReg){
+        byte_t b1 = mem.readByte(p, error);
+        if (error) return false;
+        d.rA = (b1 >> 4) & 0xF;
+        d.rB = b1 & 0xF;
+        p += 1;
+    }
+    if (needValC){
+        d.valC = mem.readWord(p, error);
+        if (error) return false;
+        p += 8;
+    }
+
+    d.valP = (d.icode == ICode::HALT) ? pc : p;
+    d.len = static_cast<uint8_t>(p - pc);
+    return true;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::cacheDecoded(uint8_t len){
+    DecodedInst d;
+    d.pc = PC;
+    d.valC = valC;
+    d.valP = valP;
+    d.icode = static_cast<uint8_t>(icode);
+    d.ifunc = static_cast<uint8_t>(ifunc);
+    d.rA = static_cast<uint8_t>(rA);
+    d.rB = static_cast<uint8_t>(rB);
+    d.len = len;
+    if (!mem.markCode(PC, len)) return;  // 分页区的指令不缓存（写入时无法检测自修改）
+    mem.icache.insert(d);
+}
+
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::decode(){
+    Reg::ID srcA = Reg::NONE;
+    Reg::ID srcB = Reg::NONE;
+
+    if (icode == ICode::HALT
+        || icode == ICode::NOP
+        || icode == ICode::RRMOVQ
+        || icode == ICode::IRMOVQ
+        || icode == ICode::RMMOVQ
+        || icode == ICode::MRMOVQ
+        || icode == ICode::OPQ
+    ){
+        srcA = rA;
+        srcB = rB;
+    }
+    else if (icode == ICode::PUSHQ
+        || icode == ICode::POPQ
+        || icode == ICode::CALL
+        || icode == ICode::RET){
+        srcA = rA;          // CALL 不需要 rA, 但这里为了简便服用这个逻辑
+        srcB = Reg::RSP;    // reg[4] = rsp
+    }
+
+    valA = reg.getReg(srcA);
+    valB = reg.getReg(srcB);
+
+
+    return true;
+}
+
+// execute阶段辅助函数
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::setALU(word_t& aluA, word_t& aluB, ALU::Op& op)
+{
+    switch (icode){
+    case ICode::RRMOVQ:
+        aluA = valA;
+        aluB = 0;
+        break;
+    case ICode::IRMOVQ:
+        aluA = valC;
+        aluB = 0;
+        break;
+    case ICode::RMMOVQ:
+        aluA = valC;
+        aluB = valB;
+        break;
+    case ICode::MRMOVQ:
+        aluA = valC;
+        aluB = valB;
+        break;
+    case ICode::OPQ:
+        aluA = valA;
+        aluB = valB;
+        op = static_cast<ALU::Op>(ifunc);
+        break;
+    case ICode::PUSHQ:
+        aluA = -8;
+        aluB = valB;  // rsp
+        break;
+    case ICode::POPQ:
+        aluA = 8;
+        aluB = valB;  // rsp
+        break;
+    case ICode::CALL:
+        aluA = -8;
+        aluB = valB;  // rsp
+        break;
+    case ICode::RET:
+        aluA = 8;
+        aluB = valB;  // rsp
+        break;
+    default:
+        aluA = 0;
+        aluB = 0;
+        break;
+    }
+}
+
+// execute阶段辅助函数
+template<typename M, typename Hooks>
+word_t BasicCPU<M, Hooks>::execALU(const word_t& aluA, const word_t& aluB, const ALU::Op& op){
+    switch (op){
+        case ALU::ADD:
+        case ALU::SUB:
+        case ALU::AND:
+        case ALU::XOR:
+            return ISA::alu(op, aluA, aluB);
+        default:
+            *diag << "ALU报错";
+            return 0;
+    }
+}
+
+// execute阶段辅助函数
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::setCC(word_t& aluA, word_t& aluB, ALU::Op& op){
+    // 只记录本次运算，标志位留到 cond() / 输出状态时再计算
+    switch (op){
+        case ALU::ADD:
+        case ALU::SUB:
+        case ALU::AND:
+        case ALU::XOR:
+            cc.record(op, aluA, aluB, valE);
+            break;
+        default:
+            *diag << "setCC报错";
+            cc.set(valE == 0, valE < 0, cc.of());
+            break;
+    }
+}
+
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::execute(){
+    // 特殊情况: 不需要执行 ALU , 如 JXX
+    if (icode == ICode::JXX) return true;
+
+    // 初始化
+    word_t aluA = 0, aluB = 0;
+    ALU::Op op = ALU::ADD;
+
+    setALU(aluA, aluB, op); // 设置 aluA, aluB, op
+    valE = execALU(aluA, aluB, op);  // ALU模块
+    if (icode == ICode::OPQ) { setCC(aluA, aluB, op); } // 设置 cc (Condition Code)
+
+
+    return true;
+}
+
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::memory_stage() {
+    bool error = false;
+
+    switch (icode) {
+        case ICode::RMMOVQ:
+            // M[valE] ← valA
+            if (store(valE, valA))
+                return setAddrError(stat);
+            break;
+        case ICode::MRMOVQ:
+            // valM ← M[valE]
+            valM = load(valE, error);
+            CHECK_ERR(error, stat);
+            break;
+        case ICode::PUSHQ:
+            // M[valE] ← valA  (valE = rsp - 8)
+            if (store(valE, valA))
+                return setAddrError(stat);
+            break;
+        case ICode::POPQ:
+            // valM ← M[valB]  (valB = old rsp)
+            valM = load(valB, error);
+            CHECK_ERR(error, stat);
+            break;
+        case ICode::CALL:
+            // M[valE] ← valP  (return address)
+            if (store(valE, valP))
+                return setAddrError(stat);
+            break;
+        case ICode::RET:
+            // valM ← M[valB]  (valB = rsp)
+            valM = load(valB, error);
+            CHECK_ERR(error, stat);
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+// writeback阶段辅助函数
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::cond(int fn) const{
+    if (fn < Cond::None || fn > Cond::G){
+        *diag << "条件是否满足判断出错";
+        return false;
+    }
+    return ISA::cond(fn, cc);
+}
+
+template<typename M, typename Hooks>
+bool BasicCPU<M, Hooks>::writeback() {
+    if (stat == Stat::INS || stat == Stat::HLT) return false;
+
+    switch (icode) {
+        case ICode::RRMOVQ:{
+            bool taken = cond(ifunc);
+            if (ifunc != Cond::None) hooks.onCond(icode, taken);
+            if (taken) reg.setReg(rB, valE);      // cmovXX(包含rrmovq)
+            break;
+        }
+        case ICode::IRMOVQ:
+        case ICode::OPQ:
+            reg.setReg(rB, valE);
+            break;
+        case ICode::MRMOVQ:
+            reg.setReg(rA, valM);
+            break;
+        case ICode::PUSHQ:
+            reg.setReg(Reg::RSP, valE);
+            break;
+        case ICode::POPQ:
+            reg.setReg(Reg::RSP, valE);
+            reg.setReg(rA, valM);
+            break;
+        case ICode::CALL:
+            reg.setReg(Reg::RSP, valE);
+            break;
+        case ICode::RET:
+            reg.setReg(Reg::RSP, valE);
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::updatePC() {
+    if (stat != Stat::AOK) return;
+
+    switch (icode) {
+        case ICode::JXX:{
+            bool taken = cond(ifunc);
+            if (ifunc != Cond::None) hooks.onCond(icode, taken);
+            if (taken) {
+                PC = valC;
+                return;
+            }
+            break;
+        }
+        case ICode::CALL:
+            PC = valC;
+            return;
+        case ICode::RET:
+            PC = valM;
+            return;
+        default:
+            break;
+    }
+
+    PC = valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::stepSEQ(){
+    if (last != nullptr){
+        DecodedInst d = *last;
+        if (d.len == 0) predecode(mem, d.pc, d);
+        icode = d.icode;
+        ifunc = d.ifunc;
+        rA = static_cast<Reg::ID>(d.rA);
+        rB = static_cast<Reg::ID>(d.rB);
+        valC = d.valC;
+        valP = d.valP;
+        last = nullptr;
+    }
+    if (fetch()) hooks.onExec(icode);
+    decode();
+    execute();
+    memory_stage();
+    writeback();
+    updatePC();
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::step(){
+    if (stat != Stat::AOK) return;
+    hooks.onStep(PC);
+
+    if (engine == Engine::SEQ){
+        stepSEQ();
+        return;
+    }
+
+    // THREADED: 命中预解码缓存则一次分派完成整条指令
+    // 未命中时走 SEQ 流程（顺带填充缓存），保证取指越界等情形的行为完全一致
+    const DecodedInst* d = mem.icache.lookup(PC);
+    if (d != nullptr){
+        hooks.onExec(d->icode);
+        (this->*handlers[d->icode])(*d);
+        last = d;
+    }
+    else stepSEQ();
+}
+
+template<typename M, typename Hooks>
+uint64_t BasicCPU<M, Hooks>::run(uint64_t maxSteps){
+    uint64_t n = 0;
+
+    if (engine == Engine::SEQ){
+        while (stat == Stat::AOK && n < maxSteps){
+            hooks.onStep(PC);
+            stepSEQ();
+            n++;
+        }
+        return n;
+    }
+
+    if constexpr (std::is_same<BasicCPU, CPU>::value){
+        if (engine == Engine::JIT){
+            if (!jit) jit.reset(new class JIT(*this));
+            return jit->run(maxSteps);
+        }
+    }
+
+    while (stat == Stat::AOK && n < maxSteps){
+        hooks.onStep(PC);
+        const DecodedInst* d = mem.icache.lookup(PC);
+        if (d != nullptr){
+            hooks.onExec(d->icode);
+            (this->*handlers[d->icode])(*d);
+            last = d;
+        }
+        else stepSEQ();
+        n++;
+    }
+    return n;
+}
+
+
+
+// THREADED 引擎的 handler
+// 每个 handler 完成一条指令的全部架构效果，语义（包括出错时的寄存器写回）与 SEQ 流程逐条对应：
+// 访存出错时 stat 置为 ADR，SEQ 的 writeback 仍会执行，但 PC 不再更新
+template<typename M, typename Hooks>
+const typename BasicCPU<M, Hooks>::Handler BasicCPU<M, Hooks>::handlers[16] = {
+    &BasicCPU::opHalt,   &BasicCPU::opNop,    &BasicCPU::opRrmovq, &BasicCPU::opIrmovq,
+    &BasicCPU::opRmmovq, &BasicCPU::opMrmovq, &BasicCPU::opOpq,    &BasicCPU::opJxx,
+    &BasicCPU::opCall,   &BasicCPU::opRet,    &BasicCPU::opPushq,  &BasicCPU::opPopq,
+    &BasicCPU::opInvalid, &BasicCPU::opInvalid, &BasicCPU::opInvalid, &BasicCPU::opInvalid
+};
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opHalt(const DecodedInst&){
+    stat = Stat::HLT;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opNop(const DecodedInst& d){
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opRrmovq(const DecodedInst& d){
+    // cmovXX（包含 rrmovq）
+    bool taken = cond(d.ifunc);
+    if (d.ifunc != Cond::None) hooks.onCond(d.icode, taken);
+    if (taken)
+        reg.setReg(static_cast<Reg::ID>(d.rB), reg.getReg(static_cast<Reg::ID>(d.rA)));
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opIrmovq(const DecodedInst& d){
+    reg.setReg(static_cast<Reg::ID>(d.rB), d.valC);
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opRmmovq(const DecodedInst& d){
+    word_t addr = d.valC + reg.getReg(static_cast<Reg::ID>(d.rB));
+    if (store(addr, reg.getReg(static_cast<Reg::ID>(d.rA)))){
+        stat = Stat::ADR;
+        return;
+    }
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opMrmovq(const DecodedInst& d){
+    bool error = false;
+    word_t addr = d.valC + reg.getReg(static_cast<Reg::ID>(d.rB));
+    reg.setReg(static_cast<Reg::ID>(d.rA), load(addr, error));  // 出错时 readWord 返回 0，与 SEQ 写回一致
+    if (error){
+        stat = Stat::ADR;
+        return;
+    }
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opOpq(const DecodedInst& d){
+    word_t aluA = reg.getReg(static_cast<Reg::ID>(d.rA));
+    word_t aluB = reg.getReg(static_cast<Reg::ID>(d.rB));
+    ALU::Op op = static_cast<ALU::Op>(d.ifunc);
+
+    valE = execALU(aluA, aluB, op);
+    setCC(aluA, aluB, op);
+    reg.setReg(static_cast<Reg::ID>(d.rB), valE);
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opJxx(const DecodedInst& d){
+    bool taken = cond(d.ifunc);
+    if (d.ifunc != Cond::None) hooks.onCond(d.icode, taken);
+    PC = taken ? d.valC : d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opCall(const DecodedInst& d){
+    word_t rsp = reg.getReg(Reg::RSP) - 8;
+    bool error = store(rsp, d.valP);
+    reg.setReg(Reg::RSP, rsp);
+    if (error){
+        stat = Stat::ADR;
+        return;
+    }
+    PC = d.valC;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opRet(const DecodedInst&){
+    bool error = false;
+    word_t rsp = reg.getReg(Reg::RSP);
+    word_t ret = load(rsp, error);
+    reg.setReg(Reg::RSP, rsp + 8);
+    if (error){
+        stat = Stat::ADR;
+        return;
+    }
+    PC = ret;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opPushq(const DecodedInst& d){
+    word_t val = reg.getReg(static_cast<Reg::ID>(d.rA));
+    word_t rsp = reg.getReg(Reg::RSP) - 8;
+    bool error = store(rsp, val);
+    reg.setReg(Reg::RSP, rsp);
+    if (error){
+        stat = Stat::ADR;
+        return;
+    }
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opPopq(const DecodedInst& d){
+    bool error = false;
+    word_t rsp = reg.getReg(Reg::RSP);
+    word_t val = load(rsp, error);
+    reg.setReg(Reg::RSP, rsp + 8);
+    reg.setReg(static_cast<Reg::ID>(d.rA), val);  // popq %rsp 时以读出的值为准
+    if (error){
+        stat = Stat::ADR;
+        return;
+    }
+    PC = d.valP;
+}
+
+template<typename M, typename Hooks>
+void BasicCPU<M, Hooks>::opInvalid(const DecodedInst& d){
+    // 与 SEQ 一致：未知 icode 不产生任何效果，只前进 1 字节
+    PC = d.valP;
+}
+
+#undef CHECK_ERR
@@ -0,0 +1,109 @@
+#pragma once
+#include "global.h"
+#include "cpu.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 常驻模拟器：监听 Unix 域套接字，在同一进程内处理装载 / 运行 / 单步 / 读状态 / 复位请求
+// 装载后的内存保留为镜像，复位时直接复制镜像而不重新解析；每个会话的 Memory 与 CPU 跨请求复用
+//
+// 帧格式（小端序），请求与应答都以 u32 长度开头（不含长度字段本身）
+//   请求   u32 长度, u8 操作, u32 会话号, 负载
+//   应答   u32 长度, u8 结果（0 成功，1 失败，失败时负载为错误信息）, 负载
+// 操作与负载
+//   LOAD        请求：.yo / .ybo 内容          应答：u64 入口
+//   RESET       请求：空                        应答：空
+//   STEP        请求：空                        应答：状态, u32 n, n x (u64 地址, i64 值)  本步写过的内存字
+//   RUN         请求：u64 最多执行的步数        应答：u64 实际步数, 状态
+//               一次至多执行 MAX_RUN_STEPS 步（事件循环不会被一个请求长时间占住，stop() 也能及时生效），
+//               实际步数少于请求且 STAT 仍为 AOK 时，客户端再次发送 RUN 继续
+//   STATE       请求：空                        应答：状态, u32 n, n x (u64 地址, i64 值)  全部非零内存字
+//   STATE_JSON  请求：空                        应答：与 printStateJSON 相同的 JSON（不含分隔的逗号）
+//   FREE        请求：空                        应答：空
+// 状态   u64 累计步数, u64 PC, u8 STAT, u8 CC（第 0/1/2 位依次为 ZF/SF/OF）, 15 x i64 寄存器
+// 会话由客户端编号，不属于某个连接：断开后重新连接仍可继续使用已装载的程序
+namespace DaemonProto{
+    enum Op : uint8_t { LOAD = 1, RESET = 2, STEP = 3, RUN = 4, STATE = 5, STATE_JSON = 6, FREE = 7 };
+    enum Result : uint8_t { OK = 0, ERROR = 1 };
+
+    static const uint32_t MAX_FRAME = 64 << 20;  // 超过此长度的帧视为协议错误并断开连接
+    static const size_t STATE_SIZE = 8 + 8 + 1 + 1 + 15 * 8;
+    static const uint64_t MAX_RUN_STEPS = 1 << 22;  // 单个 RUN 请求执行的步数上限
+}
+
+struct DaemonOptions{
+    Engine engine = Engine::SEQ;
+    addr_t memSize = Memory::MAX_SIZE;
+    size_t maxPending = 64 << 20;  // 连接上尚未写出的应答超过此长度（客户端不读应答）时断开
+};
+
+class Daemon{
+    public:
+        explicit Daemon(const DaemonOptions& options = DaemonOptions());
+        ~Daemon();
+        Daemon(const Daemon&) = delete;
+        Daemon& operator=(const Daemon&) = delete;
+
+        // 处理一个请求，把应答负载写入 reply（不含长度与结果字节），失败时 reply 为错误信息
+        DaemonProto::Result handle(uint8_t op, uint32_t session, const char* payload, size_t size, std::string& reply);
+
+        // 在 path 上监听（已存在的同名套接字文件会被替换），失败时返回 false
+        bool listen(const std::string& path);
+        // 单线程事件循环，直到 stop() 被调用
+        void serve();
+        void stop();  // 可以在其他线程或信号处理函数中调用
+
+        size_t sessionCount() const { return sessions.size(); }
+
+    private:
+        struct Session{
+            std::unique_ptr<Memory> image;  // 装载后的内存
+            addr_t entry = 0;
+            std::unique_ptr<Memory> mem;
+            std::unique_ptr<CPU> cpu;
+            uint64_t steps = 0;             // 复位之后执行的步数
+            std::vector<addr_t> writes;     // STEP 期间的 Memory::writeLog
+        };
+
+        // 应答先放入 out，能写多少写多少，其余等套接字可写（POLLOUT）时继续，事件循环不因某个连接阻塞
+        struct Conn{
+            int fd;
+            std::string in;   // 尚未凑成完整帧的输入
+            std::string out;  // 尚未写出的应答
+        };
+
+        DaemonOptions options;
+        std::map<uint32_t, Session> sessions;
+        int listenFd = -1;
+        int wakeFd[2] = {-1, -1};  // stop() 写入的自管道
+        std::atomic<bool> stopping{false};  // stop() 置位：不再处理已读入的后续请求
+        std::string sockPath;
+        std::vector<Conn> conns;
+
+        void restore(Session& s);
+        void putState(std::string& out, const Session& s) const;
+        bool readConn(Conn& c);
+        bool flushConn(Conn& c);
+};
+
+// 阻塞式客户端：一次发送一个请求并等待应答（测试、基准与脚本使用）
+class DaemonClient{
+    public:
+        DaemonClient() = default;
+        ~DaemonClient();
+        DaemonClient(const DaemonClient&) = delete;
+        DaemonClient& operator=(const DaemonClient&) = delete;
+
+        bool connect(const std::string& path);
+        void close();
+
+        // 发送请求并读取应答；连接出错时返回 false，否则 result / reply 为应答内容
+        bool call(uint8_t op, uint32_t session, const std::string& payload, uint8_t& result, std::string& reply);
+
+    private:
+        int fd = -1;
+        std::string frame;  // 复用的发送缓冲
+};
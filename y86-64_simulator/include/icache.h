@@ -0,0 +1,46 @@
+#pragma once
+#include "global.h"
+
+// 预解码后的一条指令（fetch 阶段的全部产物）
+struct DecodedInst{
+    addr_t pc = 0;       // tag：指令起始地址
+    word_t valC = 0;
+    addr_t valP = 0;
+    uint8_t icode = ICode::NOP;
+    uint8_t ifunc = 0;
+    uint8_t rA = Reg::NONE, rB = Reg::NONE;
+    uint8_t len = 0;     // 指令占用的字节数（HALT 的 valP == PC，所以单独记录）
+    bool valid = false;
+};
+
+// 预解码指令缓存：按 PC 直接映射
+// 由 Memory 持有，写内存时若命中已缓存指令的字节范围则失效对应条目
+class ICache{
+    public:
+        static const int ENTRIES = 4096;     // 必须是 2 的幂
+        static const int MAX_INST_LEN = 10;  // Y86-64 最长指令：icode + reg + 8 字节 valC
+
+        ICache();
+        void clear();
+
+        // 热路径，放在头文件中以便内联
+        const DecodedInst* lookup(addr_t pc) const {
+            const DecodedInst& e = lines[pc & (ENTRIES - 1)];
+            return (e.valid && e.pc == pc) ? &e : nullptr;
+        }
+
+        void insert(const DecodedInst& inst);
+
+        // 写入 [addr, addr+len) 之前/之后调用，失效所有与之重叠的指令
+        void invalidate(addr_t addr, addr_t len){
+            if (validCount == 0 || addr >= hi || addr + len <= lo) return;  // 快速排除：不碰代码区的写入（如栈）
+            invalidateRange(addr, len);
+        }
+
+    private:
+        std::vector<DecodedInst> lines;
+        size_t validCount = 0;
+        addr_t lo = 0, hi = 0;  // 已缓存指令覆盖的地址范围 [lo, hi)
+
+        void invalidateRange(addr_t addr, addr_t len);
+};
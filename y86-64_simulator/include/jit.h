@@ -0,0 +1,90 @@
+#pragma once
+#include "global.h"
+#include <cstdio>
+#include <vector>
+
+#include "memory.h"
+#include "icache.h"
+
+// 与 cpu.h 中的声明一致：JIT 只服务于默认实例 CPU
+struct NoHooks;
+template<typename M, typename Hooks> class BasicCPU;
+using CPU = BasicCPU<Memory, NoHooks>;
+
+// 生成代码与调度器之间共享的运行时上下文（生成代码通过 rbx 访问）
+struct JitContext{
+    word_t* regs = nullptr;       // Register 数组
+    byte_t* mem = nullptr;        // Memory::data
+    uint8_t* codeMap = nullptr;   // Memory::codeMap，用于检测自修改代码
+    void* cc = nullptr;           // ConditionCode
+    int64_t budget = 0;           // 剩余可执行的指令条数
+    addr_t pc = 0;                // 退出时的 PC
+    uint64_t reason = 0;          // 退出原因，见 JIT::Exit
+    uint8_t* patchSite = nullptr; // 可链接出口的 jmp 指令地址
+    addr_t last = 0;              // 最后执行完的客户指令的 PC，本次进入后尚未执行任何指令时为 JIT::NO_LAST
+};
+
+// 基本块动态二进制翻译器：把 Y86-64 基本块翻译为 x86-64 本机代码
+// - 客户寄存器直接读写 Register 数组，条件码直接读写 ConditionCode
+// - 直接跳转（jXX / call / 顺序执行）的出口在目标块翻译后被回填为直接 jmp（块链接）
+// - 访存越界、写入代码字节（自修改代码）、halt、非法指令均在该指令之前退出，
+//   交给解释器执行这一条，保证与 SEQ 完全一致
+// - 生成代码直接写 Memory::data：run() 返回前重建非零字位图，但不会记录 Memory::writeLog
+// 非 x86-64 Linux 平台上 run() 直接退化为 THREADED 解释执行
+class JIT{
+    public:
+        // 退出原因
+        enum Exit : uint64_t{
+            NORMAL = 0,   // 块正常结束，pc 为下一条指令
+            INTERP = 1,   // 下一条指令需要解释执行
+            BUDGET = 2,   // 剩余预算不足以执行整个块
+            CHAIN = 3     // 直接跳转出口，patchSite 可回填为到目标块的 jmp
+        };
+
+        static const addr_t NO_LAST = ~addr_t(0);
+
+        explicit JIT(CPU& cpu);
+        ~JIT();
+        JIT(const JIT&) = delete;
+        JIT& operator=(const JIT&) = delete;
+
+        static bool available();
+
+        uint64_t run(uint64_t maxSteps);
+        void flush();  // 丢弃全部翻译
+
+        // 输出 perf 可识别的符号表 /tmp/perf-<pid>.map（也可设置环境变量 Y86_JIT_PERF_MAP 开启）
+        // 文件在进程内只以追加方式打开一次，多个实例的块都保留在其中
+        void enablePerfMap();
+
+        size_t blockCount() const { return blocks; }
+
+    private:
+        static const int MAX_BLOCK_INSTS = 64;
+        static const size_t CODE_SIZE = 16 << 20;
+        static const size_t MAX_BLOCK_BYTES = 16 << 10;  // 单个块生成代码的上限（保守估计）
+
+        CPU& cpu;
+        JitContext ctx;
+
+        uint8_t* code = nullptr;   // 可执行代码区
+        size_t codeUsed = 0;
+        size_t stubEnd = 0;        // 入口 / 出口桩之后的位置，flush 后从这里重新分配
+        uint8_t* exitStub = nullptr;
+        void (*enter)(JitContext*, const uint8_t*) = nullptr;
+
+        // 按客户 PC 直接索引的块表；UNTRANSLATABLE 表示该处第一条指令只能解释执行
+        std::vector<uint8_t*> blockAt;
+        size_t blocks = 0;
+        uint64_t epoch = 0;
+        uint64_t flushes = 0;
+
+        FILE* perfMap = nullptr;   // 进程共用的符号表文件，不随实例关闭
+
+        // 本机代码最后执行的指令（只记录 pc，len 为 0），交给 cpu.last 在回退到 SEQ 流程时重新解码
+        DecodedInst lastInst;
+
+        void emitStubs();
+        uint8_t* lookup(addr_t pc);
+        uint8_t* translate(addr_t pc);
+};
@@ -0,0 +1,77 @@
+#ifndef LIBY86_H
+#define LIBY86_H
+/* libY86：嵌入用的 C 接口（make 生成 libY86.so），包装 CPU / Memory / Loader
+ * - 每个 y86_sim 句柄拥有独立的 Memory 与 CPU，不同句柄可以在不同线程上并发使用；
+ *   同一句柄的调用须由调用方串行化
+ * - 数据一律写入调用方提供的缓冲区，库内不分配需要调用方释放的内存（快照除外，用 y86_snapshot_free 释放）
+ * - 只导出 y86_ 前缀的函数；增加函数不改变版本号，改变已有函数的语义或参数时递增 Y86_ABI_VERSION
+ * - 不向标准输出 / 标准错误写任何内容（非法运算等诊断信息丢弃）；内存不足等内部错误按各函数的失败返回值返回
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define Y86_ABI_VERSION 1
+
+#if defined(__GNUC__)
+#define Y86_API __attribute__((visibility("default")))
+#else
+#define Y86_API
+#endif
+
+/* 执行引擎，与 Engine 相同 */
+enum { Y86_ENGINE_SEQ = 0, Y86_ENGINE_THREADED = 1, Y86_ENGINE_JIT = 2 };
+
+/* 状态码，与 Stat 相同 */
+enum { Y86_STAT_AOK = 1, Y86_STAT_HLT = 2, Y86_STAT_ADR = 3, Y86_STAT_INS = 4 };
+
+/* 条件码位 */
+enum { Y86_CC_ZF = 1, Y86_CC_SF = 2, Y86_CC_OF = 4 };
+
+#define Y86_NUM_REGS 15  /* %rax ~ %r14，按寄存器编号排列 */
+
+typedef struct y86_sim y86_sim;
+typedef struct y86_snapshot y86_snapshot;
+
+Y86_API int y86_abi_version(void);
+
+/* mem_size 为客户地址空间大小（0 表示默认的 0x2000）；engine 非法时返回 NULL */
+Y86_API y86_sim* y86_create(uint64_t mem_size, int engine);
+Y86_API void y86_destroy(y86_sim* sim);
+
+/* 清空内存与全部状态，再装入 .yo 文本或 .ybo 镜像；成功返回 0，写入越界返回 -1 */
+Y86_API int y86_load(y86_sim* sim, const char* buf, size_t len);
+
+/* 至多执行 max_steps 条指令，返回实际执行的条数（已停止或内部错误时为 0） */
+Y86_API uint64_t y86_run(y86_sim* sim, uint64_t max_steps);
+Y86_API uint64_t y86_steps(const y86_sim* sim);  /* 装载之后累计执行的条数 */
+
+Y86_API int y86_stat(const y86_sim* sim);
+Y86_API uint64_t y86_pc(const y86_sim* sim);
+Y86_API void y86_set_pc(y86_sim* sim, uint64_t pc);
+Y86_API int y86_cc(const y86_sim* sim);  /* Y86_CC_* 的组合 */
+
+/* 寄存器：regs 至少 Y86_NUM_REGS 个元素 */
+Y86_API void y86_get_regs(const y86_sim* sim, int64_t* regs);
+Y86_API void y86_set_regs(y86_sim* sim, const int64_t* regs);
+
+/* 读写 [addr, addr + len)；越界时不读写任何字节并返回 -1，否则返回 0 */
+Y86_API int y86_read_mem(const y86_sim* sim, uint64_t addr, void* buf, size_t len);
+Y86_API int y86_write_mem(y86_sim* sim, uint64_t addr, const void* buf, size_t len);
+
+/* 按地址升序取出非零的对齐内存字（与 JSON 输出中的 MEM 相同），至多写入 cap 个；
+ * 返回非零字的总数，大于 cap 时调用方可以按返回值扩大缓冲区后重试 */
+Y86_API size_t y86_live_words(const y86_sim* sim, uint64_t* addrs, int64_t* values, size_t cap);
+
+/* 快照：保存寄存器、条件码、PC、状态、步数与全部内存内容；恢复到同一地址空间大小的任意句柄 */
+Y86_API y86_snapshot* y86_snapshot_take(const y86_sim* sim);
+Y86_API int y86_snapshot_restore(y86_sim* sim, const y86_snapshot* snap);  /* 大小不同时返回 -1 */
+Y86_API void y86_snapshot_free(y86_snapshot* snap);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
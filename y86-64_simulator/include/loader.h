@@ -1,10 +1,50 @@
 #pragma once
 #include "global.h"
 #include "memory.h"
+#include <cstddef>
 #include <string>
+#include <utility>
+#include <vector>
+
+// .ybo 预编译镜像中除内存内容以外的信息
+struct Image{
+    addr_t entry = 0;                                    // 起始 PC
+    std::vector<std::pair<addr_t, std::string>> symbols; // | 注释列中的标号，按出现顺序
+};
+
+// .yo 中带字节的一行：地址、行号（从 1 开始）、字节数与注释列（源代码，去掉两端空白）
+struct SourceLine{
+    addr_t addr = 0;
+    int line = 0;
+    int bytes = 0;
+    std::string source;
+};
 
 class Loader{
     public:
-        // 解析 yo 内容并写入内存
+        // 解析 yo 内容并写入内存；以 .ybo 文件头开始的内容按镜像整块装入，info 非空时返回入口与符号
         static bool load(std::string& content, Memory& mem);
-};
\ No newline at end of file
+        static bool load(const char* text, size_t size, Memory& mem, Image* info = nullptr);
+
+        // 直接从文件描述符 / 文件装入：普通文件 mmap 后原地解析，管道等一次性读入后解析
+        // 与 load 相同，只有写入越界时返回 false；无法读取时同样返回 false
+        static bool loadFd(int fd, Memory& mem, Image* info = nullptr);
+        static bool loadFile(const std::string& path, Memory& mem, Image* info = nullptr);
+
+        // .ybo 镜像（小端序）
+        //   文件头   "Y86YBO" 00 00, u32 版本, u32 段数, u64 入口, u32 符号数, u32 保留
+        //   段表     段数 x (u64 地址, u64 长度, u64 文件偏移)
+        //   符号表   符号数 x (u64 地址, u32 名字长度, 名字)
+        //   段数据
+        static bool isImage(const char* data, size_t size);
+        static std::string buildImage(const Memory& mem, const Image& info);
+
+        // 收集 .yo 中 "0x...: ... | label:" 形式的标号
+        static std::vector<std::pair<addr_t, std::string>> scanSymbols(const char* text, size_t size);
+
+        // 收集 .yo 中带字节的行及其注释列（load 解析时丢弃的部分），按出现顺序
+        static std::vector<SourceLine> scanListing(const char* text, size_t size);
+
+    private:
+        static bool loadImage(const char* data, size_t size, Memory& mem, Image* info);
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "global.h"
+#include "cpu.h"
+#include "icache.h"
+#include <memory>
+#include <vector>
+
+// 多实例锁步执行：同一程序的 N 个独立实例（lane），各自有自己的 Memory，可以用不同的输入运行
+// - 寄存器、PC、条件码、状态按结构数组（SoA）保存，每个量一行、每个 lane 一列
+// - 每一轮选出 PC 最小的一组 lane（循环中落后的 lane 先走，分叉之后尽快重新汇合），
+//   同一 PC 的 lane 共用一次译码，按掩码一起执行：寄存器 / 条件码 / PC 的更新是整行的向量运算，
+//   运算与条件判断使用与 BasicCPU 相同的 ISA::alu / ISA::overflow / ISA::cond
+// - 访存按 lane 逐个进行
+// - 改写了自身代码的 lane，以及非法指令、取指越界等少见情况，由该 lane 的标量 CPU 执行，
+//   因此每个 lane 的每一步都与单独运行的 CPU 完全一致
+class LockstepCPU{
+    public:
+        explicit LockstepCPU(size_t lanes, addr_t memSize = Memory::MAX_SIZE);
+        ~LockstepCPU();
+        LockstepCPU(const LockstepCPU&) = delete;
+        LockstepCPU& operator=(const LockstepCPU&) = delete;
+
+        // 把同一个程序（.yo 或 .ybo）装入每个 lane 并复位全部状态，失败时返回 false
+        bool load(const char* text, size_t size);
+
+        // 每个 lane 至多再执行 maxSteps 条指令，全部 lane 停止或用完预算时返回，返回各 lane 执行的指令总数
+        uint64_t run(uint64_t maxSteps);
+
+        size_t laneCount() const { return lanes; }
+        Memory& memory(size_t lane) { return *mems[lane]; }  // 写入代码字节的 lane 之后按标量执行
+        const Memory& memory(size_t lane) const { return *mems[lane]; }
+
+        word_t getReg(size_t lane, Reg::ID id) const { return id == Reg::NONE ? 0 : regs[id * stride + lane]; }
+        void setReg(size_t lane, Reg::ID id, word_t val) { if (id != Reg::NONE) regs[id * stride + lane] = val; }
+        addr_t getPC(size_t lane) const { return pc[lane]; }
+        void setPC(size_t lane, addr_t val) { pc[lane] = val; }
+        Stat getStat(size_t lane) const { return static_cast<Stat>(stat[lane]); }
+        uint64_t steps(size_t lane) const { return stepCount[lane]; }  // load 之后累计执行的指令数
+
+        // 把 lane 的寄存器、条件码、PC、状态复制到 cpu（cpu 通常绑定 memory(lane)，用于输出状态）
+        void copyTo(size_t lane, CPU& cpu) const;
+
+        uint64_t groups() const { return groupCount; }       // 执行过的分组数（每组一次译码、一次向量执行）
+        uint64_t scalarSteps() const { return scalarCount; } // 交给标量 CPU 执行的指令数
+
+    private:
+        size_t lanes;
+        size_t stride;  // 每行的长度：lanes 向上取整到向量宽度，多出的 lane 恒为停止状态
+
+        std::vector<std::unique_ptr<Memory>> mems;
+        std::vector<std::unique_ptr<CPU>> scalar;  // 标量执行用的 CPU，首次需要时创建
+        // 分组执行的 lane 最后执行的指令的 PC（NO_LAST 表示最后一条由标量 CPU 执行）；
+        // 交给标量 CPU 之前据此恢复 SEQ 的中间信号（见 BasicCPU::last），使取指出错时的行为与单独运行的 CPU 相同
+        static constexpr addr_t NO_LAST = ~addr_t(0);
+        std::vector<addr_t> lastPC;
+        std::vector<DecodedInst> lastInst;
+
+        // SoA 状态；掩码类的量为全 1 / 全 0
+        std::vector<word_t> regs;        // 17 行：15 个寄存器、恒为 0 的 NONE 行、丢弃写入 NONE 的行
+        std::vector<word_t> pc;
+        std::vector<word_t> zf, sf, of;  // 条件码（掩码）
+        std::vector<word_t> stat;
+        std::vector<word_t> budget;      // 本次 run 剩余的指令数
+        std::vector<word_t> stepCount;
+        std::vector<word_t> shared;      // 掩码：代码与其他 lane 相同，可以参与分组执行
+        std::vector<word_t> mask;        // 当前组
+        std::vector<uint64_t> epochs;    // 各 lane 内存的 codeEpoch，变化说明改写了已译码的代码
+        size_t soloLanes = 0;            // shared 为 0 的 lane 数
+
+        // 已译码的指令：对所有 shared lane 成立（译码时核对过字节并在每个 lane 中标记为代码）
+        ICache decoded;
+
+        uint64_t groupCount = 0;
+        uint64_t scalarCount = 0;
+
+        word_t* row(int id) { return &regs[id * stride]; }  // 读：NONE 为全 0 行
+        word_t* dst(int id) { return &regs[(id == Reg::NONE ? 16 : id) * stride]; }  // 写：NONE 写入丢弃行
+
+        const DecodedInst* decode(addr_t target);
+        void execGroup(addr_t target);
+        void execMemory(const DecodedInst& d);
+        void stepScalar(size_t lane);
+        void checkCode(size_t lane);
+        void makeSolo(size_t lane);
+};
@@ -1,19 +1,240 @@
 #pragma once
 #include "global.h"
+#include "icache.h"
+#include "word_io.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
 
-class Memory{
+// 越界检查策略（BasicMemory 的 Bounds 参数）：fix 返回 true 表示 [addr, addr + len) 越界，否则 addr 可直接索引
+// CheckedBounds：越界访问报告错误（CPU 置 ADR），与 Memory 相同
+// WrapBounds：地址按空间大小回绕，从不出错；大小为 2 的幂时只是一次按位与
+struct CheckedBounds{
+    template<addr_t SIZE>
+    static bool fix(addr_t& addr, addr_t len) { return addr > SIZE - len; }
+};
+
+struct WrapBounds{
+    template<addr_t SIZE>
+    static bool fix(addr_t& addr, addr_t) { addr &= SIZE - 1; return false; }
+};
+
+// SIZE 为 0：运行时大小、分页的 Memory；否则为编译期固定大小的连续内存（见文件末尾）
+template<addr_t SIZE = 0, typename Bounds = CheckedBounds>
+class BasicMemory;
+
+// 客户内存：地址空间大小在构造时确定（默认 MAX_SIZE）
+// - [0, denseSize()) 为连续数组 data，取指 / 预解码缓存 / JIT 只作用于这一段，访问走快速路径
+// - [DENSE_LIMIT, size()) 按 4 KiB 分页，经两级页表在第一次写入非零值时分配，未触及的页读出 0
+//   内存占用随触及的页数增长，而不是随地址空间大小增长
+// 越界检查保持为显式的一次无符号比较：客户地址是任意 64 位值，PROT_NONE 保护页只能覆盖宿主地址空间中
+// 有限的窗口，窗口之外的地址可能落在宿主已映射的内存上，用 SIGSEGV 代替比较会改变 ADR 的语义
+template<>
+class BasicMemory<0, CheckedBounds>{
     public:
-        static const int MAX_SIZE = 0x2000;
-        std::vector<byte_t> data;  // 大小可变，使用 vector
+        static const int MAX_SIZE = 0x2000;         // 默认地址空间大小
+        static const addr_t DENSE_LIMIT = 0x10000;  // 连续数组的上限，超出部分分页
+        static const addr_t PAGE_BITS = 12;
+        static const addr_t PAGE_SIZE = addr_t(1) << PAGE_BITS;
+        static const addr_t TABLE_BITS = 9;         // 每张二级页表 512 页（2 MiB）
+
+        std::vector<byte_t> data;  // 低地址连续区，大小为 denseSize()
+        ICache icache;             // 预解码指令缓存，写内存时自动失效
+
+        // 代码字节标记：被预解码缓存或 JIT 翻译引用的字节为 1（只覆盖 data）
+        // 写入已标记的字节时失效预解码缓存，并递增 codeEpoch 通知 JIT 其翻译已过期
+        std::vector<uint8_t> codeMap;
+        uint64_t codeEpoch = 0;
 
-    Memory();
+        // 非零内存字位图：每个 8 字节对齐的内存字占一位，由 writeByte / writeWord 维护（只覆盖 data，页各自带位图）
+        // 输出状态时只遍历非零的字；绕过写接口直接改写 data 之后（JIT）须调用 rescanLive()
+        std::vector<uint64_t> liveBits;
+
+        // 非空时记录每次写入涉及的内存字（8 字节对齐的地址，可能重复），供增量 trace 使用
+        std::vector<addr_t>* writeLog = nullptr;
+
+    explicit BasicMemory(addr_t size = MAX_SIZE);
     void reset();
 
+    addr_t size() const { return limit; }
+    addr_t denseSize() const { return data.size(); }
+    size_t pageCount() const { return pages; }  // 已分配的页数
+
+    // 标记 [addr, addr + len) 为代码；范围超出 data 时不标记并返回 false（调用方不得缓存该指令）
+    bool markCode(addr_t addr, addr_t len);
+    void clearCode();  // 清空全部标记与预解码缓存（JIT 丢弃全部翻译时调用）
+
+    void rescanLive();
+
+    // 按地址升序对每个非零的对齐内存字调用 f(addr, value)
+    template<typename F>
+    void forEachLiveWord(F f) const {
+        bool error;
+        for (size_t i = 0; i < liveBits.size(); i++){
+            for (uint64_t bits = liveBits[i]; bits; bits &= bits - 1){
+                addr_t addr = (i * 64 + __builtin_ctzll(bits)) * 8;
+                f(addr, readWord(addr, error));
+            }
+        }
+        for (const auto& t : tables){
+            for (size_t p = 0; p < t.second->size(); p++){
+                const Page* page = (*t.second)[p].get();
+                if (page == nullptr) continue;
+                addr_t base = ((t.first << TABLE_BITS) + p) << PAGE_BITS;
+                for (size_t i = 0; i < PAGE_LIVE_WORDS; i++){
+                    for (uint64_t bits = page->live[i]; bits; bits &= bits - 1){
+                        addr_t addr = base + (i * 64 + __builtin_ctzll(bits)) * 8;
+                        f(addr, readWord(addr, error));
+                    }
+                }
+            }
+        }
+    }
+
     // 读写单个字节
     bool writeByte(addr_t addr, byte_t val);
     byte_t readByte(addr_t addr, bool& error) const;
 
-    // 读写 1 个 byte
-    bool writeWord(addr_t addr, word_t val);
-    word_t readWord(addr_t addr, bool& error) const;
-};
\ No newline at end of file
+    // 整块读写 / 比较 [addr, addr + len)（装载、镜像导出与状态比较使用）
+    // 越界时 writeBlock 不写入任何字节、readBlock 不读出任何字节，均返回 true；equalBlock 返回 false
+    bool writeBlock(addr_t addr, const byte_t* src, size_t len);
+    bool readBlock(addr_t addr, byte_t* dst, size_t len) const;
+    bool equalBlock(addr_t addr, const byte_t* src, size_t len) const;
+
+    // 读写 1 个 word（8 字节，小端序）
+    // 落在 data 内的访问是热路径（MRMOVQ / RMMOVQ / PUSHQ / POPQ / CALL / RET），放在头文件中以便内联
+    bool writeWord(addr_t addr, word_t val){
+        if (addr > data.size() - 8) return writeWordSlow(addr, val);
+
+        uint64_t code;
+        std::memcpy(&code, &codeMap[addr], 8);  // 一次检查 8 个字节的标记
+        if (code){
+            icache.invalidate(addr, 8);
+            codeEpoch++;
+        }
+        WordIO::store(&data[addr], val);
+        updateDenseLive(addr & ~addr_t(7));
+        if (addr & 7) updateDenseLive((addr + 8) & ~addr_t(7));  // 跨越两个对齐的内存字
+        if (writeLog){
+            writeLog->push_back(addr & ~addr_t(7));
+            if (addr & 7) writeLog->push_back((addr + 8) & ~addr_t(7));  // 跨越两个对齐的内存字
+        }
+        return false;
+    }
+
+    word_t readWord(addr_t addr, bool& error) const {
+        if (addr > data.size() - 8) return readWordSlow(addr, error);
+        error = false;
+        return WordIO::load(&data[addr]);
+    }
+
+    private:
+        static const size_t PAGE_LIVE_WORDS = PAGE_SIZE / 8 / 64;
+
+        struct Page{
+            alignas(8) byte_t bytes[PAGE_SIZE] = {};
+            uint64_t live[PAGE_LIVE_WORDS] = {};
+        };
+        using Table = std::array<std::unique_ptr<Page>, size_t(1) << TABLE_BITS>;
+
+        addr_t limit;
+        std::map<addr_t, std::unique_ptr<Table>> tables;  // 一级页表：addr >> (PAGE_BITS + TABLE_BITS) -> 二级页表
+        size_t pages = 0;
+        mutable addr_t lastPageNo = ~addr_t(0);  // 最近一次查到的页（未分配时为 nullptr）
+        mutable Page* lastPage = nullptr;
+
+        void updateLive(addr_t wordAddr);
+        void updateDenseLive(addr_t wordAddr){
+            addr_t slot = wordAddr / 8;
+            if (WordIO::loadAligned(&data[wordAddr])) liveBits[slot / 64] |= uint64_t(1) << (slot % 64);
+            else liveBits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+        }
+        bool writeWordSlow(addr_t addr, word_t val);
+        word_t readWordSlow(addr_t addr, bool& error) const;
+        Page* findPage(addr_t addr) const;
+        Page* touchPage(addr_t addr);
+        void writePagedByte(addr_t addr, byte_t val);
+        byte_t readPagedByte(addr_t addr) const;
+};
+
+using Memory = BasicMemory<>;
+
+// 编译期固定大小（2 的幂）的连续内存：越界检查化为与常量比较或按位与，没有分页、非零字位图与写日志
+// 写入时直接按预解码缓存记录的地址范围失效（ICache::invalidate 会先快速排除不碰代码的写入）
+template<addr_t SIZE, typename Bounds>
+class BasicMemory{
+    static_assert(SIZE >= 8 && (SIZE & (SIZE - 1)) == 0, "BasicMemory size must be a power of two");
+
+    public:
+        std::vector<byte_t> data;
+        ICache icache;
+        uint64_t codeEpoch = 0;
+
+    BasicMemory() : data(SIZE, 0) {}
+
+    void reset(){
+        std::fill(data.begin(), data.end(), 0);
+        icache.clear();
+        codeEpoch++;
+    }
+
+    static constexpr addr_t size() { return SIZE; }
+
+    // 回绕到开头或超出末尾的指令不缓存：写入按回绕后的地址失效，与缓存的 PC 对不上
+    bool markCode(addr_t addr, addr_t len) { return addr < SIZE && len <= SIZE - addr; }
+    void clearCode() { icache.clear(); }
+
+    // 复制另一块内存的全部非零字（例如先用 Loader 装入 Memory）
+    template<typename Src>
+    void copyFrom(const Src& src){
+        reset();
+        src.forEachLiveWord([&](addr_t addr, word_t val){ writeWord(addr, val); });
+    }
+
+    template<typename F>
+    void forEachLiveWord(F f) const {
+        for (addr_t addr = 0; addr < SIZE; addr += 8){
+            word_t val = WordIO::loadAligned(&data[addr]);
+            if (val) f(addr, val);
+        }
+    }
+
+    bool writeByte(addr_t addr, byte_t val){
+        if (Bounds::template fix<SIZE>(addr, 1)) return true;
+        icache.invalidate(addr, 1);
+        data[addr] = val;
+        return false;
+    }
+
+    byte_t readByte(addr_t addr, bool& error) const {
+        error = Bounds::template fix<SIZE>(addr, 1);
+        return error ? 0 : data[addr];
+    }
+
+    bool writeBlock(addr_t addr, const byte_t* src, size_t len){
+        if (addr > SIZE || len > SIZE - addr) return true;
+        icache.invalidate(addr, len);
+        std::memcpy(&data[addr], src, len);
+        return false;
+    }
+
+    bool writeWord(addr_t addr, word_t val){
+        if (Bounds::template fix<SIZE>(addr, 8)) return true;
+        icache.invalidate(addr, 8);
+        if (addr > SIZE - 8) icache.invalidate(0, 8);
+        if (addr <= SIZE - 8) WordIO::store(&data[addr], val);
+        else for (int i = 0; i < 8; i++) data[(addr + i) & (SIZE - 1)] = val >> (8 * i) & 0xFF;  // 回绕跨越末尾
+        return false;
+    }
+
+    word_t readWord(addr_t addr, bool& error) const {
+        error = Bounds::template fix<SIZE>(addr, 8);
+        if (error) return 0;
+        if (addr <= SIZE - 8) return WordIO::load(&data[addr]);
+        word_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(data[(addr + i) & (SIZE - 1)]) << (8 * i);
+        return value;
+    }
+};
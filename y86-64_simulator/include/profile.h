@@ -0,0 +1,55 @@
+#pragma once
+#include "global.h"
+#include "memory.h"
+#include "cpu.h"
+#include "loader.h"
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 客户程序的热点分析（--profile）：按 PC 计数的插桩策略，计数器是以地址为下标的平坦数组
+// 只有 ProfileCPU 会计数；JIT 执行的本机代码不经过插桩，ProfileCPU 的 Engine::JIT 按 THREADED 执行
+struct ProfileHooks{
+    std::vector<uint64_t> counts;  // counts[pc]：从 pc 开始执行的次数，大小由使用方按代码范围设定
+    uint64_t outside = 0;          // PC 不在 counts 范围内的次数
+
+    void onStep(addr_t pc){
+        if (pc < counts.size()) counts[pc]++;
+        else outside++;
+    }
+    void onExec(int) {}
+    void onCond(int, bool) {}
+    void onRead(addr_t, word_t) {}
+    void onWrite(addr_t, word_t) {}
+};
+
+using ProfileCPU = BasicCPU<Memory, ProfileHooks>;
+extern template class BasicCPU<Memory, ProfileHooks>;
+
+// 把计数归到 .yo 清单的行与标号上
+class Profile{
+    public:
+        using Symbols = std::vector<std::pair<addr_t, std::string>>;
+
+        Profile(const ProfileHooks& hooks, std::vector<SourceLine> listing, const Symbols& symbols);
+
+        // 覆盖清单中全部指令所需的 counts 大小：只算在 mem 中译码为一条同样长度指令的行，
+        // .pos 之后的数据与栈区不计入
+        static addr_t codeEnd(const std::vector<SourceLine>& listing, const Memory& mem);
+
+        // 按标号汇总（标号到下一个标号之间的全部指令）与按指令排序的前 top 个热点
+        void report(std::ostream& out, size_t top = 20) const;
+
+        // 在原 .yo 每一行前加上该行指令的执行次数与占比
+        void annotate(std::ostream& out, const char* text, size_t size) const;
+
+    private:
+        const ProfileHooks& hooks;
+        std::vector<SourceLine> listing;
+        Symbols symbols;   // 按地址排序，同一地址只保留第一个
+        uint64_t total = 0;
+
+        uint64_t count(addr_t pc) const { return pc < hooks.counts.size() ? hooks.counts[pc] : 0; }
+        std::string where(addr_t pc) const;  // "label+0x.."，之前没有标号时为空
+};
@@ -3,6 +3,8 @@
 #include <array>
 
 class Register{
+    friend class JIT;  // 生成代码直接读写寄存器数组
+
     private:
         std::array<word_t, 16> regs;  // 大小不可变，使用 array
 
@@ -10,9 +12,17 @@ class Register{
     Register();
     void reset();
 
-    // 读写单个字节
-    void setReg(Reg::ID id, word_t val);
-    word_t getReg(Reg::ID id) const;
+    // 读写单个字节（每条指令都会调用，放在头文件中以便内联）
+    void setReg(Reg::ID id, word_t val){
+        if (id == Reg::NONE)  // 强类型，不需要 id > 0xF
+            return;
+        regs[id] = val;
+    }
+    word_t getReg(Reg::ID id) const{
+        if (id == Reg::NONE)
+            return 0;
+        return regs[id];
+    }
 
     // 获取所有寄存器用于打印   
     const std::array<word_t, 16>& getAll() const;
@@ -0,0 +1,71 @@
+#pragma once
+#include "global.h"
+#include "cpu.h"
+#include <chrono>
+#include <string>
+
+// 运行到完成：执行到 HLT / ADR / INS，或用完指令预算、超过墙钟期限为止，中间不产生任何输出
+// 指令预算交给 CPU::run 计数；期限在每执行 chunk 条指令后检查一次，执行循环本身不读时钟
+struct RunBudget{
+    uint64_t maxSteps = UINT64_MAX;  // 指令预算
+    double seconds = 0;              // 墙钟期限（秒），0 表示不限
+    uint64_t chunk = 1 << 20;        // 有期限时两次读时钟之间执行的指令数
+};
+
+enum class StopReason{
+    STAT,      // stat 不再是 AOK（HLT / ADR / INS）
+    STEPS,     // 用完指令预算
+    DEADLINE   // 超过墙钟期限
+};
+
+struct RunSummary{
+    uint64_t steps = 0;
+    double seconds = 0;
+    StopReason reason = StopReason::STAT;
+};
+
+struct ExecStats;
+
+// 对任意 BasicCPU 实例（例如统计执行信息的 StatsCPU）适用
+template<typename C>
+RunSummary runToCompletion(C& cpu, const RunBudget& budget) {
+    using Clock = std::chrono::steady_clock;
+    RunSummary summary;
+    auto t0 = Clock::now();
+
+    if (budget.seconds <= 0) {
+        summary.steps = cpu.run(budget.maxSteps);
+    }
+    else {
+        auto deadline = t0 + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(budget.seconds));
+        uint64_t chunk = budget.chunk > 0 ? budget.chunk : 1;
+        while (cpu.stat == Stat::AOK && summary.steps < budget.maxSteps) {
+            if (Clock::now() >= deadline) {
+                summary.reason = StopReason::DEADLINE;
+                break;
+            }
+            uint64_t left = budget.maxSteps - summary.steps;
+            summary.steps += cpu.run(left < chunk ? left : chunk);
+        }
+    }
+
+    summary.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    if (summary.reason != StopReason::DEADLINE && cpu.stat == Stat::AOK) summary.reason = StopReason::STEPS;
+    return summary;
+}
+
+// {"STEPS": ..., "STOP": "stat|steps|deadline", "SECONDS": ..., "MIPS": ..., "FINAL": 终态}
+// 终态的格式与 printStateJSON 相同；给出 stats 时在 "FINAL" 之前加入 "STATS": 执行统计（见 stats.h）
+void appendRunSummaryJSON(std::string& out, const CPU& cpu, const RunSummary& summary, const ExecStats* stats = nullptr);
+
+// 其他插桩策略的实例：终态借用同一 Memory 上的默认实例输出
+template<typename Hooks>
+void appendRunSummaryJSON(std::string& out, const BasicCPU<Memory, Hooks>& cpu, const RunSummary& summary,
+                          const ExecStats* stats = nullptr) {
+    CPU view(cpu.mem);
+    view.PC = cpu.PC;
+    view.stat = cpu.stat;
+    view.reg = cpu.reg;
+    view.cc = cpu.cc;
+    appendRunSummaryJSON(out, view, summary, stats);
+}
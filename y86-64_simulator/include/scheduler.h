@@ -0,0 +1,39 @@
+#pragma once
+#include "global.h"
+#include "ws_deque.h"
+#include <memory>
+#include <vector>
+
+// 可分片执行的任务：resume 最多执行 budget 条指令后返回，返回 true 表示任务已经完成
+// 同一任务的 resume 不会被并发调用，但前后两次可能在不同线程上执行
+class SliceTask{
+    public:
+        virtual ~SliceTask() = default;
+        virtual bool resume(uint64_t budget) = 0;
+};
+
+// 工作窃取调度器：每个工作线程一个 Chase-Lev 队列
+// - 线程优先执行自己队列中的任务，自己的队列为空时随机选择其他线程窃取
+// - 线程从自己队列的队首（top 端，与窃取者同一端）取任务；任务每次执行 slice 条指令，
+//   未完成时放回队尾（bottom 端），因此自己队列中的任务按先进先出轮转，每个排队的任务都能轮到一片，
+//   空闲线程也可以在长任务两片之间把它偷走
+class WorkStealingScheduler{
+    public:
+        static const uint64_t DEFAULT_SLICE = 4096;  // BatchOptions::slice 的默认值
+
+        // threads 为 0 表示硬件线程数；slice 为 0 表示不分片（每个任务一次执行完）
+        explicit WorkStealingScheduler(unsigned threads = 0, uint64_t slice = DEFAULT_SLICE);
+
+        // 执行全部任务，返回时所有任务均已完成；任务按下标轮流分给各线程
+        void run(const std::vector<SliceTask*>& tasks);
+
+        unsigned threadCount() const { return threads; }
+        uint64_t slices() const { return sliceCount; }  // 上一次 run 中执行的片数
+        uint64_t steals() const { return stealCount; }  // 上一次 run 中成功窃取的次数
+
+    private:
+        unsigned threads;
+        uint64_t slice;
+        uint64_t sliceCount = 0;
+        uint64_t stealCount = 0;
+};
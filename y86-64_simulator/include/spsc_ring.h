@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 单生产者 / 单消费者无锁环形队列，容量 N 必须是 2 的幂
+// head 只由消费者写，tail 只由生产者写，两者分处不同缓存行避免伪共享
+template<typename T, size_t N>
+class SpscRing{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        SpscRing() : slots(N) {}
+
+        // 生产者：队列满时返回 false
+        bool tryPush(const T& v){
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N) return false;
+            slots[t & (N - 1)] = v;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 生产者：队列满时等待消费者腾出空间（反压）
+        void push(const T& v){
+            while (!tryPush(v)) std::this_thread::yield();
+        }
+
+        // 消费者：队列空时返回 false
+        bool tryPop(T& v){
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+            v = slots[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+        alignas(64) std::vector<T> slots;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "global.h"
+#include "memory.h"
+#include "cpu.h"
+#include "run_budget.h"
+#include <string>
+
+// 执行统计（--stats）：作为 BasicCPU 的插桩策略，计数器就是 cpu.hooks
+// 只有以 ExecStats 实例化的 StatsCPU 会计数；默认实例 CPU 使用 NoHooks，不含任何统计代码
+// JIT 执行的本机代码不经过插桩，StatsCPU 的 Engine::JIT 按 THREADED 执行
+struct ExecStats{
+    uint64_t steps = 0;
+    uint64_t icodes[16] = {};              // 按 icode 的执行条数（取指失败的不计）
+    uint64_t jxxTaken = 0, jxxNotTaken = 0;    // 条件跳转（不含 jmp）
+    uint64_t cmovTaken = 0, cmovNotTaken = 0;  // 条件传送（不含 rrmovq）
+    uint64_t reads = 0, writes = 0;        // 成功的数据读写（取指不计）
+    int64_t depth = 0, maxDepth = 0;       // call 比 ret 多出的层数及其最大值
+
+    void onStep(addr_t) { steps++; }
+    void onExec(int icode){
+        icodes[icode]++;
+        if (icode == ICode::CALL){
+            if (++depth > maxDepth) maxDepth = depth;
+        }
+        else if (icode == ICode::RET) depth--;
+    }
+    void onCond(int icode, bool taken){
+        if (icode == ICode::JXX) (taken ? jxxTaken : jxxNotTaken)++;
+        else (taken ? cmovTaken : cmovNotTaken)++;
+    }
+    void onRead(addr_t, word_t) { reads++; }
+    void onWrite(addr_t, word_t) { writes++; }
+};
+
+using StatsCPU = BasicCPU<Memory, ExecStats>;
+extern template class BasicCPU<Memory, ExecStats>;
+
+// {"INSTRUCTIONS": ..., "ICODE": {...}, "JXX": {...}, "CMOV": {...}, "MEM": {...}, "MAX_CALL_DEPTH": ...}
+// indent 为对象内容所在的缩进层数（每层 2 个空格，右括号少一层）
+void appendStatsJSON(std::string& out, const ExecStats& stats, int indent = 1);
+
+// 与 run_budget.h 中的同名函数相同，并带上 cpu.hooks 的执行统计
+void appendRunSummaryJSON(std::string& out, const StatsCPU& cpu, const RunSummary& summary);
@@ -0,0 +1,170 @@
+#pragma once
+#include "global.h"
+#include "cpu.h"
+#include <array>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_ring.h"
+
+// 一步之后的架构状态（二进制 trace 的解码结果）
+struct TraceState{
+    uint64_t step = 0;
+    addr_t PC = 0;
+    int stat = 0;
+    std::array<word_t, 15> regs{};
+    bool zf = true, sf = false, of = false;
+    std::map<addr_t, word_t> mem;  // 非零的对齐内存字
+};
+
+// 按 test.py / answer 的 JSON 格式输出一步之后的完整状态
+// steps 从 1 开始，除第一步外在前面补上分隔的逗号
+void printStateJSON(const CPU& cpu, int steps);
+void printStateJSON(const TraceState& s, int steps);
+void appendStateJSON(std::string& out, const CPU& cpu, int steps);  // 追加到 out，而不是写到标准输出
+
+// 增量 trace：每步只输出 PC / STAT 以及发生变化的寄存器、条件码和内存字
+// 第 1 步（以及此后每 keyframeInterval 步，0 表示不再插入）输出带 "KEY": 1 的完整状态作为关键帧
+// 内存字变为 0 时同样输出，trace_expand.py 据此还原为 printStateJSON 的完整格式
+class DeltaTracer{
+    public:
+        DeltaTracer(CPU& cpu, int keyframeInterval = 0);
+        ~DeltaTracer();
+        DeltaTracer(const DeltaTracer&) = delete;
+        DeltaTracer& operator=(const DeltaTracer&) = delete;
+
+        void print(int steps);  // 与 printStateJSON 相同，在每步之后调用
+
+    private:
+        CPU& cpu;
+        int interval;
+
+        // 上一次输出时的状态
+        std::array<word_t, 15> regs;
+        bool zf = false, sf = false, of = false;
+        Memory words;  // 影子内存：上次输出时的内存内容
+
+        std::vector<addr_t> writes;  // Memory::writeLog
+
+        void keyframe();
+        void delta();
+};
+
+// 二进制 trace（小端序）
+//   文件头   "Y86TRACE" u32 版本 u32 保留
+//   关键帧   u8 1, u64 step, u64 PC, u8 STAT, u8 CC, 15 x i64 寄存器, u32 n, n x (u64 地址, i64 值)
+//   增量帧   u8 2, u64 PC, u8 STAT, u8 CC, u16 寄存器掩码, 掩码中每位一个 i64, u32 n, n x (u64 地址, i64 值)
+//   索引     关键帧个数 x (u64 step, u64 文件偏移)
+//   文件尾   u64 总步数, u64 关键帧个数, u64 索引偏移, "Y86TIDX" '\0'
+// CC 的第 0/1/2 位依次为 ZF/SF/OF；增量帧的 step 为前一帧加 1，内存字变为 0 时同样记录
+// 写出期间 CPU 的诊断信息（cpu.diag）改到标准错误
+class BinaryTraceWriter{
+    public:
+        static const int DEFAULT_KEYFRAME_INTERVAL = 1024;
+
+        BinaryTraceWriter(CPU& cpu, FILE* out, int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+        ~BinaryTraceWriter();  // 未调用 finish() 时自动补上索引
+        BinaryTraceWriter(const BinaryTraceWriter&) = delete;
+        BinaryTraceWriter& operator=(const BinaryTraceWriter&) = delete;
+
+        void record(int steps);  // 与 printStateJSON 相同，在每步之后调用
+        void finish();           // 写入索引与文件尾
+
+    private:
+        CPU& cpu;
+        FILE* out;
+        int interval;
+        bool finished = false;
+
+        std::vector<uint8_t> buf;  // 待写出的字节
+        uint64_t offset = 0;       // buf 之前已写出的字节数
+        uint64_t steps = 0;
+        std::vector<std::pair<uint64_t, uint64_t>> index;  // (step, 偏移)
+
+        // 上一帧的状态
+        std::array<word_t, 15> regs{};
+        uint8_t cc = 0;
+        Memory words;  // 影子内存
+        std::vector<addr_t> writes;  // Memory::writeLog
+
+        template<typename T> void put(T v);
+        void flushBuf();
+        void keyframe();
+        void delta();
+};
+
+// 通过 mmap 读取二进制 trace：按关键帧索引二分查找，再向后应用增量帧
+class BinaryTraceReader{
+    public:
+        BinaryTraceReader() = default;
+        ~BinaryTraceReader();
+        BinaryTraceReader(const BinaryTraceReader&) = delete;
+        BinaryTraceReader& operator=(const BinaryTraceReader&) = delete;
+
+        bool open(const std::string& path);  // 文件不存在或格式错误时返回 false
+        uint64_t steps() const { return total; }
+
+        bool seek(uint64_t step, TraceState& s);  // s 置为第 step 步（从 1 开始）之后的状态
+        bool next(TraceState& s);                 // s 前进一步
+
+    private:
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        uint64_t total = 0;
+        uint64_t keyframes = 0;
+        const uint8_t* indexAt = nullptr;
+        size_t pos = 0;       // 下一帧的偏移
+        size_t end = 0;       // 帧数据的结尾（即索引偏移）
+
+        template<typename T> bool get(T& v);
+        bool decode(TraceState& s);
+};
+
+// 异步 trace：CPU 线程每步只把架构状态的快照放入环形队列，写线程维护影子内存、
+// 按 printStateJSON 的格式整块写出，输出与同步逐步打印逐字节相同
+// 队列满时 record() 等待写线程（反压）；须在程序装入内存之后构造
+// CPU 的诊断信息（cpu.diag）在写线程中插在前一步的状态之后，与同步打印时的位置相同
+class AsyncTraceWriter{
+    public:
+        AsyncTraceWriter(CPU& cpu, FILE* out);
+        ~AsyncTraceWriter();  // 未调用 finish() 时自动调用
+        AsyncTraceWriter(const AsyncTraceWriter&) = delete;
+        AsyncTraceWriter& operator=(const AsyncTraceWriter&) = delete;
+
+        void record(int steps);  // 与 printStateJSON 相同，在每步之后调用
+        void finish();           // 等待写线程输出全部快照并刷新 out
+
+    private:
+        // 一步的快照；一条指令最多改写 2 个对齐内存字，多出的写入放在后续的续接记录中
+        // 诊断信息放在本步之前的文本记录中：文本占用 regs，长度为 writes
+        struct Snapshot{
+            static const int MAX_WRITES = 4;
+            enum Kind : uint8_t { STEP, CONT, TEXT };
+            addr_t PC;
+            word_t regs[15];
+            addr_t addr[MAX_WRITES];
+            word_t val[MAX_WRITES];
+            uint8_t stat;
+            uint8_t cc;          // 第 0/1/2 位依次为 ZF/SF/OF
+            uint8_t writes;
+            Kind kind;           // CONT：续接记录，只更新内存，不输出
+        };
+        static const size_t RING_SIZE = 4096;
+
+        CPU& cpu;
+        FILE* out;
+        SpscRing<Snapshot, RING_SIZE> ring;
+        std::vector<addr_t> writes;  // Memory::writeLog
+        std::ostringstream diag;     // cpu.diag
+        std::thread worker;
+        std::atomic<bool> done{false};
+        bool finished = false;
+
+        // 写线程的影子内存
+        Memory words;
+
+        void run();
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "global.h"
+#include <cstring>
+
+// 客户内存中的 word 按小端序存放
+// 小端宿主上直接 memcpy（编译为一条 mov，不要求对齐），大端宿主退回逐字节拼装
+namespace WordIO{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    inline word_t load(const byte_t* p){
+        word_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+
+    inline void store(byte_t* p, word_t v){
+        std::memcpy(p, &v, 8);
+    }
+#else
+    inline word_t load(const byte_t* p){
+        word_t value = 0;
+        for (int i=0; i<8; i++){
+            value |= static_cast<uint64_t>(p[i]) << (8 * i);
+            // 低地址取得低位，高地址取得高位，需要左移1个字节
+            // 需要将 p[i] (uint8_t) 强制类型转换为 uint64_t
+            // 这牵扯到 C/C++ 的 整数提升规则 (Integral Promotion):
+            // 所有小于 int 的整数类型，参与运算时都会先提升为 int
+            // 因此如果左移位数超过32，未经过类型转换会出现问题
+        }
+        return value;
+    }
+
+    inline void store(byte_t* p, word_t v){
+        for (int i=0; i<8; i++){
+            p[i] = v >> (8 * i) & 0xFF;
+            // 1个字节1个字节存储，小端序，所以每次要右移1个字节，即8位
+        }
+    }
+#endif
+
+    // 调用方保证 p 按 8 字节对齐（位图维护、页内对齐字的扫描）
+    inline word_t loadAligned(const byte_t* p){
+        return load(static_cast<const byte_t*>(__builtin_assume_aligned(p, 8)));
+    }
+
+    inline void storeAligned(byte_t* p, word_t v){
+        store(static_cast<byte_t*>(__builtin_assume_aligned(p, 8)), v);
+    }
+}
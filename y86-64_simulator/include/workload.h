@@ -0,0 +1,27 @@
+#pragma once
+#include "global.h"
+#include <string>
+
+// 合成负载：按形状与目标指令数生成 .yo 程序（y86gen 与吞吐量语料 corpus/ 使用）
+// 所有形状只使用默认的 0x2000 字节地址空间，执行的指令数由外层循环次数控制，可达 10^9 以上；
+// 同一 (形状, 指令数, 种子) 总是生成相同的程序
+namespace Workload{
+    enum Shape{
+        ARITH,    // 紧凑的 OPq 循环，只有寄存器运算
+        RECURSE,  // asumr 式的深递归：每轮对 256 个元素的数组递归求和（call / ret / pushq / popq）
+        STREAM,   // 顺序读写 512 个字的数组（前缀和），mrmovq / rmmovq 密集
+        BRANCHY,  // 线性反馈移位寄存器产生的伪随机位决定分支方向
+        CMOV,     // 同一伪随机序列，用条件传送维护最大值 / 最小值，没有数据相关的分支
+        SHAPE_COUNT
+    };
+
+    const char* shapeName(Shape shape);
+    bool parseShape(const std::string& name, Shape& shape);
+
+    // "1000"、"5k"、"1m"、"2g" 等（十进制，k / m / g 为 10^3 / 10^6 / 10^9），无法解析时返回 false
+    bool parseCount(const std::string& text, uint64_t& count);
+
+    // 执行约 instructions 条指令后 halt 的程序（实际条数与估计值相差不超过一轮循环和少量启动指令，
+    // BRANCHY 的每轮条数随分支方向变化，只是近似）
+    std::string generate(Shape shape, uint64_t instructions, uint64_t seed = 1);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Chase-Lev 工作窃取双端队列（Lê 等人针对弱内存模型的版本）
+// 所有者在 bottom 端 push / pop（后进先出），其他线程在 top 端 steal（先进先出），steal 无锁
+// 容量固定为 2 的幂，调用方保证同时在队列中的元素不超过容量；T 须可用于 std::atomic（如指针）
+template<typename T>
+class WorkStealingDeque{
+    public:
+        explicit WorkStealingDeque(size_t capacity) : slots(roundUp(capacity)), mask(slots.size() - 1) {}
+
+        // 所有者
+        void push(T v){
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            slots[b & mask].store(v, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        // 所有者：队列空（或最后一个元素被窃取）时返回 false
+        bool pop(T& v){
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+
+            if (t > b){
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+            v = slots[b & mask].load(std::memory_order_relaxed);
+            if (t == b){
+                // 只剩一个元素：与窃取者竞争
+                bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // 任意线程：队列空或竞争失败时返回 false
+        bool steal(T& v){
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b) return false;
+
+            v = slots[t & mask].load(std::memory_order_relaxed);
+            return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        bool empty() const {
+            return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        alignas(64) std::vector<std::atomic<T>> slots;
+        size_t mask;
+
+        static size_t roundUp(size_t n){
+            size_t c = 1;
+            while (c < n) c <<= 1;
+            return c;
+        }
+};
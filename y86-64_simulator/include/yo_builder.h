@@ -0,0 +1,120 @@
+#pragma once
+#include "global.h"
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// 按指令生成 .yo 文本（基准与程序生成器使用）
+// 跳转 / 调用的目标可以是之后才定义的标号，text() 时回填；格式与 yas 的输出相同：
+//   "0x014: 6130                 | subq ..."
+class YoBuilder{
+    public:
+        addr_t here() const { return pc; }
+        void org(addr_t addr) { pc = addr; }
+        void align(addr_t n) { pc = (pc + n - 1) / n * n; }
+        void label(const std::string& name) { labels[name] = pc; pending = name + ":"; }
+        void comment(const std::string& text) { lines.push_back({NO_ADDR, {}, std::string(), "# " + text}); }
+
+        void halt() { emit({ICode::HALT << 4}, "halt"); }
+        void nop() { emit({ICode::NOP << 4}, "nop"); }
+        void rrmovq(Reg::ID rA, Reg::ID rB) { cmov(Cond::None, rA, rB); }
+        void cmov(Cond::Type fn, Reg::ID rA, Reg::ID rB){
+            emit({byte_t(ICode::RRMOVQ << 4 | fn), regs(rA, rB)}, std::string(fn == Cond::None ? "rrmovq" : "cmov") + cond(fn) + " " + reg(rA) + ", " + reg(rB));
+        }
+        void irmovq(word_t v, Reg::ID rB) { emit(withWord({ICode::IRMOVQ << 4, regs(Reg::NONE, rB)}, v), "irmovq $" + std::to_string(v) + ", " + reg(rB)); }
+        void rmmovq(Reg::ID rA, word_t d, Reg::ID rB) { emit(withWord({ICode::RMMOVQ << 4, regs(rA, rB)}, d), "rmmovq " + reg(rA) + ", " + mem(d, rB)); }
+        void mrmovq(word_t d, Reg::ID rB, Reg::ID rA) { emit(withWord({ICode::MRMOVQ << 4, regs(rA, rB)}, d), "mrmovq " + mem(d, rB) + ", " + reg(rA)); }
+        void opq(ALU::Op fn, Reg::ID rA, Reg::ID rB){
+            static const char* const names[] = {"addq", "subq", "andq", "xorq"};
+            emit({byte_t(ICode::OPQ << 4 | fn), regs(rA, rB)}, std::string(names[fn & 3]) + " " + reg(rA) + ", " + reg(rB));
+        }
+        void jxx(Cond::Type fn, const std::string& target){
+            branch({byte_t(ICode::JXX << 4 | fn)}, target, std::string(fn == Cond::None ? "jmp" : std::string("j") + cond(fn)) + " " + target);
+        }
+        void jmp(const std::string& target) { jxx(Cond::None, target); }
+        void call(const std::string& target) { branch({ICode::CALL << 4}, target, "call " + target); }
+        void ret() { emit({ICode::RET << 4}, "ret"); }
+        void pushq(Reg::ID rA) { emit({ICode::PUSHQ << 4, regs(rA, Reg::NONE)}, "pushq " + reg(rA)); }
+        void popq(Reg::ID rA) { emit({ICode::POPQ << 4, regs(rA, Reg::NONE)}, "popq " + reg(rA)); }
+        void quad(word_t v) { emit(withWord({}, v), ".quad " + std::to_string(v)); }
+
+        // 全部标号已定义时返回 .yo 文本，否则返回空串
+        std::string text() const {
+            std::string out;
+            char head[32];
+            for (const Line& l : lines){
+                if (l.addr == NO_ADDR){
+                    out += std::string(28, ' ') + "| " + l.comment + "\n";
+                    continue;
+                }
+                std::vector<byte_t> bytes = l.bytes;
+                if (!l.target.empty()){
+                    auto it = labels.find(l.target);
+                    if (it == labels.end()) return std::string();
+                    for (int i = 0; i < 8; i++) bytes[1 + i] = it->second >> (8 * i) & 0xFF;
+                }
+                snprintf(head, sizeof(head), "0x%03llx: ", static_cast<unsigned long long>(l.addr));
+                out += head;
+                for (byte_t b : bytes){
+                    snprintf(head, sizeof(head), "%02x", b);
+                    out += head;
+                }
+                out.append(bytes.size() * 2 < 20 ? 20 - bytes.size() * 2 : 0, ' ');
+                out += " | " + l.comment + "\n";
+            }
+            if (!pending.empty()){
+                // 末尾没有指令的标号（例如栈底）单独占一行
+                snprintf(head, sizeof(head), "0x%03llx: ", static_cast<unsigned long long>(pc));
+                out += head + std::string(20, ' ') + " | " + pending + "\n";
+            }
+            return out;
+        }
+
+    private:
+        static const addr_t NO_ADDR = ~addr_t(0);  // 只有注释的行
+
+        struct Line{
+            addr_t addr;
+            std::vector<byte_t> bytes;
+            std::string target;   // 非空时 bytes[1..8] 在 text() 中填入该标号的地址
+            std::string comment;
+        };
+
+        addr_t pc = 0;
+        std::vector<Line> lines;
+        std::map<std::string, addr_t> labels;
+        std::string pending;  // 下一条指令前的标号，写入注释列（Loader::scanSymbols 据此收集符号）
+
+        static byte_t regs(Reg::ID rA, Reg::ID rB) { return byte_t(rA << 4 | rB); }
+
+        // 注释列中的助记符
+        static std::string reg(Reg::ID r){
+            static const char* const names[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+                                                "r8", "r9", "r10", "r11", "r12", "r13", "r14"};
+            return r < Reg::NONE ? std::string("%") + names[r] : std::string();
+        }
+        static std::string mem(word_t d, Reg::ID rB){
+            return rB == Reg::NONE ? std::to_string(d) : std::to_string(d) + "(" + reg(rB) + ")";
+        }
+        static const char* cond(Cond::Type fn){
+            static const char* const names[] = {"", "le", "l", "e", "ne", "ge", "g"};
+            return fn <= Cond::G ? names[fn] : "?";
+        }
+
+        static std::vector<byte_t> withWord(std::vector<byte_t> bytes, word_t v){
+            for (int i = 0; i < 8; i++) bytes.push_back(static_cast<uint64_t>(v) >> (8 * i) & 0xFF);
+            return bytes;
+        }
+
+        void emit(std::vector<byte_t> bytes, const std::string& comment, const std::string& target = std::string()){
+            std::string c = pending.empty() ? comment : pending + " " + comment;
+            pending.clear();
+            lines.push_back({pc, std::move(bytes), target, c});
+            pc += lines.back().bytes.size();
+        }
+
+        void branch(std::vector<byte_t> op, const std::string& target, const std::string& comment){
+            emit(withWord(std::move(op), 0), comment, target);
+        }
+};
@@ -1,16 +1,95 @@
 # g++ -g -O0 -std=c++17 self_tests/test_register.cpp src/register.cpp -Iinclude -o test_register
 # ./test_register
 
-# g++ -g -O0 -std=c++17 self_tests/test_memory.cpp src/memory.cpp -Iinclude -o test_memory
+# g++ -g -O0 -std=c++17 self_tests/test_memory.cpp src/memory.cpp src/icache.cpp -Iinclude -o test_memory
 # ./test_memory
 
-# g++ -g -O0 -std=c++17 self_tests/test_loader.cpp src/memory.cpp src/loader.cpp -Iinclude -o test_loader
+# g++ -g -O0 -std=c++17 self_tests/test_loader.cpp src/memory.cpp src/icache.cpp src/loader.cpp -Iinclude -o test_loader
 # ./test_loader
 
-# g++ -g -O0 -std=c++17 self_tests/test_cpu.cpp src/register.cpp src/memory.cpp src/loader.cpp src/cpu.cpp -Iinclude -o test_cpu
+# g++ -g -O0 -std=c++17 self_tests/test_cpu.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp -Iinclude -o test_cpu
 # ./test_cpu
 
-# g++ -g -O0 -std=c++17 src/main.cpp src/register.cpp src/memory.cpp src/loader.cpp src/cpu.cpp -Iinclude -o y86-64_simulator
+# g++ -g -O0 -std=c++17 self_tests/test_jit.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o test_jit
+# ./test_jit
+
+# g++ -g -O0 -std=c++17 self_tests/test_trace.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o test_trace
+# ./test_trace
+
+# g++ -g -O0 -std=c++17 -Wno-psabi self_tests/test_lockstep.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/lockstep.cpp -Iinclude -o test_lockstep
+# ./test_lockstep
+
+# g++ -g -O0 -std=c++17 -pthread self_tests/test_scheduler.cpp src/scheduler.cpp -Iinclude -o test_scheduler
+# ./test_scheduler
+
+# g++ -g -O0 -std=c++17 -pthread self_tests/test_batch.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp src/scheduler.cpp src/batch.cpp -Iinclude -o test_batch
+# ./test_batch
+
+# g++ -g -O0 -std=c++17 -pthread self_tests/test_daemon.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp src/daemon.cpp -Iinclude -o test_daemon
+# ./test_daemon
+
+# g++ -g -O0 -std=c++17 -pthread self_tests/test_libY86.cpp src/libY86.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp -Iinclude -o test_libY86
+# ./test_libY86
+
+# g++ -g -O0 -std=c++17 self_tests/test_workload.cpp src/workload.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o test_workload
+# ./test_workload
+
+# g++ -g -O0 -std=c++17 self_tests/test_run_budget.cpp src/run_budget.cpp src/stats.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o test_run_budget
+# ./test_run_budget
+
+# g++ -g -O0 -std=c++17 self_tests/test_stats.cpp src/stats.cpp src/run_budget.cpp src/workload.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o test_stats
+# ./test_stats
+
+# g++ -g -O0 -std=c++17 self_tests/test_profile.cpp src/profile.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp -Iinclude -o test_profile
+# ./test_profile
+
+# g++ -g -O0 -std=c++17 -pthread src/main.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp src/scheduler.cpp src/batch.cpp src/lockstep.cpp src/daemon.cpp src/run_budget.cpp src/stats.cpp src/profile.cpp -Iinclude -o y86-64_simulator
+
+# 批量运行：一个进程内并行运行整个目录，trace 写到 temp_answer/<程序名>.json
+# ./y86-64_simulator --batch test --out temp_answer --jobs 4
+# 长程序每执行 --slice 条指令放回队列，空闲线程从其他线程的队列窃取（默认 4096，0 表示不分片）
+# ./y86-64_simulator --batch test --jobs 4 --slice 1000
+
+# 微基准：make bench 运行 bench/ 下的全部基准；只运行热点函数的微基准并缩小规模：
+# make bench BENCH=micro BENCH_ARGS=0.2
+
+# C 接口动态库（include/libY86.h）：test.py 可经 ctypes 直接调用，不再启动子进程
+# g++ -O2 -std=c++17 -shared -fPIC -fvisibility=hidden src/libY86.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp -Iinclude -o libY86.so
+# python3 test.py --lib ./libY86.so
+
+# 运行到完成：不输出逐步 trace，只输出终态与汇总（步数、停止原因、耗时、MIPS）
+# 可用 --max-steps 限制指令数、--timeout 限制墙钟秒数（均隐含 --run）
+# ./y86-64_simulator --run --engine jit < corpus/arith-100m.yo
+# ./y86-64_simulator --engine threaded --max-steps 1000000 --timeout 2.5 < corpus/branchy-100m.yo
+# --stats 在汇总中加入执行统计：按 icode 的条数、条件跳转 / 条件传送是否成立、数据读写次数、最大调用深度
+# （统计实例不经过 JIT，--engine jit 按 threaded 执行）
+# ./y86-64_simulator --stats < corpus/recurse-1m.yo
+# --profile 按 PC 统计执行次数，把按标号汇总与最热的指令（行号、.yo 注释列中的源代码）写到文件；
+# --annotate 再附上每行带执行次数的原清单（同样不经过 JIT）
+# ./y86-64_simulator --profile asumr.prof --annotate < test/asumr.yo
+
+# 常驻模式：在 Unix 域套接字上接受装载 / 运行 / 单步 / 读状态 / 复位请求（帧格式见 include/daemon.h）
+# ./y86-64_simulator --serve /tmp/y86.sock --engine threaded
+
+# AOT：把 .yo 编译为 C++ 再编译为本机程序（输出与 y86-64_simulator 相同）
+# g++ -g -O0 -std=c++17 src/yo2cpp.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o yo2cpp
+# ./yo2cpp test/prog1.yo > prog1_aot.cpp
+# g++ -O2 -std=c++17 prog1_aot.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o prog1_aot
+
+# 二进制 trace：任意步数区间还原为 JSON
+# g++ -g -O0 -std=c++17 src/y86trace.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o y86-trace
+# ./y86-64_simulator --trace binary < test/prog1.yo > prog1.trace
+# ./y86-trace prog1.trace 2 4
+
+# 合成负载：生成约执行 COUNT 条指令的程序（arith / recurse / stream / branchy / cmov），计算参考终态
+# ./y86gen branchy 10m 3 > branchy.yo
+# ./y86gen --final branchy.yo
+# 吞吐量语料：make corpus 生成 corpus/，make check-corpus 核对，make bench BENCH=corpus 比较各引擎的 MIPS
+
+# .ybo 预编译镜像：模拟器根据文件头自动识别
+# g++ -g -O0 -std=c++17 src/yo2ybo.cpp src/register.cpp src/memory.cpp src/icache.cpp src/loader.cpp src/cpu.cpp src/jit.cpp src/trace.cpp -Iinclude -o yo2ybo
+# ./yo2ybo test/prog1.yo prog1.ybo
+# ./y86-64_simulator < prog1.ybo
 mkdir -p temp_answer
 # ./y86-64_simulator < test/prog1.yo > temp_answer/prog1.json
 # diff answer/prog1.json temp_answer/prog1.json
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/batch.h"
+
+// 计数循环：约 3 * N 步
+static std::string countdown(int n) {
+    char imm[17];
+    snprintf(imm, sizeof(imm), "%02x00000000000000", n);
+    return std::string("0x000: 30f0") + imm + " | irmovq $N, %rax\n"
+           "0x00a: 30f30100000000000000 | irmovq $1, %rbx\n"
+           "0x014: 6130                 | loop: subq %rbx, %rax\n"
+           "0x016: 40000001000000000000 | rmmovq %rax, 0x100\n"
+           "0x020: 741400000000000000   | jne loop\n"
+           "0x029: 00                   | halt\n";
+}
+
+static void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// 单程序模式的完整 trace（诊断信息插在前一步的状态之后）
+static std::string expectedTrace(const std::string& path) {
+    Memory mem;
+    CPU cpu(mem);
+    if (!Loader::loadFile(path, mem)) return "[]\n";
+    std::ostringstream diag;
+    cpu.diag = &diag;
+    std::string text = "[\n";
+    for (int steps = 1; cpu.stat == Stat::AOK && steps <= 10000; steps++) {
+        cpu.step();
+        text += diag.str();
+        diag.str("");
+        appendStateJSON(text, cpu, steps);
+    }
+    return text + "\n]\n";
+}
+
+void test_batch_run() {
+    std::cout << "[TEST] Batch runner..." << std::endl;
+
+    char dirTemplate[] = "/tmp/y86_batch_XXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string out = dir + "/out";
+    assert(mkdir(out.c_str(), 0755) == 0);
+
+    writeFile(dir + "/c_long.yo", countdown(200));
+    writeFile(dir + "/a_short.yo", countdown(3));
+    writeFile(dir + "/b_bad.yo", "0x3000: 00 | out of range\n");
+    writeFile(dir + "/d_endless.yo", "0x000: 700000000000000000 | loop: jmp loop\n");
+    writeFile(dir + "/notes.txt", "not a program\n");
+
+    // 分片大小不影响结果：7 使长程序被切成许多片，0 表示一次执行完
+    for (auto config : {std::make_pair(1u, uint64_t(4096)), std::make_pair(3u, uint64_t(7)), std::make_pair(3u, uint64_t(0))}) {
+        unsigned threads = config.first;
+        BatchOptions options;
+        options.threads = threads;
+        options.slice = config.second;
+        options.outDir = out;
+        BatchRunner runner(options);
+        assert(runner.addDir(dir));
+        runner.run();
+
+        // 按文件名排序，与完成顺序无关
+        const auto& jobs = runner.jobs();
+        assert(jobs.size() == 4);
+        assert(jobs[0].name == "a_short.yo" && jobs[1].name == "b_bad.yo");
+        assert(jobs[2].name == "c_long.yo" && jobs[3].name == "d_endless.yo");
+        assert(runner.threadCount() == threads);
+
+        assert(jobs[0].loaded && jobs[0].stat == Stat::HLT && jobs[0].steps == 2 + 3 * 3 + 1);
+        assert(!jobs[1].loaded);
+        assert(jobs[2].loaded && jobs[2].stat == Stat::HLT && jobs[2].steps == 2 + 3 * 200 + 1);
+        assert(jobs[3].stat == Stat::AOK && jobs[3].steps == 10000);
+
+        // trace 与单程序模式逐字节相同
+        for (const char* name : {"a_short", "b_bad", "c_long", "d_endless"})
+            assert(readFile(out + "/" + name + ".json") == expectedTrace(dir + "/" + name + ".yo"));
+
+        std::ostringstream report;
+        runner.report(report);
+        std::string text = report.str();
+        assert(text.find("a_short.yo") < text.find("b_bad.yo"));
+        assert(text.find("load failed") != std::string::npos);
+        assert(text.find("total: 4 programs, 10615 steps") != std::string::npos);
+        if (config.second == 7) assert(runner.slices() >= 10000 / 7);
+    }
+
+    // 不输出 trace 时整片交给引擎执行，各引擎结果相同
+    for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+        BatchOptions options;
+        options.threads = 2;
+        options.slice = 100;
+        options.engine = engine;
+        BatchRunner runner(options);
+        assert(runner.addDir(dir));
+        runner.run();
+        const auto& jobs = runner.jobs();
+        assert(jobs[0].steps == 2 + 3 * 3 + 1 && jobs[2].steps == 2 + 3 * 200 + 1 && jobs[2].stat == Stat::HLT);
+        assert(jobs[3].steps == 10000 && jobs[3].stat == Stat::AOK);
+    }
+
+    BatchRunner missing{BatchOptions()};
+    assert(!missing.addDir(dir + "/no_such_dir"));
+
+    std::string cleanup = "rm -rf " + dir;
+    assert(system(cleanup.c_str()) == 0);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 非法运算 / 条件的诊断信息写进各自程序的 trace，不出现在汇总中
+void test_batch_diagnostics() {
+    std::cout << "[TEST] Batch runner: diagnostics..." << std::endl;
+
+    char dirTemplate[] = "/tmp/y86_batch_XXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+    std::string out = dir + "/out";
+    assert(mkdir(out.c_str(), 0755) == 0);
+
+    writeFile(dir + "/bad_op.yo",
+              "0x000: 30f00500000000000000 | irmovq $5, %rax\n"
+              "0x00a: 6f01                 | OPq fn 0xf\n"
+              "0x00c: 2f12                 | cmov fn 0xf\n"
+              "0x00e: 00                   | halt\n");
+    writeFile(dir + "/short.yo", countdown(3));
+
+    std::string expected = expectedTrace(dir + "/bad_op.yo");
+    assert(expected.find("}ALU报错setCC报错,\n") != std::string::npos);
+    assert(expected.find("}条件是否满足判断出错,\n") != std::string::npos);
+
+    for (unsigned threads : {1u, 2u}) {
+        BatchOptions options;
+        options.threads = threads;
+        options.outDir = out;
+        BatchRunner runner(options);
+        assert(runner.addDir(dir));
+
+        std::ostringstream captured;
+        std::streambuf* old = std::cout.rdbuf(captured.rdbuf());
+        runner.run();
+        std::ostringstream report;
+        runner.report(report);
+        std::cout.rdbuf(old);
+
+        assert(captured.str().empty());
+        assert(report.str().find("报错") == std::string::npos);
+        assert(readFile(out + "/bad_op.json") == expected);
+        assert(readFile(out + "/short.json") == expectedTrace(dir + "/short.yo"));
+    }
+
+    // 不输出 trace 时丢弃
+    BatchOptions options;
+    BatchRunner runner(options);
+    assert(runner.addDir(dir));
+    std::ostringstream captured;
+    std::streambuf* old = std::cout.rdbuf(captured.rdbuf());
+    runner.run();
+    std::cout.rdbuf(old);
+    assert(captured.str().empty() && runner.jobs()[0].stat == Stat::HLT);
+
+    std::string cleanup = "rm -rf " + dir;
+    assert(system(cleanup.c_str()) == 0);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+int main() {
+    test_batch_run();
+    test_batch_diagnostics();
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "All batch tests passed!" << std::endl;
+    return 0;
+}
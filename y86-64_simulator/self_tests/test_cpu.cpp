@@ -5,6 +5,7 @@
 #include "../include/memory.h"
 #include "../include/loader.h"
 #include "../include/cpu.h"
+#include "../include/cpu_impl.h"  // 实例化非默认的 BasicCPU
 
 // =============================================================
 // TEST 1: HALT 指令测试
@@ -111,8 +112,8 @@ void test_rrmovq() {
     assert(cpu.stat == Stat::AOK);
 
     // RRMOVQ 不应修改 CC
-    assert(cpu.cc.zf == 1);
-    assert(cpu.cc.sf == 0);
+    assert(cpu.cc.zf() == 1);
+    assert(cpu.cc.sf() == 0);
 
     std::cout << "  PASS" << std::endl;
 }
@@ -163,8 +164,8 @@ void test_irmovq() {
     assert(cpu.stat == Stat::AOK);
 
     // IRMOVQ 不修改 CC
-    assert(cpu.cc.zf == 1);
-    assert(cpu.cc.sf == 0);
+    assert(cpu.cc.zf() == 1);
+    assert(cpu.cc.sf() == 0);
 
     std::cout << "  PASS" << std::endl;
 }
@@ -313,9 +314,9 @@ void test_opq() {
     cpu.step();
 
     assert(cpu.reg.getReg(Reg::RCX) == 15);
-    assert(cpu.cc.of == false);
-    assert(cpu.cc.zf == false);
-    assert(cpu.cc.sf == false);
+    assert(cpu.cc.of() == false);
+    assert(cpu.cc.zf() == false);
+    assert(cpu.cc.sf() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -332,9 +333,9 @@ void test_opq() {
 
     cpu.step();
 
-    assert(cpu.cc.of == true);     // overflow
-    assert(cpu.cc.sf == true);     // result becomes negative
-    assert(cpu.cc.zf == false);
+    assert(cpu.cc.of() == true);     // overflow
+    assert(cpu.cc.sf() == true);     // result becomes negative
+    assert(cpu.cc.zf() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -352,9 +353,9 @@ void test_opq() {
     cpu.step();
 
     assert(cpu.reg.getReg(Reg::RCX) == 7);
-    assert(cpu.cc.of == false);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.zf == false);
+    assert(cpu.cc.of() == false);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.zf() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -372,9 +373,9 @@ void test_opq() {
     cpu.step();
 
     // Correct CC (符合 Y86 / x86 规范)
-    assert(cpu.cc.of == true);    // 溢出：正 - 负 得到负
-    assert(cpu.cc.sf == true);    // 结果 wrap 后符号位为 1（负）
-    assert(cpu.cc.zf == false);
+    assert(cpu.cc.of() == true);    // 溢出：正 - 负 得到负
+    assert(cpu.cc.sf() == true);    // 结果 wrap 后符号位为 1（负）
+    assert(cpu.cc.zf() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -392,9 +393,9 @@ void test_opq() {
     cpu.step();
 
     assert(cpu.reg.getReg(Reg::RCX) == (0b1100 & 0b1010));
-    assert(cpu.cc.of == false);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.zf == false);
+    assert(cpu.cc.of() == false);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.zf() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -412,9 +413,9 @@ void test_opq() {
     cpu.step();
 
     assert(cpu.reg.getReg(Reg::RCX) == (0b1100 ^ 0b1010));
-    assert(cpu.cc.of == false);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.zf == false);
+    assert(cpu.cc.of() == false);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.zf() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -431,9 +432,9 @@ void test_opq() {
     cpu.step();
 
     assert(cpu.reg.getReg(Reg::RAX) == 0);
-    assert(cpu.cc.zf == true);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.of == false);
+    assert(cpu.cc.zf() == true);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.of() == false);
     assert(cpu.PC == 2);
 
     // ----------------------------------------------------------
@@ -450,9 +451,9 @@ void test_opq() {
 
     cpu.step();
 
-    assert(cpu.cc.sf == true);
-    assert(cpu.cc.zf == false);
-    assert(cpu.cc.of == false);
+    assert(cpu.cc.sf() == true);
+    assert(cpu.cc.zf() == false);
+    assert(cpu.cc.of() == false);
     assert(cpu.PC == 2);
 
     std::cout << "  PASS" << std::endl;
@@ -489,9 +490,7 @@ void test_cmovXX() {
         mem.writeByte(1, (0 << 4) | 0x1);    // rA=RAX, rB=RCX
 
         // 手动设置 cc
-        cpu.cc.zf = zf;
-        cpu.cc.sf = sf;
-        cpu.cc.of = of;
+        cpu.cc.set(zf, sf, of);
 
         // 设置寄存器
         cpu.reg.setReg(Reg::RAX, srcVal);
@@ -715,9 +714,7 @@ void test_jxx() {
         mem.writeWord(1, 0x1122334455667788ULL);
 
         // 设置 CC
-        cpu.cc.zf = zf;
-        cpu.cc.sf = sf;
-        cpu.cc.of = of;
+        cpu.cc.set(zf, sf, of);
 
         // 执行
         cpu.step();
@@ -844,9 +841,9 @@ void test_call() {
     assert(cpu.PC == 0x300);
 
     // CALL 不影响条件码
-    assert(cpu.cc.zf == true);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.of == false);
+    assert(cpu.cc.zf() == true);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.of() == false);
 
     // ----------------------------------------------------------
     // CASE 2: 多次 CALL 叠加（栈是否连续正确 push）
@@ -924,9 +921,9 @@ void test_ret() {
     assert(cpu.PC == 0x350);
 
     // (3) RET 不修改 CC
-    assert(cpu.cc.zf == true);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.of == false);
+    assert(cpu.cc.zf() == true);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.of() == false);
 
     // ----------------------------------------------------------
     // CASE 2: RET 支持高位返回地址
@@ -948,9 +945,9 @@ void test_ret() {
     assert(cpu.PC == 0xFFFFFFFFFFFFFFFFULL);
 
     // CC unchanged
-    assert(cpu.cc.zf == true);
-    assert(cpu.cc.sf == false);
-    assert(cpu.cc.of == false);
+    assert(cpu.cc.zf() == true);
+    assert(cpu.cc.sf() == false);
+    assert(cpu.cc.of() == false);
 
     // ----------------------------------------------------------
     // CASE 3: RET 不应修改通用寄存器（除了 RSP）
@@ -1043,6 +1040,298 @@ void test_call_ret() {
 }
 
 
+// =============================================================
+// TEST 15: 预解码缓存失效（自修改代码）
+// =============================================================
+void test_icache_invalidate() {
+    std::cout << "[TEST] ICache invalidate..." << std::endl;
+
+    Memory mem;
+    CPU cpu(mem);
+
+    // 0x00: irmovq $1, %rax
+    mem.writeByte(0, 0x30);
+    mem.writeByte(1, 0xF0);
+    mem.writeWord(2, 1);
+
+    cpu.step();
+    assert(cpu.reg.getReg(Reg::RAX) == 1);
+    assert(mem.icache.lookup(0) != nullptr);
+
+    // 改写已缓存指令的 valC：irmovq $7, %rax
+    mem.writeWord(2, 7);
+    assert(mem.icache.lookup(0) == nullptr);
+
+    cpu.PC = 0;
+    cpu.step();
+    assert(cpu.reg.getReg(Reg::RAX) == 7);
+
+    // 改写 icode：变成 halt
+    mem.writeByte(0, 0x00);
+    cpu.PC = 0;
+    cpu.step();
+    assert(cpu.stat == Stat::HLT);
+
+    // 写入不相干的地址不应失效缓存
+    cpu.reset();
+    mem.writeByte(0, 0x10);  // nop
+    cpu.step();
+    mem.writeWord(0x100, 123);
+    assert(mem.icache.lookup(0) != nullptr);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+
+// =============================================================
+// TEST 16: THREADED 引擎与 SEQ 逐步比对
+// =============================================================
+static void assert_same_state(const CPU& a, const CPU& b) {
+    assert(a.PC == b.PC);
+    assert(a.stat == b.stat);
+    assert(a.reg.getAll() == b.reg.getAll());
+    assert(a.cc.zf() == b.cc.zf() && a.cc.sf() == b.cc.sf() && a.cc.of() == b.cc.of());
+    assert(a.mem.data == b.mem.data);
+    assert(a.mem.liveBits == b.mem.liveBits);
+}
+
+static void run_both_engines(std::string yo) {
+    Memory memSeq, memThr;
+    CPU seq(memSeq), thr(memThr);
+    thr.engine = Engine::THREADED;
+    assert(Loader::load(yo, memSeq));
+    assert(Loader::load(yo, memThr));
+
+    int steps = 0;
+    while (seq.stat == Stat::AOK && steps < 1000) {
+        seq.step();
+        thr.step();
+        assert_same_state(seq, thr);
+        steps++;
+    }
+    assert(thr.stat == seq.stat);
+
+    // run() 走各自的执行循环
+    Memory memRun;
+    CPU run(memRun);
+    run.engine = Engine::THREADED;
+    assert(Loader::load(yo, memRun));
+    run.run(1000);
+    assert_same_state(seq, run);
+}
+
+void test_threaded_engine() {
+    std::cout << "[TEST] THREADED engine vs SEQ..." << std::endl;
+
+    // 循环 + cmov + push/pop + 读写内存 + call/ret，最后 rmmovq 越界
+    run_both_engines(
+        "0x000: 30f40002000000000000 | irmovq $0x200, %rsp\n"
+        "0x00a: 30f00500000000000000 | irmovq $5, %rax\n"
+        "0x014: 30f30100000000000000 | irmovq $1, %rbx\n"
+        "0x01e: 6130                 | loop: subq %rbx, %rax\n"
+        "0x020: a00f                 | pushq %rax\n"
+        "0x022: b02f                 | popq %rdx\n"
+        "0x024: 2521                 | cmovge %rdx, %rcx\n"
+        "0x026: 40210001000000000000 | rmmovq %rdx, 0x100(%rcx)\n"
+        "0x030: 50610001000000000000 | mrmovq 0x100(%rcx), %rsi\n"
+        "0x03a: 808000000000000000   | call func\n"
+        "0x043: 741e00000000000000   | jne loop\n"
+        "0x04c: 30f1ffffffffffffff7f | irmovq $0x7fffffffffffffff, %rcx\n"
+        "0x056: 6011                 | addq %rcx, %rcx\n"
+        "0x058: 40010000000000000000 | rmmovq %rax, 0(%rcx)\n"
+        "0x080: 2076                 | func: rrmovq %rdi, %rsi\n"
+        "0x082: 90                   | ret\n");
+
+    // pushq 越界（同 prog10）：rsp 仍被写回
+    run_both_engines(
+        "0x000: 30f00100000000000000 | irmovq $1,%rax\n"
+        "0x00a: 6344                 | xorq %rsp,%rsp\n"
+        "0x00c: a00f                 | pushq %rax\n"
+        "0x00e: 6000                 | addq  %rax,%rax\n");
+
+    // popq / ret / mrmovq 越界，以及非法 icode
+    run_both_engines(
+        "0x000: 30f4f81f000000000000 | irmovq $0x1ff8, %rsp\n"
+        "0x00a: b03f                 | popq %rbx\n"
+        "0x00c: c0                   | (invalid)\n"
+        "0x00d: 90                   | ret\n");
+    run_both_engines(
+        "0x000: 5001f91f000000000000 | mrmovq 0x1ff9(%rcx), %rax\n");
+
+    // 取指越界：SEQ 沿用上一条指令（这里是第二次执行、命中预解码缓存的 ret）的中间信号重放后续阶段，
+    // rsp 再次加 8；THREADED 回退到 SEQ 流程前须恢复这些信号
+    run_both_engines(
+        "0x000: 30f40001000000000000 | irmovq $0x100,%rsp\n"
+        "0x00a: 30f00020000000000000 | irmovq $0x2000,%rax\n"
+        "0x014: a00f                 | pushq %rax\n"
+        "0x016: 30f12300000000000000 | irmovq $0x23,%rcx\n"
+        "0x020: a01f                 | pushq %rcx\n"
+        "0x022: 90                   | ret\n"
+        "0x023: 702200000000000000   | jmp 0x22\n");
+    // 读到一半越界：icode / rA / rB 来自出错的指令，valC / valP 仍是 ret 的
+    run_both_engines(
+        "0x000: 30f40001000000000000 | irmovq $0x100,%rsp\n"
+        "0x00a: 30f0fe1f000000000000 | irmovq $0x1ffe,%rax\n"
+        "0x014: a00f                 | pushq %rax\n"
+        "0x016: 30f12300000000000000 | irmovq $0x23,%rcx\n"
+        "0x020: a01f                 | pushq %rcx\n"
+        "0x022: 90                   | ret\n"
+        "0x023: 702200000000000000   | jmp 0x22\n"
+        "0x1ffe: 30f0                | irmovq (truncated)\n");
+    {
+        Memory mem;
+        CPU cpu(mem);
+        std::string yo = "0x000: 30f40001000000000000 | irmovq $0x100,%rsp\n"
+                         "0x00a: 30f00020000000000000 | irmovq $0x2000,%rax\n"
+                         "0x014: a00f                 | pushq %rax\n"
+                         "0x016: 30f12300000000000000 | irmovq $0x23,%rcx\n"
+                         "0x020: a01f                 | pushq %rcx\n"
+                         "0x022: 90                   | ret\n"
+                         "0x023: 702200000000000000   | jmp 0x22\n";
+        assert(Loader::load(yo, mem));
+        cpu.run(1000);
+        assert(cpu.stat == Stat::ADR && cpu.reg.getReg(Reg::RSP) == 264);  // 与原始实现相同
+    }
+
+    std::cout << "  PASS" << std::endl;
+}
+
+
+// =============================================================
+// TEST 17: 惰性条件码与逐条计算的结果一致
+// =============================================================
+void test_lazy_cc() {
+    std::cout << "[TEST] Lazy condition codes..." << std::endl;
+
+    const word_t vals[] = {0, 1, -1, 2, -2, INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1};
+    for (int fn = ALU::ADD; fn <= ALU::XOR; fn++) {
+        for (word_t a : vals) {
+            for (word_t b : vals) {
+                uint64_t ua = (uint64_t)a, ub = (uint64_t)b;
+                word_t e = (word_t)(fn == ALU::ADD ? ub + ua : fn == ALU::SUB ? ub - ua : fn == ALU::AND ? ub & ua : ub ^ ua);
+                bool of = false;
+                if (fn == ALU::ADD) of = (a > 0 && b > 0 && e < 0) || (a < 0 && b < 0 && e > 0);
+                if (fn == ALU::SUB) of = (a < 0 && b > 0 && e < 0) || (a > 0 && b < 0 && e > 0);
+
+                ConditionCode cc;
+                cc.record(static_cast<ALU::Op>(fn), a, b, e);
+                assert(cc.zf() == (e == 0) && cc.sf() == (e < 0) && cc.of() == of);
+
+                // 固化之后结果不变
+                cc.materialize();
+                assert(cc.zf() == (e == 0) && cc.sf() == (e < 0) && cc.of() == of);
+            }
+        }
+    }
+
+    // 记录之后再 set，以 set 为准
+    ConditionCode cc;
+    cc.record(ALU::SUB, 1, 1, 0);
+    cc.set(false, true, true);
+    assert(!cc.zf() && cc.sf() && cc.of());
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// =============================================================
+// TEST 18: 编译期特化的 BasicMemory / BasicCPU 与默认实例一致
+// =============================================================
+using FixedMemory = BasicMemory<0x2000>;
+using FixedCPU = BasicCPU<FixedMemory, CountingHooks>;
+
+// 逐步比对，返回执行的条数
+static int run_specialized(std::string yo, Engine engine) {
+    Memory mem;
+    CPU ref(mem);
+    assert(Loader::load(yo, mem));
+
+    FixedMemory fixedMem;
+    fixedMem.copyFrom(mem);
+    FixedCPU cpu(fixedMem);
+    ref.engine = cpu.engine = engine;
+
+    int steps = 0;
+    while (ref.stat == Stat::AOK && steps < 1000) {
+        ref.step();
+        cpu.step();
+        steps++;
+        assert(cpu.PC == ref.PC && cpu.stat == ref.stat);
+        assert(cpu.reg.getAll() == ref.reg.getAll());
+        assert(cpu.cc.zf() == ref.cc.zf() && cpu.cc.sf() == ref.cc.sf() && cpu.cc.of() == ref.cc.of());
+        assert(cpu.mem.data == ref.mem.data);
+    }
+    assert(cpu.hooks.steps == static_cast<uint64_t>(steps));
+    return steps;
+}
+
+void test_specialized_core() {
+    std::cout << "[TEST] Specialized BasicMemory / BasicCPU..." << std::endl;
+
+    // 自修改代码 + call / ret + 栈读写，最后 pushq 越界
+    const char* prog =
+        "0x000: 30f40002000000000000 | irmovq $0x200, %rsp\n"
+        "0x00a: 30f30300000000000000 | irmovq $3, %rbx\n"
+        "0x014: 30f10100000000000000 | irmovq $1, %rcx\n"
+        "0x01e: 30f00000000000000000 | loop: irmovq $0, %rax\n"
+        "0x028: 6010                 | addq %rcx, %rax\n"
+        "0x02a: 400f2000000000000000 | rmmovq %rax, 0x20\n"
+        "0x034: 805000000000000000   | call func\n"
+        "0x03d: 6113                 | subq %rcx, %rbx\n"
+        "0x03f: 741e00000000000000   | jne loop\n"
+        "0x048: 6344                 | xorq %rsp, %rsp\n"
+        "0x04a: a00f                 | pushq %rax\n"
+        "0x050: a00f                 | func: pushq %rax\n"
+        "0x052: b06f                 | popq %rsi\n"
+        "0x054: 90                   | ret\n";
+    run_specialized(prog, Engine::SEQ);
+    run_specialized(prog, Engine::THREADED);
+    run_specialized(prog, Engine::JIT);  // 非默认实例按 THREADED 执行
+
+    // popq / ret / mrmovq 越界
+    run_specialized(
+        "0x000: 30f4f81f000000000000 | irmovq $0x1ff8, %rsp\n"
+        "0x00a: b03f                 | popq %rbx\n"
+        "0x00c: c0                   | (invalid)\n"
+        "0x00d: 90                   | ret\n", Engine::THREADED);
+    run_specialized("0x000: 5001f91f000000000000 | mrmovq 0x1ff9(%rcx), %rax\n", Engine::SEQ);
+
+    // 插桩计数：3 轮 × (rmmovq + call + pushq + popq + ret) 加最后越界的 pushq（不计）
+    {
+        Memory mem;
+        std::string yo = prog;
+        assert(Loader::load(yo, mem));
+        FixedMemory fixedMem;
+        fixedMem.copyFrom(mem);
+        FixedCPU cpu(fixedMem);
+        cpu.engine = Engine::THREADED;
+        uint64_t n = cpu.run(1000);
+        assert(cpu.stat == Stat::ADR && cpu.hooks.steps == n);
+        assert(cpu.hooks.writes == 3 * 3 && cpu.hooks.reads == 3 * 2);
+    }
+
+    // 回绕策略：越界地址按 0x2000 取模，不产生 ADR
+    {
+        BasicMemory<0x2000, WrapBounds> wrapMem;
+        BasicCPU<BasicMemory<0x2000, WrapBounds>> cpu(wrapMem);
+        std::string yo =
+            "0x000: 30f00700000000000000 | irmovq $7, %rax\n"
+            "0x00a: 400f0820000000000000 | rmmovq %rax, 0x2008\n"
+            "0x014: 400ffc1f000000000000 | rmmovq %rax, 0x1ffc\n"
+            "0x01e: 502f0800000000000000 | mrmovq 8, %rdx\n"
+            "0x028: 00                   | halt\n";
+        Memory mem;
+        assert(Loader::load(yo, mem));
+        wrapMem.copyFrom(mem);
+        cpu.run(100);
+        bool err;
+        assert(cpu.stat == Stat::HLT && cpu.reg.getReg(Reg::RDX) == 7);
+        assert(wrapMem.readWord(0x1ffc, err) == 7 && !err);
+        assert(wrapMem.readByte(0x2000 + 0x1ffc, err) == 7 && !err);
+    }
+
+    std::cout << "  PASS" << std::endl;
+}
+
 // =============================================================
 // MAIN: 运行所有测试
 // =============================================================
@@ -1060,6 +1349,10 @@ int main() {
     test_call();
     test_ret();
     test_call_ret();  // call & ret 联合测试
+    test_icache_invalidate();
+    test_threaded_engine();
+    test_lazy_cc();
+    test_specialized_core();
 
     std::cout << "==========================" << std::endl;
     std::cout << "All CPU tests passed!" << std::endl;
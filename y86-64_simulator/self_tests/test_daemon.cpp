@@ -0,0 +1,328 @@
+#include <cassert>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/daemon.h"
+
+using namespace DaemonProto;
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+template<typename T>
+static T get(const std::string& s, size_t at) {
+    T v;
+    std::memcpy(&v, s.data() + at, sizeof(T));
+    return v;
+}
+
+static std::string u64(uint64_t v) {
+    return std::string(reinterpret_cast<const char*>(&v), 8);
+}
+
+// 应答中的状态与参考 CPU 一致
+static void expectState(const std::string& reply, size_t at, const CPU& ref, uint64_t steps) {
+    assert(get<uint64_t>(reply, at) == steps);
+    assert(get<uint64_t>(reply, at + 8) == ref.PC);
+    assert(get<uint8_t>(reply, at + 16) == static_cast<uint8_t>(ref.stat));
+    uint8_t cc = get<uint8_t>(reply, at + 17);
+    assert((cc & 1) == ref.cc.zf() && ((cc >> 1) & 1) == ref.cc.sf() && ((cc >> 2) & 1) == ref.cc.of());
+    for (int i = 0; i < 15; i++) assert(get<int64_t>(reply, at + 18 + i * 8) == ref.reg.getReg(static_cast<Reg::ID>(i)));
+}
+
+// 每个测试程序：逐步 STEP 与参考 CPU 比较（含本步写过的内存字），再 RESET 后 RUN，STATE 与 JSON 相同
+void test_daemon_programs() {
+    std::cout << "[TEST] Daemon: step / run / reset on test/*.yo..." << std::endl;
+
+    for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+        DaemonOptions options;
+        options.engine = engine;
+        Daemon daemon(options);
+        std::string reply;
+
+        DIR* d = opendir("test");
+        assert(d != nullptr);
+        uint32_t session = 0;
+        while (struct dirent* e = readdir(d)) {
+            std::string name = e->d_name;
+            if (name.size() < 3 || name.compare(name.size() - 3, 3, ".yo") != 0) continue;
+            std::string text = readFile("test/" + name);
+            session++;
+
+            Memory mem;
+            CPU ref(mem);
+            assert(Loader::load(text.data(), text.size(), mem));
+            assert(daemon.handle(LOAD, session, text.data(), text.size(), reply) == OK);
+            assert(reply.size() == 8 && get<uint64_t>(reply, 0) == 0);
+
+            uint64_t steps = 0;
+            while (ref.stat == Stat::AOK && steps < 10000) {
+                ref.step();
+                steps++;
+                assert(daemon.handle(STEP, session, nullptr, 0, reply) == OK);
+                expectState(reply, 0, ref, steps);
+                uint32_t n = get<uint32_t>(reply, STATE_SIZE);
+                assert(reply.size() == STATE_SIZE + 4 + n * 16);
+                for (uint32_t i = 0; i < n; i++) {
+                    bool error;
+                    addr_t a = get<uint64_t>(reply, STATE_SIZE + 4 + i * 16);
+                    assert(get<int64_t>(reply, STATE_SIZE + 12 + i * 16) == mem.readWord(a, error));
+                }
+            }
+            // 停止之后的 STEP 不再执行
+            assert(daemon.handle(STEP, session, nullptr, 0, reply) == OK);
+            expectState(reply, 0, ref, steps);
+
+            std::string json, expected;
+            assert(daemon.handle(STATE_JSON, session, nullptr, 0, json) == OK);
+            appendStateJSON(expected, ref, 1);
+            assert(json == expected);
+
+            assert(daemon.handle(RESET, session, nullptr, 0, reply) == OK && reply.empty());
+            std::string budget = u64(10000);
+            assert(daemon.handle(RUN, session, budget.data(), budget.size(), reply) == OK);
+            assert(get<uint64_t>(reply, 0) == steps);
+            expectState(reply, 8, ref, steps);
+
+            assert(daemon.handle(STATE, session, nullptr, 0, reply) == OK);
+            expectState(reply, 0, ref, steps);
+            size_t at = STATE_SIZE + 4;
+            mem.forEachLiveWord([&](addr_t addr, word_t val) {
+                assert(get<uint64_t>(reply, at) == addr && get<int64_t>(reply, at + 8) == val);
+                at += 16;
+            });
+            assert(get<uint32_t>(reply, STATE_SIZE) == (at - STATE_SIZE - 4) / 16 && at == reply.size());
+        }
+        closedir(d);
+        assert(session > 0 && daemon.sessionCount() == session);
+    }
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 自修改代码在 RESET 后从镜像恢复；错误请求返回 ERROR 且不影响会话
+void test_daemon_sessions() {
+    std::cout << "[TEST] Daemon: sessions, reload and errors..." << std::endl;
+
+    // 把 irmovq 的立即数改为 2，再次执行时 %rax 为 2
+    const char* text =
+        "0x000: 30f00100000000000000 | again: irmovq $1, %rax\n"
+        "0x00a: 30f30200000000000000 | irmovq $2, %rbx\n"
+        "0x014: 403f0200000000000000 | rmmovq %rbx, 2\n"
+        "0x01e: 6200                 | andq %rax, %rax\n"
+        "0x020: 6103                 | subq %rax, %rbx\n"
+        "0x022: 742c00000000000000   | jne done\n"
+        "0x02b: 00                   | halt\n"
+        "0x02c: 700000000000000000   | done: jmp again\n";
+
+    DaemonOptions options;
+    options.engine = Engine::JIT;
+    Daemon daemon(options);
+    std::string reply, budget = u64(100);
+
+    assert(daemon.handle(STEP, 1, nullptr, 0, reply) == ERROR && reply == "no such session");
+    assert(daemon.handle(LOAD, 1, text, strlen(text), reply) == OK);
+    for (int round = 0; round < 3; round++) {
+        assert(daemon.handle(RUN, 1, budget.data(), budget.size(), reply) == OK);
+        assert(get<uint64_t>(reply, 0) == 14);
+        assert(get<uint8_t>(reply, 8 + 16) == static_cast<uint8_t>(Stat::HLT));
+        assert(get<int64_t>(reply, 8 + 18) == 2);  // %rax
+        assert(daemon.handle(RESET, 1, nullptr, 0, reply) == OK);
+    }
+
+    // 装载失败时保留原来的镜像
+    std::string bad = "0x1ffff0: 00 | halt\n";
+    assert(daemon.handle(LOAD, 1, bad.data(), bad.size(), reply) == ERROR);
+    assert(daemon.handle(RUN, 1, budget.data(), 4, reply) == ERROR);
+    assert(daemon.handle(RUN, 1, budget.data(), budget.size(), reply) == OK && get<uint64_t>(reply, 0) == 14);
+    assert(daemon.handle(99, 1, nullptr, 0, reply) == ERROR);
+
+    // 同一会话重新装载另一个程序
+    std::string halt = "0x000: 10 | nop\n0x001: 00 | halt\n";
+    assert(daemon.handle(LOAD, 1, halt.data(), halt.size(), reply) == OK);
+    assert(daemon.handle(RUN, 1, budget.data(), budget.size(), reply) == OK && get<uint64_t>(reply, 0) == 2);
+    assert(daemon.handle(STATE, 1, nullptr, 0, reply) == OK && get<uint32_t>(reply, STATE_SIZE) == 1);
+
+    // 死循环：每个 RUN 至多执行 MAX_RUN_STEPS 步，再次 RUN 从停下的地方继续
+    std::string spin = "0x000: 6000 | loop: addq %rax, %rax\n0x002: 700000000000000000 | jmp loop\n";
+    std::string forever = u64(UINT64_MAX);
+    assert(daemon.handle(LOAD, 1, spin.data(), spin.size(), reply) == OK);
+    for (uint64_t round = 1; round <= 2; round++) {
+        assert(daemon.handle(RUN, 1, forever.data(), forever.size(), reply) == OK);
+        assert(get<uint64_t>(reply, 0) == MAX_RUN_STEPS);
+        assert(get<uint64_t>(reply, 8) == round * MAX_RUN_STEPS);  // 累计步数
+        assert(get<uint8_t>(reply, 8 + 16) == static_cast<uint8_t>(Stat::AOK));
+    }
+
+    assert(daemon.handle(FREE, 1, nullptr, 0, reply) == OK && daemon.sessionCount() == 0);
+    assert(daemon.handle(STATE, 1, nullptr, 0, reply) == ERROR);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 通过套接字：两个连接共享会话，断开后重连仍可继续；流水线发送的请求按顺序应答
+void test_daemon_socket() {
+    std::cout << "[TEST] Daemon: Unix socket..." << std::endl;
+
+    std::string path = "/tmp/test_daemon." + std::to_string(getpid()) + ".sock";
+    Daemon daemon;
+    assert(daemon.listen(path));
+    std::thread server([&] { daemon.serve(); });
+
+    std::string text = readFile("test/prog1.yo");
+    Memory mem;
+    CPU ref(mem);
+    assert(Loader::load(text.data(), text.size(), mem));
+
+    uint8_t result;
+    std::string reply;
+    {
+        DaemonClient a;
+        assert(a.connect(path));
+        assert(a.call(LOAD, 7, text, result, reply) && result == OK);
+        assert(a.call(STEP, 7, "", result, reply) && result == OK);
+        ref.step();
+        expectState(reply, 0, ref, 1);
+        assert(a.call(STEP, 8, "", result, reply) && result == ERROR);
+    }
+    {
+        DaemonClient b;
+        assert(b.connect(path));
+        assert(b.call(STEP, 7, "", result, reply) && result == OK);
+        ref.step();
+        expectState(reply, 0, ref, 2);
+    }
+
+    // 流水线：三个 STEP 请求一次写出，其中最后一个拆成两次写入；应答按请求顺序返回
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    assert(connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::string frames;
+    for (int i = 0; i < 3; i++) {
+        uint32_t len = 5, session = 7;
+        uint8_t op = STEP;
+        frames.append(reinterpret_cast<const char*>(&len), 4);
+        frames.append(reinterpret_cast<const char*>(&op), 1);
+        frames.append(reinterpret_cast<const char*>(&session), 4);
+    }
+    assert(write(fd, frames.data(), frames.size() - 3) == ssize_t(frames.size() - 3));
+    usleep(10000);
+    assert(write(fd, frames.data() + frames.size() - 3, 3) == 3);
+    for (uint64_t i = 0; i < 3; i++) {
+        std::string frame(4 + 1 + STATE_SIZE + 4, '\0');
+        size_t got = 0;
+        while (got < frame.size()) {
+            ssize_t k = read(fd, &frame[got], frame.size() - got);
+            assert(k > 0);
+            got += k;
+        }
+        assert(get<uint32_t>(frame, 0) == 1 + STATE_SIZE + 4 && get<uint8_t>(frame, 4) == OK);
+        ref.step();
+        expectState(frame, 5, ref, 3 + i);
+        uint32_t n = get<uint32_t>(frame, 5 + STATE_SIZE);
+        if (n > 0) {  // 本步写过内存：读出剩下的地址与值
+            std::string rest(n * 16, '\0');
+            assert(read(fd, &rest[0], rest.size()) == ssize_t(rest.size()));
+        }
+    }
+    close(fd);
+
+    // 会话不随连接关闭
+    DaemonClient c;
+    assert(c.connect(path));
+    assert(c.call(STATE_JSON, 7, "", result, reply) && result == OK);
+    std::string expected;
+    appendStateJSON(expected, ref, 1);
+    assert(reply == expected);
+
+    daemon.stop();
+    server.join();
+    assert(access(path.c_str(), F_OK) == 0);  // 套接字文件在 Daemon 析构时删除
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 不读应答的客户端：应答积压在连接的输出缓冲中，不阻塞其他连接；超过 maxPending 时断开
+void test_daemon_slow_reader() {
+    std::cout << "[TEST] Daemon: client that never reads..." << std::endl;
+
+    std::string path = "/tmp/test_daemon_slow." + std::to_string(getpid()) + ".sock";
+    DaemonOptions options;
+    options.maxPending = 1 << 20;
+    Daemon daemon(options);
+    assert(daemon.listen(path));
+    std::thread server([&] { daemon.serve(); });
+
+    std::string text = readFile("test/prog1.yo");
+    uint8_t result;
+    std::string reply;
+    DaemonClient a;
+    assert(a.connect(path));
+    assert(a.call(LOAD, 1, text, result, reply) && result == OK);
+    assert(a.call(STATE_JSON, 1, "", result, reply) && result == OK);
+    size_t replySize = 4 + 1 + reply.size();
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    assert(connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::string frames;
+    const int requests = 50000;
+    for (int i = 0; i < requests; i++) {
+        uint32_t len = 5, session = 1;
+        uint8_t op = STATE_JSON;
+        frames.append(reinterpret_cast<const char*>(&len), 4);
+        frames.append(reinterpret_cast<const char*>(&op), 1);
+        frames.append(reinterpret_cast<const char*>(&session), 4);
+    }
+    // 连接被断开后 send 失败，此时停止发送
+    for (size_t sent = 0; sent < frames.size(); ) {
+        ssize_t k = send(fd, frames.data() + sent, frames.size() - sent, MSG_NOSIGNAL);
+        if (k <= 0) break;
+        sent += k;
+    }
+
+    // 其他连接照常得到应答
+    DaemonClient b;
+    assert(b.connect(path));
+    assert(b.call(STATE_JSON, 1, "", result, reply) && result == OK);
+
+    // 积压超过上限的连接已被断开：读到的应答少于请求数
+    size_t got = 0;
+    char buf[64 << 10];
+    for (ssize_t k; (k = read(fd, buf, sizeof(buf))) > 0; ) got += k;
+    assert(got < requests * replySize);
+    close(fd);
+
+    daemon.stop();
+    server.join();
+    std::cout << "  PASS" << std::endl;
+}
+
+int main() {
+    test_daemon_programs();
+    test_daemon_sessions();
+    test_daemon_socket();
+    test_daemon_slow_reader();
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "All daemon tests passed!" << std::endl;
+    return 0;
+}
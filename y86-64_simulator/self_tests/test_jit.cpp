@@ -0,0 +1,215 @@
+#include <cassert>
+#include <iostream>
+#include "../include/global.h"
+#include "../include/register.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/jit.h"
+
+// JIT 以块为单位执行，只比较每次 run() 结束后的架构状态
+static void assert_same_state(const CPU& a, const CPU& b) {
+    assert(a.PC == b.PC);
+    assert(a.stat == b.stat);
+    assert(a.reg.getAll() == b.reg.getAll());
+    assert(a.cc.zf() == b.cc.zf() && a.cc.sf() == b.cc.sf() && a.cc.of() == b.cc.of());
+    assert(a.mem.data == b.mem.data);
+    assert(a.mem.liveBits == b.mem.liveBits);
+}
+
+// 以 slice 条为一段交替运行 JIT 与 THREADED，每段之后比较状态
+static uint64_t run_compare(std::string yo, uint64_t slice, uint64_t maxSteps = 1000000) {
+    Memory memRef, memJit;
+    CPU ref(memRef), jit(memJit);
+    ref.engine = Engine::THREADED;
+    jit.engine = Engine::JIT;
+    assert(Loader::load(yo, memRef));
+    assert(Loader::load(yo, memJit));
+
+    uint64_t total = 0;
+    while (ref.stat == Stat::AOK && total < maxSteps) {
+        uint64_t a = ref.run(slice);
+        uint64_t b = jit.run(slice);
+        assert(a == b);
+        assert_same_state(ref, jit);
+        total += a;
+    }
+    assert(jit.stat == ref.stat);
+    return total;
+}
+
+// 循环 + cmov + push/pop + 读写内存 + call/ret，最后 rmmovq 越界
+static const char* LOOP_PROG =
+    "0x000: 30f40002000000000000 | irmovq $0x200, %rsp\n"
+    "0x00a: 30f0e803000000000000 | irmovq $1000, %rax\n"
+    "0x014: 30f30100000000000000 | irmovq $1, %rbx\n"
+    "0x01e: 6130                 | loop: subq %rbx, %rax\n"
+    "0x020: a00f                 | pushq %rax\n"
+    "0x022: b02f                 | popq %rdx\n"
+    "0x024: 2521                 | cmovge %rdx, %rcx\n"
+    "0x026: 40210001000000000000 | rmmovq %rdx, 0x100(%rcx)\n"
+    "0x030: 50610001000000000000 | mrmovq 0x100(%rcx), %rsi\n"
+    "0x03a: 808000000000000000   | call func\n"
+    "0x043: 6200                 | andq %rax, %rax\n"
+    "0x045: 741e00000000000000   | jne loop\n"
+    "0x04e: 30f1ffffffffffffff7f | irmovq $0x7fffffffffffffff, %rcx\n"
+    "0x058: 6011                 | addq %rcx, %rcx\n"
+    "0x05a: 40010000000000000000 | rmmovq %rax, 0(%rcx)\n"
+    "0x080: 6067                 | func: addq %rsi, %rdi\n"
+    "0x082: 90                   | ret\n";
+
+void test_jit_loop() {
+    std::cout << "[TEST] JIT loop program..." << std::endl;
+
+    // 一次跑完 / 小步切片（覆盖预算不足时的解释执行与块链接）
+    run_compare(LOOP_PROG, 1000000);
+    run_compare(LOOP_PROG, 7);
+    run_compare(LOOP_PROG, 1);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+void test_jit_flags() {
+    std::cout << "[TEST] JIT condition codes..." << std::endl;
+
+    // 覆盖 add/sub 溢出边界（含 INT64_MIN + INT64_MIN = 0 以及 0 - INT64_MIN）与各条件跳转
+    run_compare(
+        "0x000: 30f00000000000000080 | irmovq $0x8000000000000000, %rax\n"
+        "0x00a: 2001                 | rrmovq %rax, %rcx\n"
+        "0x00c: 6001                 | addq %rax, %rcx\n"
+        "0x00e: 30f20000000000000000 | irmovq $0, %rdx\n"
+        "0x018: 6102                 | subq %rax, %rdx\n"
+        "0x01a: 2623                 | cmovg %rdx, %rbx\n"
+        "0x01c: 30f6ffffffffffffff7f | irmovq $0x7fffffffffffffff, %rsi\n"
+        "0x026: 6066                 | addq %rsi, %rsi\n"
+        "0x028: 2167                 | cmovle %rsi, %rdi\n"
+        "0x02a: 6106                 | subq %rax, %rsi\n"
+        "0x02c: 2268                 | cmovl %rsi, %r8\n"
+        "0x02e: 6300                 | xorq %rax, %rax\n"
+        "0x030: 733b00000000000000   | je target\n"
+        "0x039: 00                   | halt\n"
+        "0x03b: 750000000000000000   | target: jge 0\n",
+        1000, 5000);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+void test_jit_self_modifying() {
+    std::cout << "[TEST] JIT self-modifying code..." << std::endl;
+
+    // 循环体内的 rmmovq 改写下一轮要执行的 irmovq 立即数（rax 每轮加 1）
+    uint64_t steps = run_compare(
+        "0x000: 30f40002000000000000 | irmovq $0x200, %rsp\n"
+        "0x00a: 30f30500000000000000 | irmovq $5, %rbx\n"
+        "0x014: 30f10100000000000000 | irmovq $1, %rcx\n"
+        "0x01e: 30f00000000000000000 | loop: irmovq $0, %rax\n"
+        "0x028: 6010                 | addq %rcx, %rax\n"
+        "0x02a: 400f2000000000000000 | rmmovq %rax, 0x20\n"
+        "0x034: 6113                 | subq %rcx, %rbx\n"
+        "0x036: 741e00000000000000   | jne loop\n"
+        "0x03f: 00                   | halt\n",
+        1000000);
+    assert(steps == 3 + 5 * 5 + 1);
+
+    // 宿主在两次 run 之间改写代码
+    Memory mem;
+    CPU cpu(mem);
+    cpu.engine = Engine::JIT;
+    mem.writeByte(0, 0x30);
+    mem.writeByte(1, 0xF0);
+    mem.writeWord(2, 1);
+    mem.writeByte(10, 0x00);
+    cpu.run(100);
+    assert(cpu.stat == Stat::HLT && cpu.reg.getReg(Reg::RAX) == 1);
+
+    mem.writeWord(2, 42);
+    cpu.PC = 0;
+    cpu.stat = Stat::AOK;
+    cpu.run(100);
+    assert(cpu.stat == Stat::HLT && cpu.reg.getReg(Reg::RAX) == 42);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+void test_jit_faults() {
+    std::cout << "[TEST] JIT ADR / INS fallbacks..." << std::endl;
+
+    // pushq 越界（同 prog10）
+    run_compare(
+        "0x000: 30f00100000000000000 | irmovq $1,%rax\n"
+        "0x00a: 6344                 | xorq %rsp,%rsp\n"
+        "0x00c: a00f                 | pushq %rax\n"
+        "0x00e: 6000                 | addq  %rax,%rax\n",
+        1000);
+    // popq / ret / mrmovq 越界，以及非法 icode
+    run_compare(
+        "0x000: 30f4f81f000000000000 | irmovq $0x1ff8, %rsp\n"
+        "0x00a: b03f                 | popq %rbx\n"
+        "0x00c: c0                   | (invalid)\n"
+        "0x00d: 90                   | ret\n",
+        1000);
+    run_compare(
+        "0x000: 5001f91f000000000000 | mrmovq 0x1ff9(%rcx), %rax\n",
+        1000);
+    // 跳出内存范围
+    run_compare(
+        "0x000: 70ffffffffffffff00   | jmp 0xffffffffffffff\n",
+        1000);
+
+    // 本机代码执行后取指越界：SEQ 沿用最后执行的指令的中间信号重放后续阶段，
+    // JIT 须记录块内最后执行的指令（包括经块链接进入的块在第一条之前退出的情形）
+    const char* faults[] = {
+        // 热的 ret 返回到范围外：rsp 再加 8
+        "0x000: 30f40001000000000000 | irmovq $0x100,%rsp\n"
+        "0x00a: 30f00020000000000000 | irmovq $0x2000,%rax\n"
+        "0x014: a00f                 | pushq %rax\n"
+        "0x016: 30f12300000000000000 | irmovq $0x23,%rcx\n"
+        "0x020: a01f                 | pushq %rcx\n"
+        "0x022: 90                   | ret\n"
+        "0x023: 702200000000000000   | jmp 0x22\n",
+        // call 到范围外：重放 call，再压一次返回地址
+        "0x000: 30f40001000000000000 | irmovq $0x100,%rsp\n"
+        "0x00a: 30f00300000000000000 | irmovq $3,%rax\n"
+        "0x014: 6000                 | loop: addq %rax,%rax\n"
+        "0x016: 701f00000000000000   | jmp next\n"
+        "0x01f: 6010                 | next: addq %rcx,%rax\n"
+        "0x021: 800020000000000000   | call 0x2000\n",
+        // 条件跳转到范围外：重放 jXX 没有架构效果，但前一条 OPq 不会被重放
+        "0x000: 30f00500000000000000 | irmovq $5,%rax\n"
+        "0x00a: 30f30100000000000000 | irmovq $1,%rbx\n"
+        "0x014: 6130                 | loop: subq %rbx,%rax\n"
+        "0x016: 741400000000000000   | jne loop\n"
+        "0x01f: 6000                 | addq %rax,%rax\n"
+        "0x021: 73f01f000000000000   | je 0x1ff0\n"
+        "0x1ff0: 6033                | addq %rbx,%rbx\n"
+        "0x1ff2: 70fe1f000000000000  | jmp 0x1ffe\n"
+        "0x1ffe: 30f0                | irmovq (truncated)\n",
+    };
+    for (std::string yo : faults) {
+        Memory memSeq, memJit;
+        CPU seq(memSeq), jit(memJit);
+        jit.engine = Engine::JIT;
+        assert(Loader::load(yo, memSeq) && Loader::load(yo, memJit));
+        seq.run(1000);
+        jit.run(1000);
+        assert(seq.stat == Stat::ADR);
+        assert_same_state(seq, jit);
+        for (uint64_t slice : {1, 2, 3, 5, 1000}) run_compare(yo, slice);
+    }
+
+    std::cout << "  PASS" << std::endl;
+}
+
+int main() {
+    if (!JIT::available())
+        std::cout << "(native JIT unavailable, testing interpreter fallback)" << std::endl;
+
+    test_jit_loop();
+    test_jit_flags();
+    test_jit_self_modifying();
+    test_jit_faults();
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "All JIT tests passed!" << std::endl;
+    return 0;
+}
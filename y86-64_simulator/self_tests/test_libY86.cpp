@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/libY86.h"
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static std::vector<std::string> programs() {
+    std::vector<std::string> texts;
+    DIR* d = opendir("test");
+    assert(d != nullptr);
+    while (struct dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".yo") == 0) texts.push_back(readFile("test/" + name));
+    }
+    closedir(d);
+    assert(!texts.empty());
+    return texts;
+}
+
+// 句柄的状态与参考 CPU 一致
+static void expectSame(const y86_sim* sim, const CPU& ref) {
+    assert(y86_stat(sim) == static_cast<int>(ref.stat));
+    assert(y86_pc(sim) == ref.PC);
+    int cc = y86_cc(sim);
+    assert(!!(cc & Y86_CC_ZF) == ref.cc.zf() && !!(cc & Y86_CC_SF) == ref.cc.sf() && !!(cc & Y86_CC_OF) == ref.cc.of());
+
+    int64_t regs[Y86_NUM_REGS];
+    y86_get_regs(sim, regs);
+    for (int i = 0; i < Y86_NUM_REGS; i++) assert(regs[i] == ref.reg.getReg(static_cast<Reg::ID>(i)));
+
+    std::vector<uint64_t> addrs(4);
+    std::vector<int64_t> values(4);
+    size_t n = y86_live_words(sim, addrs.data(), values.data(), addrs.size());
+    if (n > addrs.size()) {
+        addrs.resize(n);
+        values.resize(n);
+        assert(y86_live_words(sim, addrs.data(), values.data(), n) == n);
+    }
+    size_t i = 0;
+    ref.mem.forEachLiveWord([&](addr_t addr, word_t val) {
+        assert(i < n && addrs[i] == addr && values[i] == val);
+        i++;
+    });
+    assert(i == n);
+}
+
+// 每个测试程序在三种引擎下逐步执行，与 SEQ 参考比较
+void test_lib_programs() {
+    std::cout << "[TEST] libY86: test/*.yo step by step..." << std::endl;
+
+    assert(y86_abi_version() == Y86_ABI_VERSION);
+    assert(y86_create(0, 3) == nullptr);
+
+    for (int engine : {Y86_ENGINE_SEQ, Y86_ENGINE_THREADED, Y86_ENGINE_JIT}) {
+        y86_sim* sim = y86_create(0, engine);
+        for (const auto& text : programs()) {
+            Memory mem;
+            CPU ref(mem);
+            assert(Loader::load(text.data(), text.size(), mem));
+            assert(y86_load(sim, text.data(), text.size()) == 0);
+            expectSame(sim, ref);
+            uint64_t steps = 0;
+            while (steps < 10000 && ref.run(1) == 1) {
+                assert(y86_run(sim, 1) == 1);
+                expectSame(sim, ref);
+                steps++;
+            }
+            assert(y86_steps(sim) == steps);
+            if (ref.stat != Stat::AOK) assert(y86_run(sim, 100) == 0);
+        }
+        y86_destroy(sim);
+    }
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 读写内存（含改写代码）、寄存器与 PC，快照恢复到原句柄与另一个句柄
+void test_lib_state() {
+    std::cout << "[TEST] libY86: memory, registers, snapshots..." << std::endl;
+
+    const char* text =
+        "0x000: 30f00a00000000000000 | irmovq $10, %rax\n"
+        "0x00a: 30f30100000000000000 | irmovq $1, %rbx\n"
+        "0x014: 6130                 | loop: subq %rbx, %rax\n"
+        "0x016: 400f0001000000000000 | rmmovq %rax, 0x100\n"
+        "0x020: 741400000000000000   | jne loop\n"
+        "0x029: 00                   | halt\n";
+
+    for (int engine : {Y86_ENGINE_SEQ, Y86_ENGINE_JIT}) {
+        y86_sim* sim = y86_create(0x10000 + 0x1000, engine);
+        assert(y86_load(sim, text, strlen(text)) == 0);
+        assert(y86_run(sim, 8) == 8);  // 两个 irmovq 之后两轮循环，0x100 处为 8
+
+        // 共 2 + 3 * 10 + 1 步
+        y86_snapshot* snap = y86_snapshot_take(sim);
+        assert(y86_run(sim, 1000) == 25);
+        assert(y86_stat(sim) == Y86_STAT_HLT && y86_steps(sim) == 33);
+        int64_t out;
+        assert(y86_read_mem(sim, 0x100, &out, 8) == 0 && out == 0);
+
+        // 恢复到原句柄：从第 8 步继续，结果相同
+        assert(y86_snapshot_restore(sim, snap) == 0);
+        assert(y86_steps(sim) == 8 && y86_stat(sim) == Y86_STAT_AOK);
+        assert(y86_read_mem(sim, 0x100, &out, 8) == 0 && out == 8);
+        assert(y86_run(sim, 1000) == 25 && y86_stat(sim) == Y86_STAT_HLT);
+
+        // 恢复到另一个句柄，把 jne 改为 halt：再执行一轮的 subq / rmmovq 后停止
+        y86_sim* other = y86_create(0x10000 + 0x1000, Y86_ENGINE_THREADED);
+        assert(y86_snapshot_restore(other, snap) == 0);
+        unsigned char code = 0x00;
+        assert(y86_write_mem(other, 0x020, &code, 1) == 0);
+        assert(y86_run(other, 1000) == 3 && y86_stat(other) == Y86_STAT_HLT);
+        assert(y86_read_mem(other, 0x100, &out, 8) == 0 && out == 7);
+
+        // 快照中的代码未被改写；设置寄存器与 PC 后从循环开头执行两轮
+        assert(y86_snapshot_restore(other, snap) == 0);
+        assert(y86_read_mem(other, 0x020, &code, 1) == 0 && code == 0x74);
+        int64_t regs[Y86_NUM_REGS] = {};
+        regs[0] = 2;
+        regs[3] = 1;
+        y86_set_regs(other, regs);
+        y86_set_pc(other, 0x014);
+        assert(y86_run(other, 1000) == 3 * 2 + 1);
+        y86_get_regs(other, regs);
+        assert(regs[0] == 0 && regs[3] == 1);
+
+        // 分页区的读写与越界
+        int64_t word = 0x1122334455667788;
+        assert(y86_write_mem(sim, 0x10800, &word, 8) == 0);
+        assert(y86_read_mem(sim, 0x10800, &out, 8) == 0 && out == word);
+        assert(y86_write_mem(sim, 0x10ffc, &word, 8) == -1 && y86_read_mem(sim, 0x10ffc, &out, 8) == -1);
+        uint64_t a[4];
+        int64_t v[4];
+        assert(y86_live_words(sim, a, v, 4) >= 2 && y86_live_words(sim, nullptr, nullptr, 0) == y86_live_words(sim, a, v, 4));
+
+        // 地址空间大小不同的句柄不能恢复
+        y86_sim* small = y86_create(0, Y86_ENGINE_SEQ);
+        assert(y86_snapshot_restore(small, snap) == -1);
+
+        // 装载失败
+        assert(y86_load(small, "0x3000: 00 | halt\n", 18) == -1);
+
+        y86_snapshot_free(snap);
+        y86_destroy(small);
+        y86_destroy(other);
+        y86_destroy(sim);
+    }
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 重新装载或恢复快照后，第一次取指出错的结果与新建的句柄相同，不重放上一个程序的指令；
+// 非法运算的诊断信息不写到宿主进程的标准输出 / 标准错误
+void test_lib_reload() {
+    std::cout << "[TEST] libY86: reload, restore, diagnostics..." << std::endl;
+
+    const char* first = "0x000: 30f30700000000000000 | irmovq $7, %rbx\n"
+                        "0x00a: 00                   | halt\n";
+    const char* second = "0x000: 30f10900000000000000 | irmovq $9, %rcx\n"
+                         "0x00a: 00                   | halt\n";
+    const char* badOp = "0x000: 30f00500000000000000 | irmovq $5, %rax\n"
+                        "0x00a: 6f01                 | OPq fn 0xf\n"
+                        "0x00c: 2f12                 | cmov fn 0xf\n"
+                        "0x00e: 00                   | halt\n";
+
+    // 参考：新建的句柄装入 second，从地址空间之外取指
+    y86_sim* fresh = y86_create(0, Y86_ENGINE_SEQ);
+    assert(y86_load(fresh, second, strlen(second)) == 0);
+    y86_snapshot* snap = y86_snapshot_take(fresh);
+    y86_set_pc(fresh, 0x3000);
+    assert(y86_run(fresh, 1) == 1 && y86_stat(fresh) == Y86_STAT_ADR);
+    int64_t expected[Y86_NUM_REGS];
+    y86_get_regs(fresh, expected);
+
+    for (int engine : {Y86_ENGINE_SEQ, Y86_ENGINE_THREADED, Y86_ENGINE_JIT}) {
+        for (bool restore : {false, true}) {
+            y86_sim* sim = y86_create(0, engine);
+            assert(y86_load(sim, first, strlen(first)) == 0);
+            assert(y86_run(sim, 1) == 1);
+            if (restore) assert(y86_snapshot_restore(sim, snap) == 0);
+            else assert(y86_load(sim, second, strlen(second)) == 0);
+            y86_set_pc(sim, 0x3000);
+            assert(y86_run(sim, 1) == 1 && y86_stat(sim) == Y86_STAT_ADR);
+            int64_t regs[Y86_NUM_REGS];
+            y86_get_regs(sim, regs);
+            assert(std::equal(regs, regs + Y86_NUM_REGS, expected));
+            y86_destroy(sim);
+        }
+
+        std::ostringstream out, err;
+        std::streambuf* oldOut = std::cout.rdbuf(out.rdbuf());
+        std::streambuf* oldErr = std::cerr.rdbuf(err.rdbuf());
+        y86_sim* sim = y86_create(0, engine);
+        assert(y86_load(sim, badOp, strlen(badOp)) == 0);
+        assert(y86_run(sim, 100) == 4 && y86_stat(sim) == Y86_STAT_HLT);
+        y86_destroy(sim);
+        std::cout.rdbuf(oldOut);
+        std::cerr.rdbuf(oldErr);
+        assert(out.str().empty() && err.str().empty());
+    }
+
+    y86_snapshot_free(snap);
+    y86_destroy(fresh);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 多个线程各自使用自己的句柄，结果与单线程相同
+void test_lib_threads() {
+    std::cout << "[TEST] libY86: concurrent handles..." << std::endl;
+
+    std::vector<std::string> texts = programs();
+    std::vector<uint64_t> expected;
+    for (const auto& text : texts) {
+        y86_sim* sim = y86_create(0, Y86_ENGINE_SEQ);
+        y86_load(sim, text.data(), text.size());
+        expected.push_back(y86_run(sim, 10000) * 16 + y86_stat(sim));
+        y86_destroy(sim);
+    }
+
+    const int THREADS = 8;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t] {
+            y86_sim* sim = y86_create(0, t % 3);
+            for (int round = 0; round < 20; round++) {
+                for (size_t i = 0; i < texts.size(); i++) {
+                    assert(y86_load(sim, texts[i].data(), texts[i].size()) == 0);
+                    uint64_t n = 0;
+                    while (y86_stat(sim) == Y86_STAT_AOK && n < 10000) n += y86_run(sim, std::min<uint64_t>(1 + round, 10000 - n));
+                    assert(n * 16 + y86_stat(sim) == expected[i]);
+                }
+            }
+            y86_destroy(sim);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "  PASS" << std::endl;
+}
+
+int main() {
+    test_lib_programs();
+    test_lib_state();
+    test_lib_reload();
+    test_lib_threads();
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "All libY86 tests passed!" << std::endl;
+    return 0;
+}
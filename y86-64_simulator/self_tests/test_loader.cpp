@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <iostream>
 #include "../include/loader.h"
 #include "../include/memory.h"
+#include "../include/yo_builder.h"
 
 void test_basic_instruction_load() {
     std::cout << "[TEST] basic instruction load\n";
@@ -144,6 +147,158 @@ void test_out_of_bound_write() {
     std::cout << "  PASS\n";
 }
 
+void test_legacy_parse_rules() {
+    std::cout << "[TEST] parse rules of the original stoull / stoi loader\n";
+
+    Memory mem;
+    bool err = false;
+
+    // CRLF：行尾的 \r 作为最后一个“字节”解析失败，之前的字节保留
+    std::string crlf = "0x000: 30f4\r\n0x010: 11 | x\r\n";
+    assert(Loader::load(crlf, mem));
+    assert(mem.readByte(0x000, err) == 0x30 && mem.readByte(0x001, err) == 0xf4);
+    assert(mem.readByte(0x002, err) == 0x00 && mem.readByte(0x010, err) == 0x11);
+
+    // 两个字符一组：可带前导空白、正负号，遇到非 hex 字符截断
+    std::string pairs = "0x60: +1-1 2 \n0x70: 12zz34\n";
+    assert(Loader::load(pairs, mem));
+    assert(mem.readByte(0x60, err) == 0x01 && mem.readByte(0x61, err) == 0xff);
+    assert(mem.readByte(0x62, err) == 0x02);
+    assert(mem.readByte(0x70, err) == 0x12 && mem.readByte(0x71, err) == 0x00);
+
+    // 地址后的多余字符被忽略；竖线在冒号之前时该行地址无效
+    std::string addrs = "0x50zz: 66\n| 0x30: 44\n\t0XB0: Ff";
+    assert(Loader::load(addrs, mem));
+    assert(mem.readByte(0x50, err) == 0x66 && mem.readByte(0x30, err) == 0x00);
+    assert(mem.readByte(0xb0, err) == 0xff);
+
+    // 地址溢出的行跳过，负地址按无符号回绕后越界
+    std::string overflow = "0xfffffffffffffffff: 11\n0x90: 22\n";
+    assert(Loader::load(overflow, mem));
+    assert(mem.readByte(0x90, err) == 0x22);
+    std::string negative = "-0x8: 11\n";
+    assert(!Loader::load(negative, mem));
+
+    std::cout << "  PASS\n";
+}
+
+void test_load_file() {
+    std::cout << "[TEST] loadFile / loadFd\n";
+
+    const char* path = "/tmp/y86_test_loader.yo";
+    FILE* f = fopen(path, "w");
+    fputs("0x000: 30f40002000000000000 | irmovq\n0x00a: 00 | halt", f);
+    fclose(f);
+
+    Memory mem;
+    bool err = false;
+    assert(Loader::loadFile(path, mem));
+    assert(mem.readByte(0x000, err) == 0x30 && mem.readByte(0x002, err) == 0x00);
+    assert(mem.readByte(0x003, err) == 0x02);
+
+    // 空文件：与空字符串相同，清空内存后返回 true
+    f = fopen(path, "w");
+    fclose(f);
+    assert(Loader::loadFile(path, mem));
+    assert(mem.readByte(0x000, err) == 0x00);
+
+    assert(!Loader::loadFile("/nonexistent/prog.yo", mem));
+    std::remove(path);
+
+    std::cout << "  PASS\n";
+}
+
+void test_image_round_trip() {
+    std::cout << "[TEST] .ybo image round trip\n";
+
+    std::string yo =
+        "0x000: 30f40002000000000000 | \tirmovq stack, %rsp\n"
+        "0x00a: 801400000000000000   | \tcall main\n"
+        "0x013: 00                   | \thalt\n"
+        "0x014:                      | main:\n"
+        "0x014: 90                   | \tret\n"
+        "0x100: 0d000d000d000000     | array: .quad 0x000d000d000d\n"
+        "0x200:                      | stack:\n";
+
+    Memory mem;
+    Image info;
+    assert(Loader::load(yo.data(), yo.size(), mem, &info));
+    assert(info.entry == 0);
+    assert(info.symbols.size() == 3);
+    assert(info.symbols[0].first == 0x014 && info.symbols[0].second == "main");
+    assert(info.symbols[1].first == 0x100 && info.symbols[1].second == "array");
+    assert(info.symbols[2].first == 0x200 && info.symbols[2].second == "stack");
+
+    info.entry = 0x014;
+    std::string image = Loader::buildImage(mem, info);
+    assert(Loader::isImage(image.data(), image.size()));
+    assert(!Loader::isImage(yo.data(), yo.size()));
+
+    Memory loaded;
+    Image loadedInfo;
+    assert(Loader::load(image, loaded));  // 不关心入口与符号时同样可以装入
+    assert(Loader::load(image.data(), image.size(), loaded, &loadedInfo));
+    assert(loaded.data == mem.data);
+    assert(loaded.liveBits == mem.liveBits);
+    assert(loadedInfo.entry == 0x014);
+    assert(loadedInfo.symbols == info.symbols);
+
+    // 截断的镜像
+    std::string truncated = image.substr(0, image.size() - 1);
+    assert(!Loader::load(truncated, loaded));
+
+    std::cout << "  PASS\n";
+}
+
+void test_yo_builder() {
+    std::cout << "[TEST] YoBuilder output\n";
+
+    // 向后的跳转目标在 text() 时回填
+    YoBuilder b;
+    b.irmovq(0x200, Reg::RSP);
+    b.call("main");
+    b.halt();
+    b.org(0x014);
+    b.label("main");
+    b.mrmovq(-8, Reg::RSP, Reg::RAX);
+    b.cmov(Cond::GE, Reg::RAX, Reg::RCX);
+    b.jxx(Cond::NE, "main");
+    b.ret();
+    b.align(8);
+    b.label("array");
+    b.quad(-2);
+    b.org(0x200);
+    b.label("stack");
+    std::string yo = b.text();
+
+    Memory mem;
+    Image info;
+    assert(Loader::load(yo.data(), yo.size(), mem, &info));
+    const byte_t expected[] = {
+        0x30, 0xf4, 0x00, 0x02, 0, 0, 0, 0, 0, 0,     // irmovq $0x200, %rsp
+        0x80, 0x14, 0, 0, 0, 0, 0, 0, 0,              // call main
+        0x00,                                         // halt
+        0x50, 0x04, 0xf8, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,  // mrmovq -8(%rsp), %rax
+        0x25, 0x01,                                   // cmovge %rax, %rcx
+        0x74, 0x14, 0, 0, 0, 0, 0, 0, 0,              // jne main
+        0x90,                                         // ret
+    };
+    assert(std::equal(expected, expected + sizeof(expected), mem.data.begin()));
+    bool error;
+    assert(b.here() == 0x200 && mem.readWord(0x030, error) == -2);
+    assert(info.symbols.size() == 3);
+    assert(info.symbols[0].first == 0x014 && info.symbols[0].second == "main");
+    assert(info.symbols[1].first == 0x030 && info.symbols[1].second == "array");
+    assert(info.symbols[2].first == 0x200 && info.symbols[2].second == "stack");
+
+    // 未定义的标号
+    YoBuilder bad;
+    bad.jmp("nowhere");
+    assert(bad.text().empty());
+
+    std::cout << "  PASS\n";
+}
+
 int main() {
     std::cout << '\n';
     test_basic_instruction_load();
@@ -153,5 +308,9 @@ int main() {
     test_wrong_hex_should_skip_line();
     test_addr_parse_failure();
     test_out_of_bound_write();
+    test_legacy_parse_rules();
+    test_load_file();
+    test_image_round_trip();
+    test_yo_builder();
     std::cout << "\n=== Loader Tests All Passed ===\n";
 }
@@ -0,0 +1,247 @@
+#include <cassert>
+#include <cstdint>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/lockstep.h"
+
+static std::vector<std::pair<addr_t, word_t>> liveWords(const Memory& mem) {
+    std::vector<std::pair<addr_t, word_t>> words;
+    mem.forEachLiveWord([&](addr_t addr, word_t val) { words.push_back({addr, val}); });
+    return words;
+}
+
+// lane 与单独运行的 CPU 状态完全一致
+static void expectSame(const LockstepCPU& ls, size_t lane, const CPU& ref) {
+    for (int r = 0; r < Reg::NONE; r++)
+        assert(ls.getReg(lane, static_cast<Reg::ID>(r)) == ref.reg.getReg(static_cast<Reg::ID>(r)));
+    assert(ls.getPC(lane) == ref.PC);
+    assert(ls.getStat(lane) == ref.stat);
+
+    Memory scratch;
+    CPU cpu(scratch);
+    ls.copyTo(lane, cpu);
+    assert(cpu.cc.zf() == ref.cc.zf() && cpu.cc.sf() == ref.cc.sf() && cpu.cc.of() == ref.cc.of());
+    assert(liveWords(ls.memory(lane)) == liveWords(ref.mem));
+}
+
+// 每个 lane 的初始寄存器由 init(lane, reg) 给出；分 chunk 步多次 run，每次之后与 SEQ 参考逐 lane 比较
+// 返回交给标量 CPU 执行的指令数
+template<typename Init>
+static uint64_t compareLanes(const std::string& text, size_t lanes, uint64_t chunk, uint64_t total, Init init) {
+    LockstepCPU ls(lanes);
+    assert(ls.load(text.data(), text.size()));
+
+    std::vector<std::unique_ptr<Memory>> mems;
+    std::vector<std::unique_ptr<CPU>> refs;
+    for (size_t i = 0; i < lanes; i++) {
+        mems.emplace_back(new Memory());
+        refs.emplace_back(new CPU(*mems.back()));
+        assert(Loader::load(text.data(), text.size(), *mems.back()));
+        for (int r = 0; r < Reg::NONE; r++) {
+            word_t v = init(i, r);
+            ls.setReg(i, static_cast<Reg::ID>(r), v);
+            refs.back()->reg.setReg(static_cast<Reg::ID>(r), v);
+        }
+    }
+
+    for (uint64_t done = 0; done < total; done += chunk) {
+        uint64_t n = ls.run(chunk);
+        uint64_t expected = 0;
+        for (size_t i = 0; i < lanes; i++) {
+            expected += refs[i]->run(chunk);
+            expectSame(ls, i, *refs[i]);
+            assert(ls.steps(i) == done + chunk || ls.getStat(i) != Stat::AOK);
+        }
+        assert(n == expected);
+    }
+    return ls.scalarSteps();
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void test_lockstep_programs() {
+    std::cout << "[TEST] Lockstep: test/*.yo..." << std::endl;
+
+    DIR* d = opendir("test");
+    assert(d != nullptr);
+    int programs = 0;
+    while (struct dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.size() < 3 || name.compare(name.size() - 3, 3, ".yo") != 0) continue;
+        // 不同 lane 的初始寄存器不同，程序自己设置的寄存器不受影响
+        compareLanes(readFile("test/" + name), 6, 10000, 10000, [](size_t lane, int r) {
+            return static_cast<word_t>(lane * 0x101 * (r + 1));
+        });
+        programs++;
+    }
+    closedir(d);
+    assert(programs > 0);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 按 %rdi 计数的循环：每轮 pushq / call / popq，奇偶不同的 cmov，rmmovq 的地址取决于 %r8（过大时 ADR），
+// 另外把 %r9 写到 %r10 处：指向数据区时无影响，指向代码时该 lane 改写了自己的代码
+static const char* DIVERGENT =
+    "0x000: 30f40010000000000000 | irmovq $0x1000, %rsp\n"
+    "0x00a: 30f30100000000000000 | irmovq $1, %rbx\n"
+    "0x014: 6277                 | loop: andq %rdi, %rdi\n"
+    "0x016: 733700000000000000   | je done\n"
+    "0x01f: a07f                 | pushq %rdi\n"
+    "0x021: 804000000000000000   | call body\n"
+    "0x02a: b07f                 | popq %rdi\n"
+    "0x02c: 6137                 | subq %rbx, %rdi\n"
+    "0x02e: 701400000000000000   | jmp loop\n"
+    "0x037: 00                   | done: halt\n"
+    "0x040: 2071                 | body: rrmovq %rdi, %rcx\n"
+    "0x042: 6231                 | andq %rbx, %rcx\n"
+    "0x044: 2472                 | cmovne %rdi, %rdx\n"
+    "0x046: 6070                 | addq %rdi, %rax\n"
+    "0x048: 40080008000000000000 | rmmovq %rax, 0x800(%r8)\n"
+    "0x052: 409a0000000000000000 | rmmovq %r9, 0(%r10)\n"
+    "0x05c: 501f0800000000000000 | mrmovq 8, %rcx\n"
+    "0x066: 90                   | ret\n";
+
+void test_lockstep_divergent() {
+    std::cout << "[TEST] Lockstep: divergence, ADR, self-modifying lanes..." << std::endl;
+
+    auto init = [](size_t lane, int r) -> word_t {
+        switch (r) {
+            case Reg::RDI: return lane % 13;                          // 循环次数各不相同
+            case Reg::R8: return lane % 11 == 5 ? 0x100000 : lane * 8; // 个别 lane 写越界
+            case Reg::R9: return lane % 7 == 3 ? 0x14703761 : 0x10101010 * (lane % 7 == 4);
+            case Reg::R10: return lane % 7 >= 3 && lane % 7 <= 4 ? 0x02c : 0xa00 + lane * 8;
+            default: return 0;
+        }
+    };
+    // lane % 7 == 3：写回相同的字节（代码没变，但该 lane 之后按标量执行）
+    // lane % 7 == 4：subq / jmp 改为 nop 与 halt
+    assert(compareLanes(DIVERGENT, 37, 10000, 10000, init) > 0);
+    assert(compareLanes(DIVERGENT, 37, 7, 700, init) > 0);
+    compareLanes(DIVERGENT, 1, 3, 300, init);
+
+    // 没有分叉时每组包含全部 lane
+    LockstepCPU ls(16);
+    std::string text = DIVERGENT;
+    assert(ls.load(text.data(), text.size()));
+    for (size_t i = 0; i < 16; i++) {
+        ls.setReg(i, Reg::RDI, 5);
+        ls.setReg(i, Reg::R10, 0xa00);
+    }
+    uint64_t n = ls.run(1000);
+    assert(n == 16 * ls.steps(0) && ls.groups() == ls.steps(0) && ls.scalarSteps() == 0);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 边界值上的 OPq 与各种条件：每一步之后比较条件码
+void test_lockstep_alu() {
+    std::cout << "[TEST] Lockstep: ALU and conditions..." << std::endl;
+
+    const char* text =
+        "0x000: 6076                 | addq %rdi, %rsi\n"
+        "0x002: 2501                 | cmovge %rax, %rcx\n"
+        "0x004: 6176                 | subq %rdi, %rsi\n"
+        "0x006: 2602                 | cmovg %rax, %rdx\n"
+        "0x008: 6276                 | andq %rdi, %rsi\n"
+        "0x00a: 2203                 | cmovl %rax, %rbx\n"
+        "0x00c: 6376                 | xorq %rdi, %rsi\n"
+        "0x00e: 2105                 | cmovle %rax, %rbp\n"
+        "0x010: 6176                 | subq %rdi, %rsi\n"
+        "0x012: 721c00000000000000   | jl less\n"
+        "0x01b: 00                   | halt\n"
+        "0x01c: 6076                 | less: addq %rdi, %rsi\n"
+        "0x01e: 00                   | halt\n";
+    static const word_t vals[] = {0, 1, -1, 2, -2, INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1};
+    const size_t n = sizeof(vals) / sizeof(vals[0]);
+    compareLanes(text, n * n, 1, 12, [&](size_t lane, int r) -> word_t {
+        if (r == Reg::RDI) return vals[lane / n];
+        if (r == Reg::RSI) return vals[lane % n];
+        return r == Reg::RAX ? -1 : 0;
+    });
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 非法指令、非法运算 / 条件交给标量 CPU
+void test_lockstep_fallback() {
+    std::cout << "[TEST] Lockstep: invalid instructions..." << std::endl;
+
+    const char* text =
+        "0x000: 6277                 | andq %rdi, %rdi\n"
+        "0x002: 731000000000000000   | je skip\n"
+        "0x00b: c0                   | .byte 0xc0\n"
+        "0x00c: 2f12                 | cmov with fn 0xf\n"
+        "0x00e: 6012                 | addq %rcx, %rdx\n"
+        "0x010: 30f00100000000000000 | skip: irmovq $1, %rax\n"
+        "0x01a: 00                   | halt\n";
+    assert(compareLanes(text, 8, 10000, 10000, [](size_t lane, int r) -> word_t {
+        return r == Reg::RDI ? lane % 2 : r * 3 + 1;
+    }) > 0);
+
+    // 取指越界
+    compareLanes("0x000: 70fe1f000000000000 | jmp 0x1ffe\n0x1ffe: 30f0 | irmovq cut off\n", 4, 10, 10,
+                 [](size_t, int) -> word_t { return 0; });
+
+    // 分组执行之后取指越界：SEQ 重放上一条指令（ret）的中间信号，rsp 再加 8
+    const char* badRet =
+        "0x000: 30f40001000000000000 | irmovq $0x100, %rsp\n"
+        "0x00a: 30f00020000000000000 | irmovq $0x2000, %rax\n"
+        "0x014: a00f                 | pushq %rax\n"
+        "0x016: 30f12300000000000000 | irmovq $0x23, %rcx\n"
+        "0x020: a01f                 | pushq %rcx\n"
+        "0x022: 90                   | ret\n"
+        "0x023: 702200000000000000   | jmp 0x22\n";
+    for (uint64_t chunk : {1, 3, 1000}) compareLanes(badRet, 4, chunk, 1000, [](size_t, int) -> word_t { return 0; });
+    LockstepCPU ls(4);
+    assert(ls.load(badRet, std::string(badRet).size()));
+    ls.run(1000);
+    for (size_t i = 0; i < 4; i++) assert(ls.getStat(i) == Stat::ADR && ls.getReg(i, Reg::RSP) == 264);
+
+    // 分组执行的 OPq / cmov 紧挨着内存末尾：下一次取指越界，交给标量 CPU 时
+    // 只凭记下的 PC 重新译码，SEQ 重放的运算、条件码与条件传送须与单独运行的 CPU 相同
+    for (const char* tail : {"6001 | addq %rax, %rcx", "6301 | xorq %rax, %rcx", "2201 | cmovl %rax, %rcx",
+                             "2601 | cmovg %rax, %rcx"}) {
+        std::string text = std::string("0x000: 6120               | subq %rdx, %rax\n"
+                                       "0x002: 70fe1f000000000000 | jmp 0x1ffe\n"
+                                       "0x1ffe: ") + tail + "\n";
+        compareLanes(text, 8, 1, 10, [](size_t lane, int r) -> word_t {
+            if (r == Reg::RAX) return static_cast<word_t>(lane) * 3 - 7;
+            if (r == Reg::RDX) return lane % 3;
+            return r == Reg::RCX ? 100 : 0;
+        });
+        compareLanes(text, 8, 1000, 1000, [](size_t lane, int r) -> word_t {
+            return r == Reg::RAX ? static_cast<word_t>(lane) - 4 : r == Reg::RCX ? 1 : 0;
+        });
+    }
+
+    // 部分取指：jmp 之后取到被截断的 irmovq
+    compareLanes("0x000: 30f00100000000000000 | irmovq $1, %rax\n0x00a: 70fe1f000000000000 | jmp 0x1ffe\n"
+                 "0x1ffe: 30f0 | irmovq cut off\n", 4, 1, 10, [](size_t, int) -> word_t { return 0; });
+
+    std::cout << "  PASS" << std::endl;
+}
+
+int main() {
+    test_lockstep_programs();
+    test_lockstep_divergent();
+    test_lockstep_alu();
+    test_lockstep_fallback();
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "All lockstep tests passed!" << std::endl;
+    return 0;
+}
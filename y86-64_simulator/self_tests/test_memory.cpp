@@ -127,6 +127,181 @@ void test_random_stress() {
     std::cout << "  PASS: stress test passed\n";
 }
 
+void test_write_log() {
+    std::cout << "[TEST] writeLog\n";
+    Memory mem;
+    std::vector<addr_t> log;
+
+    mem.writeWord(0, 1);  // 未开启时不记录
+    mem.writeLog = &log;
+
+    mem.writeByte(13, 0xAA);          // 落在 8 号字内
+    mem.writeWord(16, 2);             // 对齐写
+    mem.writeWord(36, 3);             // 跨越 32 / 40 两个字
+    mem.writeWord(Memory::MAX_SIZE, 4);  // 越界写不记录
+    assert((log == std::vector<addr_t>{8, 16, 32, 40}));
+
+    mem.writeLog = nullptr;
+    mem.writeByte(0, 1);
+    assert(log.size() == 4);
+
+    std::cout << "  PASS: aligned words of every write are logged\n";
+}
+
+void test_live_words() {
+    std::cout << "[TEST] forEachLiveWord\n";
+    Memory mem;
+    std::vector<std::pair<addr_t, word_t>> live;
+    auto collect = [&]() {
+        live.clear();
+        mem.forEachLiveWord([&](addr_t a, word_t v) { live.push_back({a, v}); });
+    };
+
+    collect();
+    assert(live.empty());
+
+    mem.writeWord(Memory::MAX_SIZE - 8, -1);
+    mem.writeByte(9, 0x01);
+    mem.writeWord(20, 0x0102030405060708LL);  // 跨越 16 / 24 两个字
+    collect();
+    assert(live.size() == 4);
+    assert(live[0].first == 8 && live[0].second == 0x0100);
+    assert(live[1].first == 16 && live[2].first == 24);
+    assert(live[3].first == Memory::MAX_SIZE - 8 && live[3].second == -1);
+
+    // 写回 0 后不再出现
+    mem.writeByte(9, 0);
+    mem.writeWord(20, 0);
+    collect();
+    assert(live.size() == 1 && live[0].first == Memory::MAX_SIZE - 8);
+
+    // 直接改写 data 后需要 rescanLive
+    mem.data[100] = 7;
+    mem.rescanLive();
+    collect();
+    assert(live.size() == 2 && live[0].first == 96);
+
+    mem.reset();
+    collect();
+    assert(live.empty());
+
+    std::cout << "  PASS: only non-zero words are visited\n";
+}
+
+void test_write_block() {
+    std::cout << "[TEST] writeBlock\n";
+    Memory mem;
+    bool err = false;
+
+    byte_t buf[20];
+    for (int i = 0; i < 20; i++) buf[i] = static_cast<byte_t>(i + 1);
+    assert(!mem.writeBlock(6, buf, 20));
+    for (int i = 0; i < 20; i++) assert(mem.readByte(6 + i, err) == i + 1);
+
+    int live = 0;
+    mem.forEachLiveWord([&](addr_t, word_t) { live++; });
+    assert(live == 4);  // 字 0 / 8 / 16 / 24
+
+    // 越界时不写入任何字节
+    assert(mem.writeBlock(Memory::MAX_SIZE - 10, buf, 20));
+    assert(mem.readByte(Memory::MAX_SIZE - 10, err) == 0);
+    assert(mem.writeBlock(~addr_t(0) - 4, buf, 20));
+    assert(!mem.writeBlock(Memory::MAX_SIZE - 20, buf, 20));
+    assert(!mem.writeBlock(Memory::MAX_SIZE, buf, 0));
+
+    std::cout << "  PASS: block writes are bounds-checked and tracked\n";
+}
+
+void test_paged_memory() {
+    std::cout << "[TEST] Paged high memory\n";
+    const addr_t SIZE = addr_t(1) << 40;  // 1 TiB 地址空间
+    Memory mem(SIZE);
+    bool err = false;
+
+    assert(mem.size() == SIZE && mem.denseSize() == Memory::DENSE_LIMIT);
+    assert(mem.pageCount() == 0);
+
+    // 未触及的页读出 0，写 0 不分配页
+    assert(mem.readWord(SIZE - 8, err) == 0 && !err);
+    assert(!mem.writeWord(0x1234567000, 0));
+    assert(mem.pageCount() == 0);
+
+    // 末尾 8 字节可以访问，再往后越界
+    assert(!mem.writeWord(SIZE - 8, 0x1122334455667788));
+    assert(mem.readWord(SIZE - 8, err) == 0x1122334455667788 && !err);
+    assert(mem.writeWord(SIZE - 7, 1));
+    mem.readByte(SIZE, err);
+    assert(err);
+
+    // 跨页、跨越连续区与页的边界
+    assert(!mem.writeWord(0x3000000FFC, -2));
+    assert(mem.readWord(0x3000000FFC, err) == -2);
+    assert(!mem.writeWord(Memory::DENSE_LIMIT - 4, 0x0102030405060708));
+    assert(mem.readWord(Memory::DENSE_LIMIT - 4, err) == 0x0102030405060708);
+    assert(mem.readByte(Memory::DENSE_LIMIT, err) == 0x04);
+
+    // 占用只随触及的页增长：末尾 1 页 + 跨页 2 页 + 边界后 1 页
+    assert(mem.pageCount() == 4);
+
+    std::vector<std::pair<addr_t, word_t>> live;
+    mem.forEachLiveWord([&](addr_t a, word_t v) { live.push_back({a, v}); });
+    assert(live.size() == 5);
+    assert(live[0].first == Memory::DENSE_LIMIT - 8 && live[1].first == Memory::DENSE_LIMIT);
+    assert(live[2].first == 0x3000000FF8 && live[3].first == 0x3000001000);
+    assert(live[4].first == SIZE - 8 && live[4].second == 0x1122334455667788);
+
+    // 写回 0 后不再出现在非零字中
+    assert(!mem.writeWord(SIZE - 8, 0));
+    live.clear();
+    mem.forEachLiveWord([&](addr_t a, word_t v) { live.push_back({a, v}); });
+    assert(live.size() == 4);
+
+    // 整块写入跨越多页
+    std::vector<byte_t> buf(3 * Memory::PAGE_SIZE, 0xAB);
+    assert(!mem.writeBlock(0x500000800, buf.data(), buf.size()));
+    assert(mem.readByte(0x500000800 + buf.size() - 1, err) == 0xAB);
+    assert(mem.readByte(0x500000800 + buf.size(), err) == 0);
+
+    mem.reset();
+    assert(mem.pageCount() == 0 && mem.readWord(0x3000000FFC, err) == 0);
+
+    std::cout << "  PASS: sparse pages allocated on first touch\n";
+}
+
+void test_block_read_compare() {
+    std::cout << "[TEST] readBlock / equalBlock\n";
+    Memory mem(addr_t(1) << 32);
+    bool err = false;
+
+    // 跨越连续区与页的边界，后半段落在未分配的页上
+    byte_t buf[40], out[40];
+    for (int i = 0; i < 40; i++) buf[i] = static_cast<byte_t>(0x80 + i);
+    addr_t base = Memory::DENSE_LIMIT - 20;
+    assert(!mem.writeBlock(base, buf, 20));
+    assert(!mem.readBlock(base, out, 40));
+    for (int i = 0; i < 20; i++) assert(out[i] == buf[i]);
+    for (int i = 20; i < 40; i++) assert(out[i] == 0);
+    assert(mem.pageCount() == 0);
+
+    assert(mem.equalBlock(base, buf, 20));
+    assert(!mem.equalBlock(base, buf, 21));
+    assert(mem.equalBlock(base + 20, out + 20, 20));  // 未分配的页与 0 相等
+    assert(!mem.writeBlock(base + 20, buf + 20, 20));
+    assert(mem.equalBlock(base, buf, 40) && mem.pageCount() == 1);
+
+    // 未对齐的 word 与字节视图一致（小端序）
+    assert(!mem.writeWord(base + 3, 0x0807060504030201));
+    for (int i = 0; i < 8; i++) assert(mem.readByte(base + 3 + i, err) == i + 1);
+    assert(mem.readWord(base + 3, err) == 0x0807060504030201);
+
+    // 越界
+    assert(mem.readBlock(mem.size() - 4, out, 8));
+    assert(!mem.equalBlock(mem.size() - 4, out, 8));
+    assert(!mem.readBlock(mem.size(), out, 0));
+
+    std::cout << "  PASS: block reads and compares match the byte view\n";
+}
+
 int main() {
     std::cout << '\n';
     test_reset();
@@ -136,5 +311,10 @@ int main() {
     test_word_out_of_bounds();
     test_overwrite();
     test_random_stress();
+    test_write_log();
+    test_live_words();
+    test_write_block();
+    test_paged_memory();
+    test_block_read_compare();
     std::cout << "\n=== Memory Tests All Passed ===\n";
 }
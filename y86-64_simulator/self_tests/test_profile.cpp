@@ -0,0 +1,122 @@
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/profile.h"
+
+// 外层 3 次 × 内层 4 次的双重循环
+static const std::string PROGRAM =
+    "                            | # nested loops\n"
+    "0x000:                      | .pos 0\n"
+    "0x000: 30f00300000000000000 | main: irmovq $3, %rax\n"
+    "0x00a: 30f30100000000000000 |       irmovq $1, %rbx\n"
+    "0x014: 30f10400000000000000 | outer: irmovq $4, %rcx\n"
+    "0x01e: 6131                 | inner: subq %rbx, %rcx\n"
+    "0x020: 741e00000000000000   |       jne inner\n"
+    "0x029: 6130                 |       subq %rbx, %rax\n"
+    "0x02b: 741400000000000000   |       jne outer\n"
+    "0x034: 00                   |       halt\n";
+
+void test_scan_listing() {
+    std::vector<SourceLine> listing = Loader::scanListing(PROGRAM.data(), PROGRAM.size());
+    assert(listing.size() == 8);  // 注释行与 .pos 行没有字节
+    assert(listing[0].addr == 0 && listing[0].line == 3 && listing[0].bytes == 10);
+    assert(listing[0].source == "main: irmovq $3, %rax");
+    assert(listing[3].addr == 0x1e && listing[3].line == 6 && listing[3].bytes == 2);
+    assert(listing[4].bytes == 9 && listing[4].source == "jne inner");
+    assert(listing[7].addr == 0x34 && listing[7].line == 10 && listing[7].bytes == 1);
+    Memory mem;
+    assert(Loader::load(PROGRAM.data(), PROGRAM.size(), mem));
+    assert(Profile::codeEnd(listing, mem) == 0x35);
+
+    // 代码之后的数据与栈不扩大计数范围
+    std::string withData = PROGRAM +
+        "0x800:                      | .pos 0x800\n"
+        "0x800: 0100000000000000     | data: .quad 1\n"
+        "0x808: 0200000000000000     |       .quad 2\n"
+        "0x1000:                     | .pos 0x1000\n"
+        "0x1000:                     | stack:\n";
+    std::vector<SourceLine> dataListing = Loader::scanListing(withData.data(), withData.size());
+    assert(dataListing.size() == 10);
+    Memory dataMem;
+    assert(Loader::load(withData.data(), withData.size(), dataMem));
+    assert(Profile::codeEnd(dataListing, dataMem) == 0x35);
+    std::cout << "test_scan_listing passed" << std::endl;
+}
+
+void test_counts() {
+    for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+        Memory mem;
+        ProfileCPU cpu(mem);
+        assert(Loader::load(PROGRAM.data(), PROGRAM.size(), mem));
+        cpu.engine = engine;  // JIT 按 THREADED 执行，同样计数
+        cpu.hooks.counts.assign(0x35, 0);
+        uint64_t steps = cpu.run(UINT64_MAX);
+        assert(cpu.stat == Stat::HLT);
+
+        const std::vector<uint64_t>& c = cpu.hooks.counts;
+        assert(c[0x00] == 1 && c[0x0a] == 1 && c[0x14] == 3);
+        assert(c[0x1e] == 12 && c[0x20] == 12);
+        assert(c[0x29] == 3 && c[0x2b] == 3 && c[0x34] == 1);
+        uint64_t sum = 0;
+        for (uint64_t v : c) sum += v;
+        assert(sum == steps && cpu.hooks.outside == 0);
+    }
+
+    // 计数数组之外的 PC 记入 outside
+    Memory mem;
+    ProfileCPU cpu(mem);
+    assert(Loader::load(PROGRAM.data(), PROGRAM.size(), mem));
+    cpu.hooks.counts.assign(0x1e, 0);
+    uint64_t steps = cpu.run(UINT64_MAX);
+    assert(cpu.hooks.outside == 12 + 12 + 3 + 3 + 1 && steps == 1 + 1 + 3 + cpu.hooks.outside);
+    std::cout << "test_counts passed" << std::endl;
+}
+
+void test_report() {
+    Memory mem;
+    ProfileCPU cpu(mem);
+    Image image;
+    assert(Loader::load(PROGRAM.data(), PROGRAM.size(), mem, &image));
+    std::vector<SourceLine> listing = Loader::scanListing(PROGRAM.data(), PROGRAM.size());
+    cpu.hooks.counts.assign(Profile::codeEnd(listing, mem), 0);
+    cpu.engine = Engine::THREADED;
+    cpu.run(UINT64_MAX);
+
+    Profile profile(cpu.hooks, listing, image.symbols);
+    std::ostringstream out;
+    profile.report(out, 2);
+    std::string r = out.str();
+    assert(r.find("# 36 instructions\n") == 0);
+    // 按标号：inner 到 halt 之前都归 inner（12 + 12 + 3 + 3 + 1）
+    assert(r.find("          31   86.11%  inner\n") != std::string::npos);
+    assert(r.find("           3    8.33%  outer\n") != std::string::npos);
+    assert(r.find("           2    5.56%  main\n") != std::string::npos);
+    // 热点只取前 2 条，计数相同按地址
+    size_t hot = r.find("# hot spots");
+    assert(r.find("0x0001e     6  inner                 inner: subq %rbx, %rcx", hot) != std::string::npos);
+    assert(r.find("0x00020     7  inner+0x2             jne inner", hot) != std::string::npos);
+    assert(r.find("0x00029", hot) == std::string::npos);
+
+    std::ostringstream ann;
+    profile.annotate(ann, PROGRAM.data(), PROGRAM.size());
+    std::string a = ann.str();
+    size_t lines = 0;
+    for (char ch : a) lines += ch == '\n';
+    assert(lines == 10);
+    assert(a.find("          12  33.33% | 0x01e: 6131") != std::string::npos);
+    assert(a.find("                     | 0x000:                      | .pos 0\n") != std::string::npos);
+    std::cout << "test_report passed" << std::endl;
+}
+
+int main() {
+    test_scan_listing();
+    test_counts();
+    test_report();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
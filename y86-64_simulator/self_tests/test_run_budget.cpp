@@ -0,0 +1,120 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/yo_builder.h"
+#include "../include/run_budget.h"
+
+// %rax 从 n 递减到 0 后 halt，共 3n + 3 条指令（含 halt）
+static std::string countdown(word_t n) {
+    YoBuilder b;
+    b.irmovq(n, Reg::RAX);
+    b.irmovq(1, Reg::RCX);
+    b.label("loop");
+    b.opq(ALU::ADD, Reg::RAX, Reg::RDX);
+    b.opq(ALU::SUB, Reg::RCX, Reg::RAX);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+    return b.text();
+}
+
+static std::string state(const CPU& cpu) {
+    std::string out;
+    appendStateJSON(out, cpu, 1);
+    return out;
+}
+
+// 运行到停止：与不限步数的 run 结果相同
+void test_halt() {
+    std::string text = countdown(1000);
+    for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+        Memory mem;
+        CPU cpu(mem);
+        assert(Loader::load(text.data(), text.size(), mem));
+        cpu.engine = engine;
+        RunSummary s = runToCompletion(cpu, RunBudget());
+        assert(s.reason == StopReason::STAT && s.steps == 3 + 3 * 1000);
+        assert(cpu.stat == Stat::HLT && cpu.reg.getReg(Reg::RAX) == 0);
+    }
+    std::cout << "test_halt passed" << std::endl;
+}
+
+// 指令预算：恰好停在预算处，之后继续运行与一次运行到底的终态相同
+void test_steps() {
+    std::string text = countdown(1000);
+    for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+        Memory refMem, mem;
+        CPU ref(refMem), cpu(mem);
+        assert(Loader::load(text.data(), text.size(), refMem));
+        assert(Loader::load(text.data(), text.size(), mem));
+        ref.engine = cpu.engine = engine;
+        ref.run(UINT64_MAX);
+
+        RunBudget budget;
+        budget.maxSteps = 1234;
+        RunSummary s = runToCompletion(cpu, budget);
+        assert(s.reason == StopReason::STEPS && s.steps == 1234 && cpu.stat == Stat::AOK);
+
+        std::string json;
+        appendRunSummaryJSON(json, cpu, s);
+        assert(json.find("\"STEPS\": 1234,") != std::string::npos);
+        assert(json.find("\"STOP\": \"steps\"") != std::string::npos);
+        assert(json.find(state(cpu)) != std::string::npos);
+
+        s = runToCompletion(cpu, RunBudget());
+        assert(s.reason == StopReason::STAT && s.steps == 3 + 3 * 1000 - 1234);
+        assert(state(cpu) == state(ref));
+    }
+    std::cout << "test_steps passed" << std::endl;
+}
+
+// 墙钟期限：死循环在期限后停下；期限内完成的程序与不设期限时相同（分块不影响结果）
+void test_deadline() {
+    YoBuilder b;
+    b.label("spin");
+    b.opq(ALU::ADD, Reg::RCX, Reg::RAX);
+    b.jmp("spin");
+    std::string spin = b.text();
+    for (Engine engine : {Engine::THREADED, Engine::JIT}) {
+        Memory mem;
+        CPU cpu(mem);
+        assert(Loader::load(spin.data(), spin.size(), mem));
+        cpu.engine = engine;
+        RunBudget budget;
+        budget.seconds = 0.05;
+        budget.chunk = 1000;
+        RunSummary s = runToCompletion(cpu, budget);
+        assert(s.reason == StopReason::DEADLINE && s.seconds >= 0.05 && s.steps > 0 && s.steps % 1000 == 0);
+        assert(cpu.stat == Stat::AOK);
+    }
+
+    std::string text = countdown(100000);
+    for (Engine engine : {Engine::SEQ, Engine::THREADED, Engine::JIT}) {
+        Memory refMem, mem;
+        CPU ref(refMem), cpu(mem);
+        assert(Loader::load(text.data(), text.size(), refMem));
+        assert(Loader::load(text.data(), text.size(), mem));
+        ref.engine = cpu.engine = engine;
+        ref.run(UINT64_MAX);
+
+        RunBudget budget;
+        budget.seconds = 60;
+        budget.chunk = 777;
+        RunSummary s = runToCompletion(cpu, budget);
+        assert(s.reason == StopReason::STAT && s.steps == 3 + 3 * 100000);
+        assert(state(cpu) == state(ref));
+    }
+    std::cout << "test_deadline passed" << std::endl;
+}
+
+int main() {
+    test_halt();
+    test_steps();
+    test_deadline();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+// tests/test_scheduler.cpp
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../include/scheduler.h"
+
+void test_deque_order() {
+    std::cout << "[TEST] deque order\n";
+    WorkStealingDeque<int*> q(3);  // 容量取整为 4
+    int v[4];
+    int* x;
+
+    assert(q.empty() && !q.pop(x) && !q.steal(x));
+    for (int i = 0; i < 4; i++) q.push(&v[i]);
+
+    // 所有者后进先出，窃取者先进先出
+    assert(q.pop(x) && x == &v[3]);
+    assert(q.steal(x) && x == &v[0]);
+    assert(q.steal(x) && x == &v[1]);
+    assert(q.pop(x) && x == &v[2]);
+    assert(q.empty() && !q.pop(x) && !q.steal(x));
+
+    // 下标回绕
+    for (int round = 0; round < 10; round++) {
+        q.push(&v[round % 4]);
+        q.push(&v[(round + 1) % 4]);
+        assert(q.steal(x) && x == &v[round % 4]);
+        assert(q.pop(x) && x == &v[(round + 1) % 4]);
+    }
+
+    std::cout << "  PASS: owner pops LIFO, thieves steal FIFO\n";
+}
+
+void test_deque_concurrent() {
+    std::cout << "[TEST] deque concurrent steal\n";
+    const int N = 200000;
+    std::vector<int> items(N);
+    std::vector<std::atomic<int>> taken(N);
+    for (auto& t : taken) t = 0;
+
+    WorkStealingDeque<int*> q(1024);
+    std::atomic<bool> done{false};
+    auto thief = [&]() {
+        int* x;
+        while (!done.load() || !q.empty())
+            if (q.steal(x)) taken[x - items.data()]++;
+    };
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; t++) thieves.emplace_back(thief);
+
+    // 所有者成批压入，再弹出到队列为空，与窃取者争抢最后一个元素
+    int* x;
+    for (int i = 0; i < N; ) {
+        int burst = std::min(N - i, 1 + i % 700);
+        for (int k = 0; k < burst; k++) q.push(&items[i++]);
+        while (q.pop(x)) taken[x - items.data()]++;
+    }
+    while (q.pop(x)) taken[x - items.data()]++;
+    done = true;
+    for (auto& t : thieves) t.join();
+
+    for (int i = 0; i < N; i++) assert(taken[i] == 1);
+    std::cout << "  PASS: every item is taken exactly once\n";
+}
+
+// 共 length 步的任务，检查分片大小与互斥
+class CountTask : public SliceTask {
+    public:
+        explicit CountTask(uint64_t length) : length(length) {}
+
+        bool resume(uint64_t budget) override {
+            assert(!running.exchange(true));  // 同一任务不会被并发执行
+            uint64_t n = std::min(budget, length - done);
+            done += n;
+            slices++;
+            if (done < length) assert(n == budget);
+            running = false;
+            return done == length;
+        }
+
+        uint64_t length;
+        uint64_t done = 0;
+        uint64_t slices = 0;
+        std::atomic<bool> running{false};
+};
+
+void test_scheduler() {
+    std::cout << "[TEST] work-stealing scheduler\n";
+
+    for (unsigned threads : {1u, 2u, 4u}) {
+        for (uint64_t slice : {uint64_t(0), uint64_t(1), uint64_t(37), uint64_t(1000)}) {
+            // 长短混合：少量长任务，大量短任务
+            std::vector<std::unique_ptr<CountTask>> tasks;
+            std::vector<SliceTask*> ptrs;
+            for (int i = 0; i < 100; i++) {
+                tasks.emplace_back(new CountTask(i % 25 == 0 ? 5000 : 1 + i % 7));
+                ptrs.push_back(tasks.back().get());
+            }
+
+            WorkStealingScheduler scheduler(threads, slice);
+            scheduler.run(ptrs);
+
+            uint64_t slices = 0;
+            for (const auto& t : tasks) {
+                assert(t->done == t->length);
+                assert(t->slices == (slice ? (t->length + slice - 1) / slice : 1));
+                slices += t->slices;
+            }
+            assert(scheduler.slices() == slices);
+            if (threads == 1) assert(scheduler.steals() == 0);
+        }
+    }
+
+    // 单线程时被抢占的任务放回队尾：排队的任务按先进先出轮转，每个都能轮到一片
+    {
+        std::vector<int> order;
+        struct OrderTask : SliceTask {
+            int id, left;
+            std::vector<int>* order;
+            OrderTask(int id, int left, std::vector<int>* order) : id(id), left(left), order(order) {}
+            bool resume(uint64_t) override {
+                order->push_back(id);
+                return --left == 0;
+            }
+        };
+        OrderTask a(0, 3, &order), b(1, 3, &order), c(2, 2, &order);
+        WorkStealingScheduler scheduler(1, 1);
+        scheduler.run({&a, &b, &c});
+        assert((order == std::vector<int>{0, 1, 2, 0, 1, 2, 0, 1}));
+    }
+
+    // 没有任务
+    WorkStealingScheduler empty(4);
+    empty.run({});
+    assert(empty.slices() == 0);
+
+    std::cout << "  PASS: all tasks complete in the expected number of slices\n";
+}
+
+int main() {
+    std::cout << '\n';
+    test_deque_order();
+    test_deque_concurrent();
+    test_scheduler();
+    std::cout << "\n=== Scheduler Tests All Passed ===\n";
+}
@@ -0,0 +1,108 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/yo_builder.h"
+#include "../include/workload.h"
+#include "../include/run_budget.h"
+#include "../include/stats.h"
+
+// 递归 3 层后返回；途中一次条件跳转成立、一次不成立，两次条件传送各成立一次
+static std::string program() {
+    YoBuilder b;
+    b.irmovq(0x400, Reg::RSP);
+    b.irmovq(3, Reg::RDI);
+    b.irmovq(1, Reg::RSI);
+    b.call("down");
+    b.halt();
+
+    b.label("down");
+    b.pushq(Reg::RDI);
+    b.opq(ALU::SUB, Reg::RSI, Reg::RDI);
+    b.jxx(Cond::E, "bottom");
+    b.call("down");
+    b.label("bottom");
+    b.popq(Reg::RDI);
+    b.ret();
+    return b.text();
+}
+
+void test_counts() {
+    std::string text = program();
+    for (Engine engine : {Engine::SEQ, Engine::THREADED}) {
+        Memory mem;
+        StatsCPU cpu(mem);
+        assert(Loader::load(text.data(), text.size(), mem));
+        cpu.engine = engine;
+        cpu.run(UINT64_MAX);
+        assert(cpu.stat == Stat::HLT);
+
+        const ExecStats& s = cpu.hooks;
+        // 外层 5 条 + 3 层各 pushq / subq / je / popq / ret，前两层另有 call
+        assert(s.steps == 5 + 3 * 5 + 2);
+        assert(s.icodes[ICode::CALL] == 3 && s.icodes[ICode::RET] == 3);
+        assert(s.icodes[ICode::PUSHQ] == 3 && s.icodes[ICode::POPQ] == 3);
+        assert(s.icodes[ICode::JXX] == 3 && s.icodes[ICode::HALT] == 1);
+        assert(s.jxxTaken == 1 && s.jxxNotTaken == 2);
+        assert(s.reads == 6 && s.writes == 6);  // 3 次 ret + 3 次 popq；3 次 call + 3 次 pushq
+        assert(s.maxDepth == 3 && s.depth == 0);
+    }
+    std::cout << "test_counts passed" << std::endl;
+}
+
+// 条件传送：CMOV 形状中每轮的 cmovl / cmovg / cmovl
+void test_cmov() {
+    std::string text = Workload::generate(Workload::CMOV, 20000);
+    Memory mem;
+    StatsCPU cpu(mem);
+    assert(Loader::load(text.data(), text.size(), mem));
+    cpu.engine = Engine::THREADED;
+    uint64_t steps = cpu.run(UINT64_MAX);
+
+    const ExecStats& s = cpu.hooks;
+    uint64_t rounds = s.jxxTaken + s.jxxNotTaken;
+    assert(s.steps == steps && s.jxxNotTaken == 1);
+    assert(s.cmovTaken + s.cmovNotTaken == 3 * rounds);
+    assert(s.cmovTaken > 0 && s.cmovNotTaken > 0);
+    assert(s.icodes[ICode::RRMOVQ] == 6 * rounds);  // 3 次 cmov + 3 次 rrmovq
+    assert(s.reads == 0 && s.writes == 0 && s.maxDepth == 0);
+    std::cout << "test_cmov passed" << std::endl;
+}
+
+// 统计实例的终态与默认实例相同，汇总中带有 "STATS"
+void test_summary() {
+    std::string text = Workload::generate(Workload::RECURSE, 50000);
+    Memory refMem, mem;
+    CPU ref(refMem);
+    StatsCPU cpu(mem);
+    assert(Loader::load(text.data(), text.size(), refMem));
+    assert(Loader::load(text.data(), text.size(), mem));
+    ref.engine = Engine::JIT;
+    cpu.engine = Engine::THREADED;
+
+    RunSummary refSummary = runToCompletion(ref, RunBudget());
+    RunSummary summary = runToCompletion(cpu, RunBudget());
+    assert(summary.steps == refSummary.steps && cpu.hooks.steps == summary.steps);
+
+    std::string refState, out;
+    appendStateJSON(refState, ref, 1);
+    appendRunSummaryJSON(out, cpu, summary);
+    assert(out.find(refState) != std::string::npos);
+    assert(out.find("\"STATS\": {") < out.find("\"FINAL\":"));
+    assert(out.find("\"MAX_CALL_DEPTH\": 257") != std::string::npos);
+    assert(out.find("\"INSTRUCTIONS\": " + std::to_string(summary.steps) + ",") != std::string::npos);
+    std::cout << "test_summary passed" << std::endl;
+}
+
+int main() {
+    test_counts();
+    test_cmov();
+    test_summary();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
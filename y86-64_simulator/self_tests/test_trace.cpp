@@ -0,0 +1,263 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+
+// 循环写入一段数组，再逐个清零（覆盖内存字变为 0 的增量）
+static const char* PROG =
+    "0x000: 30f40004000000000000 | irmovq $0x400, %rsp\n"
+    "0x00a: 30f00002000000000000 | irmovq $0x200, %rax\n"
+    "0x014: 30f30800000000000000 | irmovq $8, %rbx\n"
+    "0x01e: 30f12800000000000000 | irmovq $40, %rcx\n"
+    "0x028: 30f20100000000000000 | irmovq $1, %rdx\n"
+    "0x032: 40100000000000000000 | fill: rmmovq %rcx, 0(%rax)\n"
+    "0x03c: 6030                 | addq %rbx, %rax\n"
+    "0x03e: 6121                 | subq %rdx, %rcx\n"
+    "0x040: 743200000000000000   | jne fill\n"
+    "0x049: 30f12800000000000000 | irmovq $40, %rcx\n"
+    "0x053: 6130                 | clear: subq %rbx, %rax\n"
+    "0x055: 40600000000000000000 | rmmovq %rsi, 0(%rax)\n"
+    "0x05f: a00f                 | pushq %rax\n"
+    "0x061: b07f                 | popq %rdi\n"
+    "0x063: 6121                 | subq %rdx, %rcx\n"
+    "0x065: 745300000000000000   | jne clear\n"
+    "0x06e: 00                   | halt\n";
+
+static TraceState snapshot(const CPU& cpu, uint64_t step) {
+    TraceState s;
+    s.step = step;
+    s.PC = cpu.PC;
+    s.stat = (int)cpu.stat;
+    for (int i = 0; i < 15; i++) s.regs[i] = cpu.reg.getReg(static_cast<Reg::ID>(i));
+    s.zf = cpu.cc.zf();
+    s.sf = cpu.cc.sf();
+    s.of = cpu.cc.of();
+    cpu.mem.forEachLiveWord([&](addr_t a, word_t v) { s.mem[a] = v; });
+    return s;
+}
+
+static bool same(const TraceState& a, const TraceState& b) {
+    return a.step == b.step && a.PC == b.PC && a.stat == b.stat && a.regs == b.regs &&
+           a.zf == b.zf && a.sf == b.sf && a.of == b.of && a.mem == b.mem;
+}
+
+// 运行 PROG 并写出二进制 trace，返回每步之后的状态（下标 0 对应第 1 步）
+static std::vector<TraceState> record(const char* path, int interval) {
+    Memory mem;
+    CPU cpu(mem);
+    std::string yo = PROG;
+    assert(Loader::load(yo, mem));
+
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    std::vector<TraceState> states;
+    {
+        BinaryTraceWriter writer(cpu, f, interval);
+        int steps = 0;
+        while (cpu.stat == Stat::AOK) {
+            cpu.step();
+            steps++;
+            writer.record(steps);
+            states.push_back(snapshot(cpu, steps));
+        }
+    }
+    fclose(f);
+    return states;
+}
+
+void test_sequential() {
+    std::cout << "[TEST] binary trace sequential read..." << std::endl;
+
+    const char* path = "/tmp/y86_test_trace.bin";
+    for (int interval : {0, 1, 16, 1024}) {
+        std::vector<TraceState> states = record(path, interval);
+
+        BinaryTraceReader reader;
+        assert(reader.open(path));
+        assert(reader.steps() == states.size());
+
+        TraceState s;
+        assert(reader.seek(1, s));
+        assert(same(s, states[0]));
+        for (size_t i = 1; i < states.size(); i++) {
+            assert(reader.next(s));
+            assert(same(s, states[i]));
+        }
+        assert(!reader.next(s));
+    }
+    std::remove(path);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+void test_seek() {
+    std::cout << "[TEST] binary trace random seek..." << std::endl;
+
+    const char* path = "/tmp/y86_test_trace.bin";
+    std::vector<TraceState> states = record(path, 16);
+
+    BinaryTraceReader reader;
+    assert(reader.open(path));
+
+    TraceState s;
+    const uint64_t steps[] = {states.size(), 1, 17, 16, 100, 33, 2};
+    for (uint64_t step : steps) {
+        assert(reader.seek(step, s));
+        assert(same(s, states[step - 1]));
+    }
+    assert(!reader.seek(0, s));
+    assert(!reader.seek(states.size() + 1, s));
+    std::remove(path);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+void test_bad_file() {
+    std::cout << "[TEST] binary trace rejects bad files..." << std::endl;
+
+    const char* path = "/tmp/y86_test_trace_bad.bin";
+    FILE* f = fopen(path, "wb");
+    fputs("[\n  {\"PC\": 0}\n]\n this is not a binary trace at all", f);
+    fclose(f);
+
+    BinaryTraceReader reader;
+    assert(!reader.open(path));
+    assert(!reader.open("/nonexistent/trace.bin"));
+    std::remove(path);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 非法运算的诊断信息不混入二进制 trace（trace 与诊断信息原本都写到标准输出）
+void test_binary_diagnostics() {
+    std::cout << "[TEST] binary trace keeps diagnostics out of the file..." << std::endl;
+
+    const char* path = "/tmp/y86_test_trace_diag.bin";
+    std::string yo =
+        "0x000: 30f00500000000000000 | irmovq $5, %rax\n"
+        "0x00a: 6f01                 | OPq fn 0xf\n"
+        "0x00c: 00                   | halt\n";
+    Memory mem;
+    CPU cpu(mem);
+    assert(Loader::load(yo, mem));
+
+    std::ostringstream out, err;
+    std::streambuf* oldOut = std::cout.rdbuf(out.rdbuf());
+    std::streambuf* oldErr = std::cerr.rdbuf(err.rdbuf());
+    FILE* f = fopen(path, "wb");
+    {
+        BinaryTraceWriter writer(cpu, f, 16);
+        for (int steps = 1; cpu.stat == Stat::AOK; steps++) {
+            cpu.step();
+            writer.record(steps);
+        }
+    }
+    fclose(f);
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+
+    assert(out.str().empty());
+    assert(err.str() == "ALU报错setCC报错");
+    assert(cpu.diag == &std::cout);
+    BinaryTraceReader reader;
+    assert(reader.open(path) && reader.steps() == 3);
+    std::remove(path);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+// 3000 轮循环反复改写同一内存字（约 12000 步，快照数超过写线程队列的容量）
+static const char* LONG_PROG =
+    "0x000: 30f00002000000000000 | irmovq $0x200, %rax\n"
+    "0x00a: 30f30800000000000000 | irmovq $8, %rbx\n"
+    "0x014: 30f1b80b000000000000 | irmovq $3000, %rcx\n"
+    "0x01e: 30f20100000000000000 | irmovq $1, %rdx\n"
+    "0x028: 40100000000000000000 | fill: rmmovq %rcx, 0(%rax)\n"
+    "0x032: 6036                 | addq %rbx, %rsi\n"
+    "0x034: 6121                 | subq %rdx, %rcx\n"
+    "0x036: 742800000000000000   | jne fill\n"
+    "0x03f: 00                   | halt\n";
+
+// 非法运算（OPq fn 0xf）与非法条件（cmov fn 0xf）：CPU 在执行时输出诊断信息
+static const char* BAD_OP_PROG =
+    "0x000: 30f00500000000000000 | irmovq $5, %rax\n"
+    "0x00a: 6f01                 | OPq fn 0xf\n"
+    "0x00c: 6001                 | addq %rax, %rcx\n"
+    "0x00e: 2f12                 | cmov fn 0xf\n"
+    "0x010: 6f01                 | OPq fn 0xf\n"
+    "0x012: 00                   | halt\n";
+
+// 以同步 printStateJSON 或 AsyncTraceWriter 输出整个 trace
+// 第 5 步之后由宿主一次写入多于 MAX_WRITES 个内存字，覆盖续接记录
+static std::string trace_text(const char* prog, bool async) {
+    std::string yo = prog;
+    Memory mem;
+    CPU cpu(mem);
+    assert(Loader::load(yo, mem));
+
+    auto run = [&](auto record) {
+        for (int steps = 1; cpu.stat == Stat::AOK; steps++) {
+            cpu.step();
+            if (steps == 5)
+                for (addr_t a = 0x1000; a < 0x1080; a += 8) mem.writeWord(a, a);
+            record(steps);
+        }
+    };
+
+    if (!async) {
+        std::ostringstream out;
+        std::streambuf* old = std::cout.rdbuf(out.rdbuf());
+        run([&](int steps) { printStateJSON(cpu, steps); });
+        std::cout.rdbuf(old);
+        return out.str();
+    }
+
+    const char* path = "/tmp/y86_test_async.json";
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    {
+        AsyncTraceWriter writer(cpu, f);
+        run([&](int steps) { writer.record(steps); });
+    }
+    fclose(f);
+
+    std::ifstream in(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::remove(path);
+    return text;
+}
+
+void test_async_writer() {
+    std::cout << "[TEST] async writer matches printStateJSON..." << std::endl;
+
+    assert(trace_text(PROG, true) == trace_text(PROG, false));
+    assert(trace_text(LONG_PROG, true) == trace_text(LONG_PROG, false));
+
+    // 诊断信息与同步打印时一样插在前一步的状态之后
+    std::string bad = trace_text(BAD_OP_PROG, false);
+    assert(bad.find("}ALU报错setCC报错,\n") != std::string::npos);
+    assert(trace_text(BAD_OP_PROG, true) == bad);
+
+    std::cout << "  PASS" << std::endl;
+}
+
+int main() {
+    test_sequential();
+    test_seek();
+    test_bad_file();
+    test_binary_diagnostics();
+    test_async_writer();
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "All trace tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/workload.h"
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// 运行到停止，返回与 y86gen --final 相同格式的结果
+static std::string runToEnd(const std::string& text, Engine engine, uint64_t& steps) {
+    Memory mem;
+    CPU cpu(mem);
+    assert(Loader::load(text.data(), text.size(), mem));
+    cpu.engine = engine;
+    steps = cpu.run(UINT64_MAX);
+    assert(cpu.stat == Stat::HLT);
+
+    std::string out = "{\n  \"STEPS\": " + std::to_string(steps) + ",\n  \"FINAL\":\n";
+    appendStateJSON(out, cpu, 1);
+    return out + "\n}\n";
+}
+
+void test_parse() {
+    uint64_t n;
+    assert(Workload::parseCount("1000", n) && n == 1000);
+    assert(Workload::parseCount("5k", n) && n == 5000);
+    assert(Workload::parseCount("100m", n) && n == 100000000);
+    assert(Workload::parseCount("1g", n) && n == 1000000000);
+    assert(!Workload::parseCount("", n));
+    assert(!Workload::parseCount("m", n));
+    assert(!Workload::parseCount("1x", n));
+    assert(!Workload::parseCount("1mm", n));
+
+    for (int i = 0; i < Workload::SHAPE_COUNT; i++) {
+        Workload::Shape s = static_cast<Workload::Shape>(i);
+        Workload::Shape parsed;
+        assert(Workload::parseShape(Workload::shapeName(s), parsed) && parsed == s);
+    }
+    Workload::Shape parsed;
+    assert(!Workload::parseShape("loop", parsed));
+    std::cout << "test_parse passed" << std::endl;
+}
+
+// 每种形状：三个引擎终态相同，执行的指令数接近目标
+void test_shapes() {
+    const uint64_t target = 20000;
+    for (int i = 0; i < Workload::SHAPE_COUNT; i++) {
+        Workload::Shape s = static_cast<Workload::Shape>(i);
+        std::string text = Workload::generate(s, target);
+        assert(!text.empty());
+
+        uint64_t steps, other;
+        std::string ref = runToEnd(text, Engine::SEQ, steps);
+        assert(runToEnd(text, Engine::THREADED, other) == ref && other == steps);
+        assert(runToEnd(text, Engine::JIT, other) == ref && other == steps);
+        assert(steps > target * 8 / 10 && steps < target * 12 / 10);
+    }
+    std::cout << "test_shapes passed" << std::endl;
+}
+
+// 同一种子生成相同的程序，不同种子的数据不同
+void test_seed() {
+    for (int i = 0; i < Workload::SHAPE_COUNT; i++) {
+        Workload::Shape s = static_cast<Workload::Shape>(i);
+        std::string a = Workload::generate(s, 10000, 7);
+        assert(a == Workload::generate(s, 10000, 7));
+        std::string b = Workload::generate(s, 10000, 8);
+        assert(a != b);
+
+        uint64_t sa, sb;
+        if (s != Workload::BRANCHY) continue;
+        // 分支方向取决于种子，但两者都应在目标附近
+        runToEnd(a, Engine::THREADED, sa);
+        runToEnd(b, Engine::THREADED, sb);
+        assert(sa > 8000 && sa < 12000 && sb > 8000 && sb < 12000);
+    }
+    std::cout << "test_seed passed" << std::endl;
+}
+
+// 语料中的小程序与其参考终态一致（语料未生成时跳过）
+void test_corpus() {
+    int checked = 0;
+    for (int i = 0; i < Workload::SHAPE_COUNT; i++) {
+        std::string base = std::string("corpus/") + Workload::shapeName(static_cast<Workload::Shape>(i)) + "-1m";
+        std::string text = readFile(base + ".yo");
+        std::string expected = readFile(base + ".final.json");
+        if (text.empty() || expected.empty()) continue;
+
+        assert(text == Workload::generate(static_cast<Workload::Shape>(i), 1000000));
+        uint64_t steps;
+        assert(runToEnd(text, Engine::THREADED, steps) == expected);
+        checked++;
+    }
+    std::cout << "test_corpus passed (" << checked << " programs)" << std::endl;
+}
+
+int main() {
+    test_parse();
+    test_shapes();
+    test_seed();
+    test_corpus();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <dirent.h>
+#include <streambuf>
+#include "../include/batch.h"
+#include "../include/loader.h"
+#include "../include/scheduler.h"
+#include "../include/trace.h"
+
+static bool hasSuffix(const std::string& s, const char* suffix) {
+    size_t n = std::char_traits<char>::length(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool BatchRunner::addDir(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) return false;
+
+    std::vector<std::string> names;
+    while (struct dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (hasSuffix(name, ".yo") || hasSuffix(name, ".ybo")) names.push_back(name);
+    }
+    closedir(d);
+
+    std::sort(names.begin(), names.end());  // readdir 的顺序不确定
+    for (const auto& name : names) addFile(dir + "/" + name);
+    return true;
+}
+
+void BatchRunner::addFile(const std::string& path) {
+    BatchJob job;
+    job.path = path;
+    size_t slash = path.rfind('/');
+    job.name = slash == std::string::npos ? path : path.substr(slash + 1);
+    list.push_back(job);
+}
+
+// 追加到字符串末尾的输出缓冲
+class AppendBuf : public std::streambuf {
+    public:
+        explicit AppendBuf(std::string& s) : s(s) {}
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (c != traits_type::eof()) s.push_back(static_cast<char>(c));
+            return c;
+        }
+        std::streamsize xsputn(const char* p, std::streamsize n) override {
+            s.append(p, n);
+            return n;
+        }
+
+    private:
+        std::string& s;
+};
+
+// 一个程序的执行状态，在两片之间保存
+class BatchTask : public SliceTask {
+    public:
+        BatchTask(BatchJob& job, const BatchOptions& options) : job(job), options(options) {}
+
+        bool resume(uint64_t budget) override {
+            auto t0 = std::chrono::steady_clock::now();
+            bool done = (mem == nullptr && !start()) || advance(budget);
+            if (done) finish();
+            job.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            return done;
+        }
+
+    private:
+        BatchJob& job;
+        const BatchOptions& options;
+        std::unique_ptr<Memory> mem;
+        std::unique_ptr<CPU> cpu;
+        std::string text;
+        // CPU 的诊断信息：输出 trace 时按执行顺序写进 text（与单程序模式相同的位置），否则丢弃
+        AppendBuf textBuf{text};
+        std::ostream diag{&textBuf};
+        std::ostream discard{nullptr};
+
+        bool trace() const { return !options.outDir.empty(); }
+
+        // 装载，失败时返回 false
+        bool start() {
+            mem.reset(new Memory(options.memSize));
+            cpu.reset(new CPU(*mem));
+            cpu->engine = options.engine;
+            cpu->diag = trace() ? &diag : &discard;
+            Image image;
+            job.loaded = Loader::loadFile(job.path, *mem, &image);
+            cpu->PC = image.entry;
+            text = job.loaded ? "[\n" : "[]\n";
+            return job.loaded;
+        }
+
+        // 最多执行 budget 步，程序结束时返回 true
+        bool advance(uint64_t budget) {
+            uint64_t n = std::min(budget, options.maxSteps - job.steps);
+            if (trace()) {
+                for (uint64_t i = 0; i < n && cpu->stat == Stat::AOK; i++) {
+                    cpu->step();
+                    appendStateJSON(text, *cpu, static_cast<int>(++job.steps));
+                }
+            }
+            else {
+                job.steps += cpu->run(n);  // 不需要 trace 时整片交给引擎（JIT 引擎在这里生效）
+            }
+            return cpu->stat != Stat::AOK || job.steps >= options.maxSteps;
+        }
+
+        void finish() {
+            if (job.loaded) text += "\n]\n";
+            job.stat = cpu->stat;
+            job.PC = cpu->PC;
+
+            if (trace()) {
+                std::string stem = job.name.substr(0, job.name.rfind('.'));
+                FILE* f = fopen((options.outDir + "/" + stem + ".json").c_str(), "w");
+                if (f != nullptr) {
+                    fwrite(text.data(), 1, text.size(), f);
+                    fclose(f);
+                }
+            }
+
+            cpu.reset();
+            mem.reset();
+            std::string().swap(text);
+        }
+};
+
+void BatchRunner::run() {
+    threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<unsigned>(1, std::min<size_t>(threads, list.size()));
+
+    std::vector<std::unique_ptr<BatchTask>> tasks;
+    std::vector<SliceTask*> ptrs;
+    for (auto& job : list) {
+        job = BatchJob{job.name, job.path};  // 允许重复运行
+        tasks.emplace_back(new BatchTask(job, options));
+        ptrs.push_back(tasks.back().get());
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    WorkStealingScheduler scheduler(threads, options.slice);
+    scheduler.run(ptrs);
+    wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    sliceCount = scheduler.slices();
+    stealCount = scheduler.steals();
+}
+
+void BatchRunner::report(std::ostream& out) const {
+    char line[256];
+    uint64_t steps = 0;
+    double cpuSeconds = 0;
+    for (const auto& job : list) {
+        if (job.loaded)
+            snprintf(line, sizeof(line), "%-24s %10llu steps  STAT %d  PC 0x%llx  %9.3f ms\n", job.name.c_str(),
+                     static_cast<unsigned long long>(job.steps), static_cast<int>(job.stat),
+                     static_cast<unsigned long long>(job.PC), job.seconds * 1e3);
+        else
+            snprintf(line, sizeof(line), "%-24s load failed\n", job.name.c_str());
+        out << line;
+        steps += job.steps;
+        cpuSeconds += job.seconds;
+    }
+    snprintf(line, sizeof(line), "total: %zu programs, %llu steps, %u threads, wall %.3f ms, cpu %.3f ms, %.1f MIPS, %llu slices, %llu steals\n",
+             list.size(), static_cast<unsigned long long>(steps), threads, wall * 1e3, cpuSeconds * 1e3,
+             wall > 0 ? steps / wall / 1e6 : 0.0, static_cast<unsigned long long>(sliceCount),
+             static_cast<unsigned long long>(stealCount));
+    out << line;
+}
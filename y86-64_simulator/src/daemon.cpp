@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../include/daemon.h"
+#include "../include/loader.h"
+#include "../include/trace.h"
+
+using namespace DaemonProto;
+
+// 按宿主字节序读写（x86-64 / ARM64 均为小端序），与二进制 trace 相同
+template<typename T>
+static void put(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template<typename T>
+static T get(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+// 阻塞式套接字（客户端）上写出全部数据
+static bool sendAll(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t k = send(fd, p, n, MSG_NOSIGNAL);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += k;
+        n -= k;
+    }
+    return true;
+}
+
+static bool recvAll(int fd, char* p, size_t n) {
+    while (n > 0) {
+        ssize_t k = recv(fd, p, n, 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k;
+        n -= k;
+    }
+    return true;
+}
+
+Daemon::Daemon(const DaemonOptions& options) : options(options) {}
+
+Daemon::~Daemon() {
+    for (auto& c : conns) ::close(c.fd);
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        unlink(sockPath.c_str());
+    }
+    if (wakeFd[0] >= 0) {
+        ::close(wakeFd[0]);
+        ::close(wakeFd[1]);
+    }
+}
+
+// 把镜像复制到工作内存并复位 CPU；复位会清空代码标记，JIT 的翻译随之作废
+void Daemon::restore(Session& s) {
+    s.mem->reset();
+    s.image->forEachLiveWord([&](addr_t addr, word_t val) { s.mem->writeWord(addr, val); });
+    s.cpu->reset();
+    s.cpu->PC = s.entry;
+    s.steps = 0;
+}
+
+void Daemon::putState(std::string& out, const Session& s) const {
+    const CPU& cpu = *s.cpu;
+    put<uint64_t>(out, s.steps);
+    put<uint64_t>(out, cpu.PC);
+    put<uint8_t>(out, static_cast<uint8_t>(cpu.stat));
+    put<uint8_t>(out, (cpu.cc.zf() ? 1 : 0) | (cpu.cc.sf() ? 2 : 0) | (cpu.cc.of() ? 4 : 0));
+    for (int i = 0; i < 15; i++) put<int64_t>(out, cpu.reg.getReg(static_cast<Reg::ID>(i)));
+}
+
+Result Daemon::handle(uint8_t op, uint32_t session, const char* payload, size_t size, std::string& reply) {
+    reply.clear();
+
+    if (op == LOAD) {
+        // 先装入新的镜像，成功后才替换；已有会话的 Memory 与 CPU 保留复用
+        std::unique_ptr<Memory> image(new Memory(options.memSize));
+        Image info;
+        if (!Loader::load(payload, size, *image, &info)) {
+            reply = "load failed";
+            return ERROR;
+        }
+        Session& s = sessions[session];
+        if (!s.cpu) {
+            s.mem.reset(new Memory(options.memSize));
+            s.cpu.reset(new CPU(*s.mem));
+            s.cpu->engine = options.engine;
+        }
+        s.image = std::move(image);
+        s.entry = info.entry;
+        restore(s);
+        put<uint64_t>(reply, s.entry);
+        return OK;
+    }
+
+    auto it = sessions.find(session);
+    if (it == sessions.end()) {
+        reply = "no such session";
+        return ERROR;
+    }
+    Session& s = it->second;
+
+    switch (op) {
+        case RESET:
+            restore(s);
+            return OK;
+
+        case STEP: {
+            // 已停止时不再执行，只返回状态
+            s.writes.clear();
+            if (s.cpu->stat == Stat::AOK) {
+                s.mem->writeLog = &s.writes;
+                s.cpu->step();
+                s.mem->writeLog = nullptr;
+                s.steps++;
+            }
+            putState(reply, s);
+            size_t countAt = reply.size();
+            put<uint32_t>(reply, 0);
+            uint32_t n = 0;
+            for (size_t i = 0; i < s.writes.size(); i++) {
+                addr_t a = s.writes[i];
+                if (i > 0 && a == s.writes[i - 1]) continue;  // 跨字写入 / PUSHQ 等可能重复记录同一个字
+                bool error;
+                put<uint64_t>(reply, a);
+                put<int64_t>(reply, s.mem->readWord(a, error));
+                n++;
+            }
+            std::memcpy(&reply[countAt], &n, sizeof(n));
+            return OK;
+        }
+
+        case RUN: {
+            if (size != 8) {
+                reply = "bad RUN payload";
+                return ERROR;
+            }
+            uint64_t n = s.cpu->run(std::min(get<uint64_t>(payload), MAX_RUN_STEPS));
+            s.steps += n;
+            put<uint64_t>(reply, n);
+            putState(reply, s);
+            return OK;
+        }
+
+        case STATE: {
+            putState(reply, s);
+            size_t countAt = reply.size();
+            put<uint32_t>(reply, 0);
+            uint32_t n = 0;
+            s.mem->forEachLiveWord([&](addr_t addr, word_t val) {
+                put<uint64_t>(reply, addr);
+                put<int64_t>(reply, val);
+                n++;
+            });
+            std::memcpy(&reply[countAt], &n, sizeof(n));
+            return OK;
+        }
+
+        case STATE_JSON:
+            appendStateJSON(reply, *s.cpu, 1);  // 第 1 步不带分隔的逗号
+            return OK;
+
+        case FREE:
+            sessions.erase(it);
+            return OK;
+
+        default:
+            reply = "unknown op";
+            return ERROR;
+    }
+}
+
+bool Daemon::listen(const std::string& path) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+    // 上次未正常退出留下的套接字文件；不是套接字的文件不动
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        ::close(fd);
+        return false;
+    }
+    if (wakeFd[0] < 0 && pipe2(wakeFd, O_CLOEXEC | O_NONBLOCK) < 0) {
+        ::close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    listenFd = fd;
+    sockPath = path;
+    return true;
+}
+
+void Daemon::stop() {
+    stopping.store(true, std::memory_order_relaxed);
+    char c = 0;
+    if (wakeFd[1] >= 0) (void)!write(wakeFd[1], &c, 1);
+}
+
+// 读出连接上的全部可读数据并处理其中完整的帧；连接关闭或协议错误时返回 false
+bool Daemon::readConn(Conn& c) {
+    char buf[64 << 10];
+    for (;;) {
+        ssize_t k = recv(c.fd, buf, sizeof(buf), 0);
+        if (k > 0) {
+            c.in.append(buf, k);
+            if (size_t(k) < sizeof(buf)) break;
+            continue;
+        }
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false;
+    }
+
+    // 一次读到的多个请求（客户端流水线发送）的应答合并写出
+    std::string& out = c.out;
+    std::string reply;
+    size_t pos = 0;
+    while (c.in.size() - pos >= 4 && !stopping.load(std::memory_order_relaxed)) {
+        uint32_t len = get<uint32_t>(&c.in[pos]);
+        if (len < 5 || len > MAX_FRAME) return false;
+        if (c.in.size() - pos - 4 < len) break;
+
+        const char* p = &c.in[pos + 4];
+        Result r = handle(get<uint8_t>(p), get<uint32_t>(p + 1), p + 5, len - 5, reply);
+        put<uint32_t>(out, reply.size() + 1);
+        put<uint8_t>(out, r);
+        out += reply;
+        pos += 4 + len;
+    }
+    c.in.erase(0, pos);
+    return flushConn(c);
+}
+
+// 写出 out 中套接字当前能接收的部分；出错或积压超过 maxPending 时返回 false
+bool Daemon::flushConn(Conn& c) {
+    size_t done = 0;
+    while (done < c.out.size()) {
+        ssize_t k = send(c.fd, c.out.data() + done, c.out.size() - done, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (k < 0) return false;
+        done += k;
+    }
+    c.out.erase(0, done);
+    return c.out.size() <= options.maxPending;
+}
+
+void Daemon::serve() {
+    std::vector<struct pollfd> fds;
+    for (;;) {
+        fds.clear();
+        fds.push_back({wakeFd[0], POLLIN, 0});
+        fds.push_back({listenFd, POLLIN, 0});
+        for (const auto& c : conns) fds.push_back({c.fd, static_cast<short>(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0});
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        if (fds[0].revents) {
+            char buf[64];
+            while (read(wakeFd[0], buf, sizeof(buf)) > 0) {}
+            stopping.store(false, std::memory_order_relaxed);
+            return;
+        }
+
+        // 先处理已有连接（下标与 fds 对应），再接受新连接
+        size_t live = 0;
+        for (size_t i = 0; i < conns.size(); i++) {
+            short ev = fds[i + 2].revents;
+            bool ok = true;
+            if (ev & POLLOUT) ok = flushConn(conns[i]);
+            if (ok && (ev & ~POLLOUT)) ok = readConn(conns[i]);
+            if (!ok) {
+                ::close(conns[i].fd);
+                continue;
+            }
+            if (live != i) conns[live] = std::move(conns[i]);
+            live++;
+        }
+        conns.resize(live);
+
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) conns.push_back({fd, std::string(), std::string()});
+        }
+    }
+}
+
+DaemonClient::~DaemonClient() {
+    close();
+}
+
+bool DaemonClient::connect(const std::string& path) {
+    close();
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void DaemonClient::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool DaemonClient::call(uint8_t op, uint32_t session, const std::string& payload, uint8_t& result, std::string& reply) {
+    if (fd < 0) return false;
+    frame.clear();
+    put<uint32_t>(frame, payload.size() + 5);
+    put<uint8_t>(frame, op);
+    put<uint32_t>(frame, session);
+    frame += payload;
+    if (!sendAll(fd, frame.data(), frame.size())) return false;
+
+    char head[5];
+    if (!recvAll(fd, head, sizeof(head))) return false;
+    uint32_t len = get<uint32_t>(head);
+    if (len < 1 || len > MAX_FRAME) return false;
+    result = get<uint8_t>(head + 4);
+    reply.resize(len - 1);
+    return reply.empty() || recvAll(fd, &reply[0], reply.size());
+}
@@ -0,0 +1,39 @@
+#include "../include/icache.h"
+
+ICache::ICache() : lines(ENTRIES) {}
+
+void ICache::clear(){
+    if (validCount == 0) return;
+    for (auto& e : lines) e.valid = false;
+    validCount = 0;
+    lo = hi = 0;
+}
+
+void ICache::insert(const DecodedInst& inst){
+    DecodedInst& e = lines[inst.pc & (ENTRIES - 1)];
+    if (!e.valid) validCount++;
+    e = inst;
+    e.valid = true;
+
+    if (validCount == 1){
+        lo = inst.pc;
+        hi = inst.pc + inst.len;
+    }
+    else{
+        if (inst.pc < lo) lo = inst.pc;
+        if (inst.pc + inst.len > hi) hi = inst.pc + inst.len;
+    }
+}
+
+void ICache::invalidateRange(addr_t addr, addr_t len){
+    // 起始地址落在 [addr - (MAX_INST_LEN-1), addr + len) 内的指令才可能与写入区间重叠
+    addr_t first = (addr >= MAX_INST_LEN - 1) ? addr - (MAX_INST_LEN - 1) : 0;
+    for (addr_t a = first; a < addr + len; a++){
+        DecodedInst& e = lines[a & (ENTRIES - 1)];
+        if (e.valid && e.pc == a && a + e.len > addr){
+            e.valid = false;
+            validCount--;
+        }
+    }
+    if (validCount == 0) lo = hi = 0;
+}
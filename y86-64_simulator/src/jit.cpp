@@ -0,0 +1,561 @@
+#include "../include/jit.h"
+#include "../include/cpu.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define Y86_JIT_NATIVE 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define Y86_JIT_NATIVE 0
+#endif
+
+#if Y86_JIT_NATIVE
+
+namespace {
+
+// 宿主寄存器编号（x86-64 编码顺序）
+enum Host{
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+    R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+// 条件码（jcc / setcc 的低 4 位）
+enum HostCC{
+    CC_O = 0x0, CC_E = 0x4, CC_NE = 0x5, CC_S = 0x8, CC_L = 0xC, CC_A = 0x7
+};
+
+// 生成代码中固定用途的宿主寄存器：
+//   rbx = JitContext*, r12 = 客户寄存器数组, r13 = 客户内存, r14 = codeMap, r15 = ConditionCode
+// rax / rcx / rdx 为临时寄存器
+
+const uint8_t* const UNTRANSLATABLE = reinterpret_cast<const uint8_t*>(1);
+
+// 最小的 x86-64 编码器，只覆盖翻译用到的指令形式
+struct Emitter{
+    uint8_t* p;
+
+    void b(uint8_t x) { *p++ = x; }
+    void d32(int32_t x) { std::memcpy(p, &x, 4); p += 4; }
+    void d64(uint64_t x) { std::memcpy(p, &x, 8); p += 8; }
+
+    // op reg, [base + index + disp32]；总是带 REX，8 位操作数只使用 al / cl / dl
+    void mem(std::initializer_list<uint8_t> opcode, int reg, int base, int index, int32_t disp, bool w){
+        b(0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((index >= 0 && (index & 8)) ? 2 : 0) | ((base & 8) ? 1 : 0));
+        for (uint8_t o : opcode) b(o);
+        if (index >= 0 || (base & 7) == 4){
+            b(0x80 | ((reg & 7) << 3) | 4);
+            b((((index >= 0 ? index : 4) & 7) << 3) | (base & 7));
+        }
+        else b(0x80 | ((reg & 7) << 3) | (base & 7));
+        d32(disp);
+    }
+
+    // op r/m(dst), reg(src)
+    void rr(uint8_t op, int src, int dst, bool w = true){
+        b(0x40 | (w ? 8 : 0) | ((src & 8) ? 4 : 0) | ((dst & 8) ? 1 : 0));
+        b(op);
+        b(0xC0 | ((src & 7) << 3) | (dst & 7));
+    }
+
+    void movImm64(int r, uint64_t v){
+        b(0x48 | ((r & 8) ? 1 : 0));
+        b(0xB8 + (r & 7));
+        d64(v);
+    }
+
+    // 返回 rel32 字段的位置，之后用 patch 回填
+    uint8_t* jcc(int cc) { b(0x0F); b(0x80 | cc); d32(0); return p - 4; }
+    uint8_t* jmp() { b(0xE9); d32(0); return p - 4; }
+
+    void setcc(int cc, int reg8) { b(0x0F); b(0x90 | cc); b(0xC0 | reg8); }
+
+    static void patch(uint8_t* rel32, const uint8_t* target){
+        int32_t rel = static_cast<int32_t>(target - (rel32 + 4));
+        std::memcpy(rel32, &rel, 4);
+    }
+};
+
+const int CTX_REGS = offsetof(JitContext, regs);
+const int CTX_MEM = offsetof(JitContext, mem);
+const int CTX_CODEMAP = offsetof(JitContext, codeMap);
+const int CTX_CC = offsetof(JitContext, cc);
+const int CTX_BUDGET = offsetof(JitContext, budget);
+const int CTX_PC = offsetof(JitContext, pc);
+const int CTX_REASON = offsetof(JitContext, reason);
+const int CTX_PATCH = offsetof(JitContext, patchSite);
+const int CTX_LAST = offsetof(JitContext, last);
+
+// perf 符号表在进程内只打开一次（追加），所有 JIT 实例（批量运行、多个 libY86 句柄、常驻模式的会话）共用
+std::once_flag perfMapOnce;
+std::mutex perfMapLock;
+FILE* perfMapFile = nullptr;
+
+// 是否能翻译（其余情况交给解释器，保持与 SEQ 完全一致的副作用）
+bool supported(const DecodedInst& d){
+    switch (d.icode){
+        case ICode::NOP:
+        case ICode::IRMOVQ:
+        case ICode::RMMOVQ:
+        case ICode::MRMOVQ:
+        case ICode::CALL:
+        case ICode::RET:
+        case ICode::PUSHQ:
+        case ICode::POPQ:
+            return true;
+        case ICode::RRMOVQ:
+        case ICode::JXX:
+            return d.ifunc <= Cond::G;
+        case ICode::OPQ:
+            return d.ifunc <= ALU::XOR;
+        default:
+            return false;  // HALT 与非法 icode
+    }
+}
+
+} // namespace
+
+bool JIT::available() { return true; }
+
+JIT::JIT(CPU& c) : cpu(c), blockAt(c.mem.denseSize(), nullptr) {
+    void* m = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) return;  // 无法分配可执行内存时退化为解释执行
+
+    code = static_cast<uint8_t*>(m);
+    emitStubs();
+    if (getenv("Y86_JIT_PERF_MAP") != nullptr) enablePerfMap();
+    epoch = cpu.mem.codeEpoch - 1;  // 首次 run 时强制 flush，与内存当前状态同步
+}
+
+JIT::~JIT(){
+    if (code != nullptr) munmap(code, CODE_SIZE);
+}
+
+void JIT::enablePerfMap(){
+    if (perfMap != nullptr) return;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", static_cast<int>(getpid()));
+    std::call_once(perfMapOnce, [&]{ perfMapFile = fopen(path, "a"); });
+    perfMap = perfMapFile;
+}
+
+// 入口：enter(ctx, block) 保存被调用者保存寄存器，装载固定寄存器后跳入块
+// 出口：所有块通过 jmp exitStub 返回调度器
+void JIT::emitStubs(){
+    Emitter e{code};
+
+    enter = reinterpret_cast<void (*)(JitContext*, const uint8_t*)>(e.p);
+    e.b(0x53);                      // push rbx
+    e.b(0x55);                      // push rbp
+    e.b(0x41); e.b(0x54);           // push r12
+    e.b(0x41); e.b(0x55);           // push r13
+    e.b(0x41); e.b(0x56);           // push r14
+    e.b(0x41); e.b(0x57);           // push r15
+    e.b(0x48); e.b(0x83); e.b(0xEC); e.b(0x08);  // sub rsp, 8
+    e.rr(0x89, RDI, RBX);           // mov rbx, rdi
+    e.mem({0x8B}, R12, RBX, -1, CTX_REGS, true);
+    e.mem({0x8B}, R13, RBX, -1, CTX_MEM, true);
+    e.mem({0x8B}, R14, RBX, -1, CTX_CODEMAP, true);
+    e.mem({0x8B}, R15, RBX, -1, CTX_CC, true);
+    e.b(0xFF); e.b(0xE6);           // jmp rsi
+
+    exitStub = e.p;
+    e.b(0x48); e.b(0x83); e.b(0xC4); e.b(0x08);  // add rsp, 8
+    e.b(0x41); e.b(0x5F);           // pop r15
+    e.b(0x41); e.b(0x5E);           // pop r14
+    e.b(0x41); e.b(0x5D);           // pop r13
+    e.b(0x41); e.b(0x5C);           // pop r12
+    e.b(0x5D);                      // pop rbp
+    e.b(0x5B);                      // pop rbx
+    e.b(0xC3);                      // ret
+
+    stubEnd = codeUsed = static_cast<size_t>(e.p - code);
+}
+
+void JIT::flush(){
+    std::fill(blockAt.begin(), blockAt.end(), nullptr);
+    blocks = 0;
+    codeUsed = stubEnd;
+    flushes++;
+    cpu.mem.clearCode();   // 翻译与预解码缓存一起丢弃，codeMap 重新从空开始标记
+    epoch = cpu.mem.codeEpoch;
+}
+
+uint8_t* JIT::lookup(addr_t pc){
+    if (pc >= blockAt.size()) return nullptr;  // 交给解释器报告 ADR，或执行分页区中的代码
+    uint8_t* b = blockAt[pc];
+    if (b == UNTRANSLATABLE) return nullptr;
+    if (b != nullptr) return b;
+    return translate(pc);
+}
+
+uint8_t* JIT::translate(addr_t start){
+    // 生成代码直接读写固化后的标志位（标志位是 ConditionCode 的私有成员，JIT 为其友元）
+    const int CC_ZF = offsetof(ConditionCode, zf_);
+    const int CC_SF = offsetof(ConditionCode, sf_);
+    const int CC_OF = offsetof(ConditionCode, of_);
+
+    // 先解码出整个基本块
+    DecodedInst insts[MAX_BLOCK_INSTS];
+    int n = 0;
+    addr_t pc = start;
+    bool terminated = false;
+    while (n < MAX_BLOCK_INSTS){
+        DecodedInst& d = insts[n];
+        if (!CPU::predecode(cpu.mem, pc, d) || !supported(d) || pc + d.len > blockAt.size()) break;  // 只翻译 Memory::data 中的指令
+        n++;
+        pc = d.valP;
+        if (d.icode == ICode::JXX || d.icode == ICode::CALL || d.icode == ICode::RET){
+            terminated = true;
+            break;
+        }
+    }
+    if (n == 0){
+        blockAt[start] = const_cast<uint8_t*>(UNTRANSLATABLE);
+        return nullptr;
+    }
+
+    if (CODE_SIZE - codeUsed < MAX_BLOCK_BYTES) flush();
+
+    uint8_t* entry = code + codeUsed;
+    Emitter e{entry};
+
+    struct SideExit{ uint8_t* site; addr_t pc; int refund; uint64_t reason; int index; };
+    SideExit exits[MAX_BLOCK_INSTS * 4 + 1];
+    int nexits = 0;
+
+    auto loadReg = [&](int host, uint8_t id){
+        if (id == Reg::NONE) e.rr(0x31, host, host, false);   // xor r32, r32
+        else e.mem({0x8B}, host, R12, -1, 8 * id, true);
+    };
+    auto storeReg = [&](int host, uint8_t id){
+        if (id != Reg::NONE) e.mem({0x89}, host, R12, -1, 8 * id, true);
+    };
+    auto sideExit = [&](int cc, int i, uint64_t reason){
+        exits[nexits++] = { e.jcc(cc), insts[i].pc, n - i, reason, i };
+    };
+    // rax 为访存地址：超出 Memory::data（含 8 字节跨越末尾）时在第 i 条指令之前退出，
+    // 由解释器完成分页区的访问或报告越界
+    auto checkBounds = [&](int i){
+        e.b(0x48); e.b(0x3D); e.d32(static_cast<int32_t>(blockAt.size() - 8));   // cmp rax, denseSize-8
+        sideExit(CC_A, i, INTERP);
+    };
+    // 写入的 8 个字节中有代码字节时退出，由解释器完成写入并使翻译失效
+    auto checkCode = [&](int i){
+        e.mem({0x8B}, RCX, R14, RAX, 0, true);   // mov rcx, [r14 + rax]
+        e.rr(0x85, RCX, RCX);                    // test rcx, rcx
+        sideExit(CC_NE, i, INTERP);
+    };
+    // 条件求值，返回“条件成立”对应的 jcc 条件码
+    auto evalCond = [&](int fn){
+        switch (fn){
+            case Cond::E:
+            case Cond::NE:
+                e.mem({0x0F, 0xB6}, RAX, R15, -1, CC_ZF, false);  // movzx eax, zf
+                break;
+            default:
+                e.mem({0x0F, 0xB6}, RAX, R15, -1, CC_SF, false);  // movzx eax, sf
+                e.mem({0x32}, RAX, R15, -1, CC_OF, false);        // xor al, of
+                if (fn == Cond::LE || fn == Cond::G)
+                    e.mem({0x0A}, RAX, R15, -1, CC_ZF, false);    // or al, zf
+                break;
+        }
+        e.rr(0x85, RAX, RAX, false);                              // test eax, eax
+        return (fn == Cond::NE || fn == Cond::GE || fn == Cond::G) ? CC_E : CC_NE;
+    };
+    auto setPC = [&](addr_t target){
+        e.movImm64(RAX, target);
+        e.mem({0x89}, RAX, RBX, -1, CTX_PC, true);
+    };
+    // 记录最后执行完的指令，取指出错回退到 SEQ 流程时据此恢复中间信号（见 BasicCPU::last）
+    auto setLast = [&](addr_t pc){
+        e.mem({0xC7}, 0, RBX, -1, CTX_LAST, true);
+        e.d32(static_cast<int32_t>(pc));
+    };
+    auto setReason = [&](uint64_t reason){
+        e.mem({0xC7}, 0, RBX, -1, CTX_REASON, true);
+        e.d32(static_cast<int32_t>(reason));
+    };
+    auto exitToDispatcher = [&](){
+        Emitter::patch(e.jmp(), exitStub);
+    };
+    // 直接跳转出口：起始的 jmp 初始跳到紧随其后的慢路径，目标块翻译后回填为直达
+    // from 为跳转前最后执行的指令，链接后同样要记录
+    auto chainExit = [&](addr_t target, addr_t from){
+        setLast(from);
+        uint8_t* site = e.p;
+        uint8_t* rel = e.jmp();
+        Emitter::patch(rel, e.p);
+        setPC(target);
+        setReason(CHAIN);
+        e.movImm64(RAX, reinterpret_cast<uint64_t>(site));
+        e.mem({0x89}, RAX, RBX, -1, CTX_PATCH, true);
+        exitToDispatcher();
+    };
+
+    // 预算检查：剩余预算不足 n 条时不进入块
+    e.mem({0x81}, 7, RBX, -1, CTX_BUDGET, true); e.d32(n);   // cmp qword [budget], n
+    exits[nexits++] = { e.jcc(CC_L), start, 0, BUDGET, 0 };
+    e.mem({0x81}, 5, RBX, -1, CTX_BUDGET, true); e.d32(n);   // sub qword [budget], n
+
+    for (int i = 0; i < n; i++){
+        const DecodedInst& d = insts[i];
+        switch (d.icode){
+            case ICode::NOP:
+                break;
+
+            case ICode::RRMOVQ:{
+                uint8_t* skip = nullptr;
+                if (d.ifunc != Cond::None){
+                    int cc = evalCond(d.ifunc);
+                    skip = e.jcc(cc ^ 1);   // 条件不成立则跳过
+                }
+                loadReg(RAX, d.rA);
+                storeReg(RAX, d.rB);
+                if (skip != nullptr) Emitter::patch(skip, e.p);
+                break;
+            }
+
+            case ICode::IRMOVQ:
+                if (d.rB != Reg::NONE){
+                    e.movImm64(RAX, d.valC);
+                    storeReg(RAX, d.rB);
+                }
+                break;
+
+            case ICode::RMMOVQ:
+                e.movImm64(RAX, d.valC);
+                if (d.rB != Reg::NONE) e.mem({0x03}, RAX, R12, -1, 8 * d.rB, true);  // add rax, rB
+                checkBounds(i);
+                checkCode(i);
+                loadReg(RDX, d.rA);
+                e.mem({0x89}, RDX, R13, RAX, 0, true);   // mov [r13 + rax], rdx
+                break;
+
+            case ICode::MRMOVQ:
+                e.movImm64(RAX, d.valC);
+                if (d.rB != Reg::NONE) e.mem({0x03}, RAX, R12, -1, 8 * d.rB, true);
+                checkBounds(i);
+                e.mem({0x8B}, RDX, R13, RAX, 0, true);   // mov rdx, [r13 + rax]
+                storeReg(RDX, d.rA);
+                break;
+
+            case ICode::OPQ:
+                loadReg(RAX, d.rB);   // b
+                loadReg(RCX, d.rA);   // a
+                switch (d.ifunc){
+                    case ALU::ADD:
+                        // OF 与 CPU::setCC 一致：(a>0 && b>0 && e<0) || (a<0 && b<0 && e>0)
+                        // 即宿主 OF 且结果非 0
+                        e.rr(0x01, RCX, RAX);
+                        e.mem({0x0F, 0x90 | CC_E}, 0, R15, -1, CC_ZF, false);
+                        e.mem({0x0F, 0x90 | CC_S}, 0, R15, -1, CC_SF, false);
+                        e.setcc(CC_O, RDX);
+                        e.setcc(CC_NE, RCX);
+                        e.rr(0x20, RCX, RDX, false);   // and dl, cl
+                        e.mem({0x88}, RDX, R15, -1, CC_OF, false);
+                        break;
+                    case ALU::SUB:
+                        // (a<0 && b>0 && e<0) || (a>0 && b<0 && e>0)，即宿主 OF 且 b 非 0
+                        e.rr(0x89, RAX, RDX);          // mov rdx, rax（保存 b）
+                        e.rr(0x29, RCX, RAX);
+                        e.mem({0x0F, 0x90 | CC_E}, 0, R15, -1, CC_ZF, false);
+                        e.mem({0x0F, 0x90 | CC_S}, 0, R15, -1, CC_SF, false);
+                        e.setcc(CC_O, RCX);
+                        e.rr(0x85, RDX, RDX);          // test rdx, rdx
+                        e.setcc(CC_NE, RDX);
+                        e.rr(0x20, RDX, RCX, false);   // and cl, dl
+                        e.mem({0x88}, RCX, R15, -1, CC_OF, false);
+                        break;
+                    default:
+                        e.rr(d.ifunc == ALU::AND ? 0x21 : 0x31, RCX, RAX);
+                        e.mem({0x0F, 0x90 | CC_E}, 0, R15, -1, CC_ZF, false);
+                        e.mem({0x0F, 0x90 | CC_S}, 0, R15, -1, CC_SF, false);
+                        e.mem({0xC6}, 0, R15, -1, CC_OF, false); e.b(0);
+                        break;
+                }
+                storeReg(RAX, d.rB);
+                break;
+
+            case ICode::PUSHQ:
+                loadReg(RDX, d.rA);
+                e.mem({0x8B}, RAX, R12, -1, 8 * Reg::RSP, true);
+                e.b(0x48); e.b(0x83); e.b(0xE8); e.b(0x08);   // sub rax, 8
+                checkBounds(i);
+                checkCode(i);
+                e.mem({0x89}, RDX, R13, RAX, 0, true);
+                storeReg(RAX, Reg::RSP);
+                break;
+
+            case ICode::POPQ:
+                e.mem({0x8B}, RAX, R12, -1, 8 * Reg::RSP, true);
+                checkBounds(i);
+                e.mem({0x8B}, RDX, R13, RAX, 0, true);
+                e.b(0x48); e.b(0x83); e.b(0xC0); e.b(0x08);   // add rax, 8
+                storeReg(RAX, Reg::RSP);
+                storeReg(RDX, d.rA);   // popq %rsp 时以读出的值为准
+                break;
+
+            case ICode::JXX:
+                if (d.ifunc == Cond::None) chainExit(d.valC, d.pc);
+                else{
+                    uint8_t* taken = e.jcc(evalCond(d.ifunc));
+                    chainExit(d.valP, d.pc);
+                    Emitter::patch(taken, e.p);
+                    chainExit(d.valC, d.pc);
+                }
+                break;
+
+            case ICode::CALL:
+                e.mem({0x8B}, RAX, R12, -1, 8 * Reg::RSP, true);
+                e.b(0x48); e.b(0x83); e.b(0xE8); e.b(0x08);   // sub rax, 8
+                checkBounds(i);
+                checkCode(i);
+                e.movImm64(RDX, d.valP);
+                e.mem({0x89}, RDX, R13, RAX, 0, true);
+                storeReg(RAX, Reg::RSP);
+                chainExit(d.valC, d.pc);
+                break;
+
+            case ICode::RET:
+                e.mem({0x8B}, RAX, R12, -1, 8 * Reg::RSP, true);
+                checkBounds(i);
+                e.mem({0x8B}, RDX, R13, RAX, 0, true);
+                e.b(0x48); e.b(0x83); e.b(0xC0); e.b(0x08);   // add rax, 8
+                storeReg(RAX, Reg::RSP);
+                e.mem({0x89}, RDX, RBX, -1, CTX_PC, true);    // 间接跳转：由调度器查找目标块
+                setLast(d.pc);
+                setReason(NORMAL);
+                exitToDispatcher();
+                break;
+        }
+    }
+
+    // 块因长度上限或遇到不可翻译的指令而结束：顺序执行到下一条
+    if (!terminated) chainExit(pc, insts[n - 1].pc);
+
+    // 侧出口：退还未执行指令的预算后返回调度器
+    for (int k = 0; k < nexits; k++){
+        Emitter::patch(exits[k].site, e.p);
+        setPC(exits[k].pc);
+        if (exits[k].index > 0) setLast(insts[exits[k].index - 1].pc);  // 块内第一条之前退出时沿用进入前的记录
+        if (exits[k].refund > 0){
+            e.mem({0x81}, 0, RBX, -1, CTX_BUDGET, true);   // add qword [budget], refund
+            e.d32(exits[k].refund);
+        }
+        setReason(exits[k].reason);
+        exitToDispatcher();
+    }
+
+    size_t size = static_cast<size_t>(e.p - entry);
+    codeUsed += size;
+    blockAt[start] = entry;
+    blocks++;
+    cpu.mem.markCode(start, pc - start);
+
+    if (perfMap != nullptr){
+        std::lock_guard<std::mutex> lock(perfMapLock);
+        fprintf(perfMap, "%lx %zx y86_block_0x%lx\n",
+                static_cast<unsigned long>(reinterpret_cast<uintptr_t>(entry)), size,
+                static_cast<unsigned long>(start));
+        fflush(perfMap);
+    }
+
+    return entry;
+}
+
+uint64_t JIT::run(uint64_t maxSteps){
+    if (code == nullptr){
+        uint64_t n = 0;
+        while (cpu.stat == Stat::AOK && n < maxSteps){
+            cpu.step();
+            n++;
+        }
+        return n;
+    }
+
+    ctx.regs = cpu.reg.regs.data();
+    ctx.mem = cpu.mem.data.data();
+    ctx.codeMap = cpu.mem.codeMap.data();
+    ctx.cc = &cpu.cc;
+    ctx.budget = maxSteps > static_cast<uint64_t>(INT64_MAX) ? INT64_MAX : static_cast<int64_t>(maxSteps);
+    int64_t initial = ctx.budget;
+    bool entered = false;
+
+    while (cpu.stat == Stat::AOK && ctx.budget > 0){
+        if (cpu.mem.codeEpoch != epoch) flush();
+
+        uint8_t* b = lookup(cpu.PC);
+        if (b == nullptr){
+            cpu.step();  // engine 为 JIT 时 step 走 THREADED 路径
+            ctx.budget--;
+            continue;
+        }
+
+        cpu.cc.materialize();  // 解释执行的 OPq 可能留下惰性条件码
+        ctx.pc = cpu.PC;
+        ctx.reason = NORMAL;
+        ctx.last = NO_LAST;
+        entered = true;
+        enter(&ctx, b);
+        cpu.PC = ctx.pc;
+        if (ctx.last != NO_LAST){
+            lastInst.pc = ctx.last;
+            lastInst.len = 0;
+            cpu.last = &lastInst;
+        }
+
+        switch (ctx.reason){
+            case INTERP:
+            case BUDGET:
+                // 经块链接到达的块可能在预算恰好耗尽时退出
+                if (ctx.budget > 0){
+                    cpu.step();
+                    ctx.budget--;
+                }
+                break;
+            case CHAIN:{
+                // 回填块链接；若翻译目标时发生了 flush，出口所在的块已不存在
+                uint64_t before = flushes;
+                uint8_t* target = lookup(ctx.pc);
+                if (target != nullptr && flushes == before && cpu.mem.codeEpoch == epoch)
+                    Emitter::patch(ctx.patchSite + 1, target);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // 生成代码直接写 Memory::data，不经过写接口维护的非零字位图
+    if (entered) cpu.mem.rescanLive();
+    return static_cast<uint64_t>(initial - ctx.budget);
+}
+
+#else  // !Y86_JIT_NATIVE
+
+bool JIT::available() { return false; }
+
+JIT::JIT(CPU& c) : cpu(c) {}
+
+JIT::~JIT() {}
+
+void JIT::enablePerfMap() {}
+
+void JIT::flush() {}
+
+uint64_t JIT::run(uint64_t maxSteps){
+    uint64_t n = 0;
+    while (cpu.stat == Stat::AOK && n < maxSteps){
+        cpu.step();
+        n++;
+    }
+    return n;
+}
+
+#endif
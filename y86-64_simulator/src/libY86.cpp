@@ -0,0 +1,180 @@
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "../include/libY86.h"
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+
+// 句柄：一个 Memory + 一个 CPU，不与其他句柄共享任何可变状态
+// CPU 的诊断信息丢弃，不写到宿主进程的标准输出
+struct y86_sim {
+    Memory mem;
+    CPU cpu;
+    uint64_t steps = 0;
+    std::ostream discard{nullptr};
+
+    y86_sim(addr_t size) : mem(size), cpu(mem) { cpu.diag = &discard; }
+};
+
+// 内存只保存非零的对齐字，与地址空间大小无关
+struct y86_snapshot {
+    addr_t size;
+    word_t regs[Y86_NUM_REGS];
+    bool zf, sf, of;
+    addr_t PC;
+    Stat stat;
+    uint64_t steps;
+    std::vector<std::pair<addr_t, word_t>> words;
+};
+
+// 各入口捕获全部异常（内存不足等），不让异常穿过 C 接口
+extern "C" {
+
+int y86_abi_version(void) {
+    return Y86_ABI_VERSION;
+}
+
+y86_sim* y86_create(uint64_t mem_size, int engine) {
+    if (engine < Y86_ENGINE_SEQ || engine > Y86_ENGINE_JIT) return nullptr;
+    try {
+        y86_sim* sim = new y86_sim(mem_size ? mem_size : Memory::MAX_SIZE);
+        sim->cpu.engine = static_cast<Engine>(engine);
+        return sim;
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void y86_destroy(y86_sim* sim) {
+    delete sim;
+}
+
+int y86_load(y86_sim* sim, const char* buf, size_t len) {
+    try {
+        sim->mem.reset();
+        sim->cpu.reset();
+        sim->steps = 0;
+        Image info;
+        if (!Loader::load(buf, len, sim->mem, &info)) return -1;
+        sim->cpu.PC = info.entry;
+        return 0;
+    }
+    catch (...) {
+        return -1;
+    }
+}
+
+uint64_t y86_run(y86_sim* sim, uint64_t max_steps) {
+    try {
+        uint64_t n = sim->cpu.run(max_steps);
+        sim->steps += n;
+        return n;
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+uint64_t y86_steps(const y86_sim* sim) {
+    return sim->steps;
+}
+
+int y86_stat(const y86_sim* sim) {
+    return static_cast<int>(sim->cpu.stat);
+}
+
+uint64_t y86_pc(const y86_sim* sim) {
+    return sim->cpu.PC;
+}
+
+void y86_set_pc(y86_sim* sim, uint64_t pc) {
+    sim->cpu.PC = pc;
+}
+
+int y86_cc(const y86_sim* sim) {
+    const ConditionCode& cc = sim->cpu.cc;
+    return (cc.zf() ? Y86_CC_ZF : 0) | (cc.sf() ? Y86_CC_SF : 0) | (cc.of() ? Y86_CC_OF : 0);
+}
+
+void y86_get_regs(const y86_sim* sim, int64_t* regs) {
+    for (int i = 0; i < Y86_NUM_REGS; i++) regs[i] = sim->cpu.reg.getReg(static_cast<Reg::ID>(i));
+}
+
+void y86_set_regs(y86_sim* sim, const int64_t* regs) {
+    for (int i = 0; i < Y86_NUM_REGS; i++) sim->cpu.reg.setReg(static_cast<Reg::ID>(i), regs[i]);
+}
+
+int y86_read_mem(const y86_sim* sim, uint64_t addr, void* buf, size_t len) {
+    return sim->mem.readBlock(addr, static_cast<byte_t*>(buf), len) ? -1 : 0;
+}
+
+// 经 writeBlock 写入：改写代码时预解码缓存与 JIT 翻译同样失效
+int y86_write_mem(y86_sim* sim, uint64_t addr, const void* buf, size_t len) {
+    try {
+        return sim->mem.writeBlock(addr, static_cast<const byte_t*>(buf), len) ? -1 : 0;
+    }
+    catch (...) {
+        return -1;
+    }
+}
+
+size_t y86_live_words(const y86_sim* sim, uint64_t* addrs, int64_t* values, size_t cap) {
+    size_t n = 0;
+    sim->mem.forEachLiveWord([&](addr_t addr, word_t val) {
+        if (n < cap) {
+            addrs[n] = addr;
+            values[n] = val;
+        }
+        n++;
+    });
+    return n;
+}
+
+y86_snapshot* y86_snapshot_take(const y86_sim* sim) {
+    const CPU& cpu = sim->cpu;
+    std::unique_ptr<y86_snapshot> snap;
+    try {
+        snap.reset(new y86_snapshot());
+        snap->size = sim->mem.size();
+        y86_get_regs(sim, snap->regs);
+        snap->zf = cpu.cc.zf();
+        snap->sf = cpu.cc.sf();
+        snap->of = cpu.cc.of();
+        snap->PC = cpu.PC;
+        snap->stat = cpu.stat;
+        snap->steps = sim->steps;
+        sim->mem.forEachLiveWord([&](addr_t addr, word_t val) { snap->words.push_back({addr, val}); });
+    }
+    catch (...) {
+        return nullptr;
+    }
+    return snap.release();
+}
+
+int y86_snapshot_restore(y86_sim* sim, const y86_snapshot* snap) {
+    if (snap->size != sim->mem.size()) return -1;
+    try {
+        sim->mem.reset();
+        for (const auto& w : snap->words) sim->mem.writeWord(w.first, w.second);
+    }
+    catch (...) {
+        return -1;
+    }
+    sim->cpu.reset();  // 快照不含中间信号，恢复后与新装载的 CPU 相同
+    y86_set_regs(sim, snap->regs);
+    sim->cpu.cc.set(snap->zf, snap->sf, snap->of);
+    sim->cpu.PC = snap->PC;
+    sim->cpu.stat = snap->stat;
+    sim->steps = snap->steps;
+    return 0;
+}
+
+void y86_snapshot_free(y86_snapshot* snap) {
+    delete snap;
+}
+
+}
@@ -1,62 +1,330 @@
 #include "../include/loader.h"
-#include <sstream>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-static inline std::string trim(const std::string& s){  // 不修改 s, 仅仅 return s.substr
-    size_t start = s.find_first_not_of(" \t");  // 寻找 s 中第一个不包含 ' ' 和 '\t' 的位置，是的你没看错这个函数能同时搜索排除这两个字符
-    if (start == std::string::npos) return "";
-    size_t end = s.find_last_not_of(" \t");
-    if (end == std::string::npos) return "";
+// 手写的扫描器：在原文上按行解析，不分配内存、不抛异常
+// 行为与原先基于 std::getline / trim / std::stoull / std::stoi 的实现逐行一致：
+//   - 没有冒号、地址为空或无法解析的行跳过
+//   - 字节区域为冒号之后、竖线之前（竖线在冒号之前时取到行尾），两端去掉空格和 Tab
+//   - 字节区域每 2 个字符按 std::stoi(s, nullptr, 16) 的规则解析为一个字节，
+//     无法解析时放弃该行剩余部分（之前的字节已写入），写入越界时整体返回 false
 
-    return s.substr(start, end-start+1);
+static inline bool isBlank(char c){  // trim 只去掉空格与 Tab
+    return c == ' ' || c == '\t';
+}
+
+static inline bool isSpace(char c){  // strtol / strtoull 跳过的前导空白
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline int hexDigit(char c){
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;  // 转为小写
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// 与 std::stoull(s, nullptr, 16) 相同：前导空白、正负号、0x 前缀，遇到非 hex 字符停止
+// 没有任何数字或溢出时返回 false（原实现中 stoull 抛出异常，该行被跳过）
+static bool parseAddr(const char* p, const char* end, addr_t& out){
+    while (p < end && isSpace(*p)) p++;
+    bool neg = false;
+    if (p < end && (*p == '+' || *p == '-')) neg = (*p++ == '-');
+    if (end - p >= 3 && p[0] == '0' && (p[1] | 0x20) == 'x' && hexDigit(p[2]) >= 0) p += 2;
+
+    addr_t v = 0;
+    const char* digits = p;
+    for (int d; p < end && (d = hexDigit(*p)) >= 0; p++){
+        if (v >> 60) return false;  // 再左移 4 位会溢出
+        v = (v << 4) | d;
+    }
+    if (p == digits) return false;
+
+    out = neg ? ~v + 1 : v;
+    return true;
+}
+
+// 与 std::stoi(s, nullptr, 16) 相同（s 至多 2 个字符）
+static bool parseByte(const char* p, const char* end, byte_t& out){
+    while (p < end && isSpace(*p)) p++;
+    bool neg = false;
+    if (p < end && (*p == '+' || *p == '-')) neg = (*p++ == '-');
+
+    int v = 0;
+    const char* digits = p;
+    for (int d; p < end && (d = hexDigit(*p)) >= 0; p++) v = v * 16 + d;
+    if (p == digits) return false;
+
+    out = static_cast<byte_t>(neg ? -v : v);
+    return true;
 }
 
 bool Loader::load(std::string& content, Memory& mem){  // 类外定义成员函数永远不能再写 static, .h里面已经写过了
+    // main会将 .yo 读入为 string类型的 content， 然后 load 再解析
+    // 便于单元测试（可自定义content），并实现IO层与解析层（Loader）的分离，是最佳实践
+    return load(content.data(), content.size(), mem);
+}
+
+// 一行 .yo 拆出的各部分
+struct YoLine{
+    addr_t addr;
+    const char* hex;       // 去掉两端空白后的 hex 字节区域 [hex, hexEnd)
+    const char* hexEnd;
+    const char* comment;   // 冒号之后的竖线之后的部分 [comment, end)，没有时为 nullptr
+    const char* end;
+};
+
+// 拆分 [line, eol) ；没有冒号、地址为空或无法解析时返回 false
+static bool splitLine(const char* line, const char* eol, YoLine& l){
+    // 找冒号（分割地址）
+    const char* colon = static_cast<const char*>(std::memchr(line, ':', eol - line));
+    if (colon == nullptr) return false;
+
+    // 找竖线（截掉注释），得到结束位置
+    const char* pipe = static_cast<const char*>(std::memchr(line, '|', eol - line));
+    const char* hexEnd = (pipe == nullptr || pipe < colon) ? eol : pipe;
+    l.comment = (pipe == nullptr || pipe < colon) ? nullptr : pipe + 1;
+    l.end = eol;
+
+    // 地址
+    const char* a = line;
+    const char* aEnd = colon;
+    while (a < aEnd && isBlank(*a)) a++;
+    while (aEnd > a && isBlank(aEnd[-1])) aEnd--;
+    if (a == aEnd || !parseAddr(a, aEnd, l.addr)) return false;
+
+    // hex 字节区域
+    const char* h = colon + 1;
+    while (h < hexEnd && isBlank(*h)) h++;
+    while (hexEnd > h && isBlank(hexEnd[-1])) hexEnd--;
+    l.hex = h;
+    l.hexEnd = hexEnd;
+    return true;
+}
+
+// 对 [text, text + size) 的每一行调用 f(line, eol)，f 返回 false 时停止
+template<typename F>
+static void forEachLine(const char* text, size_t size, F f){
+    const char* end = text + size;
+    for (const char* line = text; line < end; ){
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (eol == nullptr) eol = end;
+        if (!f(line, eol)) return;
+        line = eol + 1;
+    }
+}
+
+bool Loader::load(const char* text, size_t size, Memory& mem, Image* info){
+    if (isImage(text, size)) return loadImage(text, size, mem, info);
+    if (info) *info = Image();
+
     // 初始化
     mem.reset();
-    std::stringstream ss(content);
-    // main会将 .yo 读入为 string类型的 content， 然后 load 再将 string 转化为 cin
-    // 便于单元测试（可自定义content），并实现IO层与解析层（Loader）的分离，是最佳实践
-    std::string line;
 
-    while (std::getline(ss, line)){
-        // 找冒号（分割地址）
-        size_t colonPos = line.find(':');
-        if (colonPos == std::string::npos) continue; // 若无冒号则跳过该行
+    bool ok = true;
+    forEachLine(text, size, [&](const char* line, const char* eol){
+        YoLine l;
+        if (!splitLine(line, eol, l)) return true;  // 跳过该行
+
+        // 每两个字符解析一个字节，攒满一块再整块写入
+        addr_t addr = l.addr;
+        byte_t buf[64];
+        size_t n = 0;
+        auto flush = [&](){
+            if (n == 0) return true;
+            if (mem.writeBlock(addr, buf, n)){
+                // 越界：与逐字节写入一致，先写入越界之前的字节
+                for (size_t i = 0; i < n && !mem.writeByte(addr + i, buf[i]); i++) {}
+                return false;
+            }
+            addr += n;
+            n = 0;
+            return true;
+        };
+        for (const char* h = l.hex; h < l.hexEnd; h += 2){
+            if (!parseByte(h, h + 2 < l.hexEnd ? h + 2 : l.hexEnd, buf[n])) break;  // 无法识别时放弃该行剩余部分
+            if (++n == sizeof(buf) && !flush()) return ok = false;
+        }
+        if (!flush()) return ok = false;
+        return true;
+    });
+
+    if (ok && info) info->symbols = scanSymbols(text, size);
+    return ok;
+}
+
+std::vector<std::pair<addr_t, std::string>> Loader::scanSymbols(const char* text, size_t size){
+    std::vector<std::pair<addr_t, std::string>> symbols;
+    auto isIdent = [](char c, bool first){
+        return c == '_' || c == '.' || static_cast<unsigned>((c | 0x20) - 'a') < 26 || (!first && c >= '0' && c <= '9');
+    };
+
+    forEachLine(text, size, [&](const char* line, const char* eol){
+        YoLine l;
+        if (!splitLine(line, eol, l) || l.comment == nullptr) return true;
 
-        // 找竖线（截掉注释），得到结束位置
-        size_t pipePos = line.find('|');
-        size_t endPos = (pipePos == std::string::npos ? line.size() : pipePos);
+        const char* p = l.comment;
+        while (p < l.end && isBlank(*p)) p++;
+        const char* name = p;
+        while (p < l.end && isIdent(*p, p == name)) p++;
+        if (p > name && p < l.end && *p == ':') symbols.push_back({l.addr, std::string(name, p)});
+        return true;
+    });
+    return symbols;
+}
 
-        // 提取地址字符串并转换为 uint64_t
-        std::string addrStr = trim(line.substr(0, colonPos));
-        if (addrStr.empty()) continue;
+std::vector<SourceLine> Loader::scanListing(const char* text, size_t size){
+    std::vector<SourceLine> listing;
+    int number = 0;
+    forEachLine(text, size, [&](const char* line, const char* eol){
+        number++;
+        YoLine l;
+        if (!splitLine(line, eol, l) || l.hex == l.hexEnd) return true;
 
-        addr_t addr;
-        try{
-            addr = std::stoull(addrStr, nullptr, 16);
+        SourceLine s;
+        s.addr = l.addr;
+        s.line = number;
+        s.bytes = static_cast<int>((l.hexEnd - l.hex + 1) / 2);
+        if (l.comment != nullptr){
+            const char* b = l.comment;
+            const char* e = l.end;
+            while (b < e && isSpace(*b)) b++;
+            while (e > b && isSpace(e[-1])) e--;
+            s.source.assign(b, e);
         }
-        catch(...) { continue; }
-
-        // 提出 hex 字节区域
-        std::string hexStr = trim(line.substr(colonPos+1, endPos-colonPos-1));
-        if (hexStr.empty()) continue;
-
-        bool invalidVal = 0;  // 记录 地址/Hex字节区域 是否合法
-        // 每两个字符解析一个字节，转化为 uint8_t
-        for (size_t i=0; i<hexStr.size(); i+=2){
-            std::string byteHex = hexStr.substr(i, 2);  // string类型 byteHex
-            try{
-                byte_t byteVal = static_cast<uint8_t>(std::stoi(byteHex, nullptr, 16)); // string >> int >> uint8_t
-                if (mem.writeByte(addr++, byteVal)) return false;
-            }
-            catch(...) {
-                invalidVal = 1;
-                break;   // 若无法识别 byteVal， 直接 break 跳出 for 循环，进入下一行的 while 循环
-            }
+        listing.push_back(std::move(s));
+        return true;
+    });
+    return listing;
+}
+
+static const char YBO_MAGIC[8] = {'Y', '8', '6', 'Y', 'B', 'O', 0, 0};
+static const uint32_t YBO_VERSION = 1;
+static const size_t YBO_HEADER = 32;
+
+template<typename T>
+static void put(std::string& out, T v){
+    char b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));  // 按宿主字节序（小端）
+    out.append(b, sizeof(T));
+}
+
+template<typename T>
+static bool get(const char* data, size_t size, size_t& pos, T& v){
+    if (pos > size || size - pos < sizeof(T)) return false;
+    std::memcpy(&v, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+bool Loader::isImage(const char* data, size_t size){
+    return size >= YBO_HEADER && std::memcmp(data, YBO_MAGIC, 8) == 0;
+}
+
+std::string Loader::buildImage(const Memory& mem, const Image& info){
+    // 内存初始为 0，只需保存非零字节段（相隔不超过 16 字节的段合并）
+    std::vector<std::pair<addr_t, addr_t>> segs;
+    mem.forEachLiveWord([&](addr_t w, word_t val){
+        for (int i = 0; i < 8; i++){
+            if ((static_cast<uint64_t>(val) >> (8 * i) & 0xFF) == 0) continue;
+            addr_t a = w + i;
+            if (!segs.empty() && a - segs.back().second <= 16) segs.back().second = a + 1;
+            else segs.push_back({a, a + 1});
         }
+    });
+
+    std::string out(YBO_MAGIC, 8);
+    put<uint32_t>(out, YBO_VERSION);
+    put<uint32_t>(out, segs.size());
+    put<uint64_t>(out, info.entry);
+    put<uint32_t>(out, info.symbols.size());
+    put<uint32_t>(out, 0);
 
-        if (invalidVal == 1) continue;
+    size_t symBytes = 0;
+    for (const auto& sym : info.symbols) symBytes += 12 + sym.second.size();
+    uint64_t offset = YBO_HEADER + segs.size() * 24 + symBytes;
+    for (const auto& seg : segs){
+        put<uint64_t>(out, seg.first);
+        put<uint64_t>(out, seg.second - seg.first);
+        put<uint64_t>(out, offset);
+        offset += seg.second - seg.first;
+    }
+    for (const auto& sym : info.symbols){
+        put<uint64_t>(out, sym.first);
+        put<uint32_t>(out, sym.second.size());
+        out += sym.second;
+    }
+    for (const auto& seg : segs){
+        size_t at = out.size();
+        out.resize(at + (seg.second - seg.first));
+        mem.readBlock(seg.first, reinterpret_cast<byte_t*>(&out[at]), seg.second - seg.first);
     }
+    return out;
+}
+
+bool Loader::loadImage(const char* data, size_t size, Memory& mem, Image* info){
+    mem.reset();
 
+    size_t pos = 8;
+    uint32_t version, nsegs, nsyms, reserved;
+    uint64_t entry;
+    if (!get(data, size, pos, version) || !get(data, size, pos, nsegs) || !get(data, size, pos, entry) ||
+        !get(data, size, pos, nsyms) || !get(data, size, pos, reserved) || version != YBO_VERSION)
+        return false;
+
+    // 段数据按段表整块复制，段越界或超出文件时与写入越界一样返回 false
+    for (uint32_t i = 0; i < nsegs; i++){
+        uint64_t addr, len, offset;
+        if (!get(data, size, pos, addr) || !get(data, size, pos, len) || !get(data, size, pos, offset))
+            return false;
+        if (offset > size || len > size - offset) return false;
+        if (mem.writeBlock(addr, reinterpret_cast<const byte_t*>(data + offset), len)) return false;
+    }
+
+    if (info){
+        *info = Image();
+        info->entry = entry;
+        for (uint32_t i = 0; i < nsyms; i++){
+            uint64_t addr;
+            uint32_t len;
+            if (!get(data, size, pos, addr) || !get(data, size, pos, len) || len > size - pos) return false;
+            info->symbols.push_back({addr, std::string(data + pos, len)});
+            pos += len;
+        }
+    }
     return true;
-}
\ No newline at end of file
+}
+
+bool Loader::loadFd(int fd, Memory& mem, Image* info){
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED){
+            bool ok = load(static_cast<const char*>(p), st.st_size, mem, info);
+            munmap(p, st.st_size);
+            return ok;
+        }
+    }
+
+    // 管道 / 终端等无法映射的输入：一次性读入
+    std::string content;
+    char buf[1 << 16];
+    while (true){
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n == 0) break;
+        if (n < 0) return false;
+        content.append(buf, n);
+    }
+    return load(content.data(), content.size(), mem, info);
+}
+
+bool Loader::loadFile(const std::string& path, Memory& mem, Image* info){
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = loadFd(fd, mem, info);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,365 @@
+// 行上的向量运算：一次处理 4 个 lane 的 64 位量（GCC / Clang 向量扩展）
+// x86-64 上每个核心函数同时编译出 AVX2 与基础（SSE2）两个版本，运行时按 CPU 选择：
+// AVX2 下一条 ymm 指令处理 4 个 lane，SSE2 下拆为两条 xmm 指令；其他平台按各自的向量指令或标量展开
+// 向量只在本文件中传递，辅助函数与 cpu.h 中的 ISA 模板都始终内联，不经过函数调用约定（Makefile 中关闭 -Wpsabi）
+#include <algorithm>
+#include <cstring>
+#include "../include/lockstep.h"
+#include "../include/loader.h"
+
+typedef word_t Vec __attribute__((vector_size(32)));
+typedef uint64_t UVec __attribute__((vector_size(32)));
+static const size_t W = sizeof(Vec) / sizeof(word_t);
+
+template<>
+struct ISA::UnsignedOf<Vec> { using type = UVec; };
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define LANE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define LANE_KERNEL
+#endif
+
+static ISA_INLINE Vec ld(const word_t* p) {
+    Vec v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static ISA_INLINE void st(word_t* p, Vec v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// 掩码为全 1 的 lane 取 a，其余取 b
+static ISA_INLINE Vec pick(Vec m, Vec a, Vec b) {
+    return (a & m) | (b & ~m);
+}
+
+// 供 ISA::cond 读取的一组 lane 的条件码
+struct VecFlags {
+    Vec z, s, o;
+    ISA_INLINE Vec zf() const { return z; }
+    ISA_INLINE Vec sf() const { return s; }
+    ISA_INLINE Vec of() const { return o; }
+};
+
+// 可分组执行的 lane（AOK、有预算、代码共享）中最小的 PC 及该 PC 上的 lane 掩码，返回组内 lane 数
+static LANE_KERNEL size_t selectGroup(const word_t* pc, const word_t* stat, const word_t* budget, const word_t* shared,
+                                      word_t* mask, size_t n, addr_t& target) {
+    const Vec ones = Vec{} - 1;  // 全 1，同时也是最大的无符号地址
+    Vec lo = ones;
+    for (size_t i = 0; i < n; i += W) {
+        Vec run = (ld(stat + i) == static_cast<word_t>(Stat::AOK)) & (ld(budget + i) > 0) & ld(shared + i);
+        st(mask + i, run);
+        Vec p = pick(run, ld(pc + i), ones);
+        lo = pick((Vec)((UVec)p < (UVec)lo), p, lo);
+    }
+    addr_t best = ~addr_t(0);
+    for (size_t k = 0; k < W; k++) best = std::min<addr_t>(best, lo[k]);
+    target = best;
+
+    Vec count = Vec{};
+    for (size_t i = 0; i < n; i += W) {
+        Vec m = ld(mask + i) & (ld(pc + i) == static_cast<word_t>(best));
+        st(mask + i, m);
+        count -= m;
+    }
+    size_t total = 0;
+    for (size_t k = 0; k < W; k++) total += count[k];
+    return total;
+}
+
+// 计步：组内 lane 的 steps 加 1、budget 减 1，返回组内 lane 数
+static LANE_KERNEL size_t countStep(const word_t* mask, word_t* steps, word_t* budget, size_t n) {
+    Vec count = Vec{};
+    for (size_t i = 0; i < n; i += W) {
+        Vec m = ld(mask + i);
+        st(steps + i, ld(steps + i) - m);
+        st(budget + i, ld(budget + i) + m);
+        count -= m;
+    }
+    size_t total = 0;
+    for (size_t k = 0; k < W; k++) total += count[k];
+    return total;
+}
+
+// halt：状态改为 HLT，PC 不变
+static LANE_KERNEL void execHalt(const word_t* mask, word_t* stat, size_t n) {
+    const Vec hlt = Vec{} + static_cast<word_t>(Stat::HLT);
+    for (size_t i = 0; i < n; i += W) st(stat + i, pick(ld(mask + i), hlt, ld(stat + i)));
+}
+
+// nop / irmovq / rrmovq / cmovXX：条件成立时 dst = src（src 为空时取立即数 valC），PC = valP
+static LANE_KERNEL void execMove(const word_t* mask, int fn, const word_t* flags[3], const word_t* src, word_t valC,
+                                 word_t* dst, word_t valP, word_t* pc, size_t n) {
+    for (size_t i = 0; i < n; i += W) {
+        Vec m = ld(mask + i);
+        VecFlags f{ld(flags[0] + i), ld(flags[1] + i), ld(flags[2] + i)};
+        Vec c = m & ISA::cond(fn, f);
+        Vec v = src ? ld(src + i) : Vec{} + valC;
+        st(dst + i, pick(c, v, ld(dst + i)));
+        st(pc + i, pick(m, Vec{} + valP, ld(pc + i)));
+    }
+}
+
+// OPq：dst = b OP a，设置条件码，PC = valP（a / b / dst 可以是同一行）
+static LANE_KERNEL void execOpq(const word_t* mask, ALU::Op op, const word_t* a, const word_t* b, word_t* dst,
+                                word_t* flags[3], word_t valP, word_t* pc, size_t n) {
+    for (size_t i = 0; i < n; i += W) {
+        Vec m = ld(mask + i);
+        Vec va = ld(a + i), vb = ld(b + i);
+        Vec e = ISA::alu(op, va, vb);
+        st(dst + i, pick(m, e, ld(dst + i)));
+        st(flags[0] + i, pick(m, e == 0, ld(flags[0] + i)));
+        st(flags[1] + i, pick(m, e < 0, ld(flags[1] + i)));
+        st(flags[2] + i, pick(m, ISA::overflow(op, va, vb, e), ld(flags[2] + i)));
+        st(pc + i, pick(m, Vec{} + valP, ld(pc + i)));
+    }
+}
+
+// jXX：条件成立时 PC = valC，否则 PC = valP
+static LANE_KERNEL void execJump(const word_t* mask, int fn, const word_t* flags[3], word_t valC, word_t valP,
+                                 word_t* pc, size_t n) {
+    for (size_t i = 0; i < n; i += W) {
+        Vec m = ld(mask + i);
+        VecFlags f{ld(flags[0] + i), ld(flags[1] + i), ld(flags[2] + i)};
+        Vec next = pick(ISA::cond(fn, f), Vec{} + valC, Vec{} + valP);
+        st(pc + i, pick(m, next, ld(pc + i)));
+    }
+}
+
+static size_t roundLanes(size_t n) {
+    return (std::max<size_t>(n, 1) + W - 1) / W * W;
+}
+
+LockstepCPU::LockstepCPU(size_t lanes, addr_t memSize)
+    : lanes(lanes), stride(roundLanes(lanes)), scalar(lanes), lastPC(lanes, NO_LAST), lastInst(lanes),
+      regs(17 * stride, 0), pc(stride, 0), zf(stride, -1), sf(stride, 0), of(stride, 0),
+      stat(stride, static_cast<word_t>(Stat::HLT)), budget(stride, 0), stepCount(stride, 0), shared(stride, 0),
+      mask(stride, 0), epochs(lanes, 0) {
+    for (size_t i = 0; i < lanes; i++) mems.emplace_back(new Memory(memSize));
+}
+
+LockstepCPU::~LockstepCPU() = default;
+
+bool LockstepCPU::load(const char* text, size_t size) {
+    Image image;
+    bool ok = true;
+    for (size_t i = 0; i < lanes; i++) ok = Loader::load(text, size, *mems[i], &image) && ok;
+
+    // 与 CPU::reset 相同的初始状态（条件码 ZF = 1）
+    std::fill(regs.begin(), regs.end(), 0);
+    std::fill(zf.begin(), zf.end(), -1);
+    std::fill(sf.begin(), sf.end(), 0);
+    std::fill(of.begin(), of.end(), 0);
+    std::fill(stepCount.begin(), stepCount.end(), 0);
+    for (size_t i = 0; i < lanes; i++) {
+        pc[i] = image.entry;
+        stat[i] = static_cast<word_t>(Stat::AOK);
+        shared[i] = -1;
+        epochs[i] = mems[i]->codeEpoch;
+        scalar[i].reset();
+        lastPC[i] = NO_LAST;
+    }
+    soloLanes = 0;
+    decoded.clear();
+    groupCount = scalarCount = 0;
+    return ok;
+}
+
+void LockstepCPU::copyTo(size_t lane, CPU& cpu) const {
+    for (int r = 0; r < Reg::NONE; r++) cpu.reg.setReg(static_cast<Reg::ID>(r), regs[r * stride + lane]);
+    cpu.cc.set(zf[lane] != 0, sf[lane] != 0, of[lane] != 0);
+    cpu.PC = pc[lane];
+    cpu.stat = static_cast<Stat>(stat[lane]);
+}
+
+uint64_t LockstepCPU::run(uint64_t maxSteps) {
+    word_t limit = static_cast<word_t>(std::min<uint64_t>(maxSteps, INT64_MAX));
+    std::fill(budget.begin(), budget.begin() + lanes, limit);
+    for (size_t i = 0; i < lanes; i++) checkCode(i);  // 两次 run 之间可能通过 memory() 改写了代码
+
+    uint64_t total = 0;
+    while (true) {
+        // 代码已与其他 lane 不同的 lane 逐个按标量执行一步
+        size_t solo = 0;
+        for (size_t i = 0; soloLanes > 0 && i < lanes; i++) {
+            if (shared[i] || stat[i] != static_cast<word_t>(Stat::AOK) || budget[i] <= 0) continue;
+            stepScalar(i);
+            stepCount[i]++;
+            budget[i]--;
+            solo++;
+        }
+
+        addr_t target;
+        size_t n = selectGroup(pc.data(), stat.data(), budget.data(), shared.data(), mask.data(), stride, target);
+        if (n == 0 && solo == 0) break;
+        if (n > 0) {
+            execGroup(target);  // 译码时可能有 lane 退出本组，实际执行的 lane 以 mask 为准
+            n = countStep(mask.data(), stepCount.data(), budget.data(), stride);
+            groupCount++;
+        }
+        total += n + solo;
+    }
+    return total;
+}
+
+// 取得 target 处的指令；无法分组执行（取指越界、不能标记为代码的地址）时返回 nullptr
+const DecodedInst* LockstepCPU::decode(addr_t target) {
+    const DecodedInst* cached = decoded.lookup(target);
+    if (cached != nullptr) return cached;
+
+    size_t first = std::find_if(mask.begin(), mask.begin() + lanes, [](word_t m) { return m != 0; }) - mask.begin();
+    Memory& rep = *mems[first];
+    DecodedInst d;
+    if (!CPU::predecode(rep, target, d) || !rep.markCode(target, d.len)) return nullptr;
+
+    // 所有共享 lane 在这里的字节必须相同：不同的 lane 退出分组；相同的标记为代码，此后改写会使 codeEpoch 变化
+    byte_t bytes[ICache::MAX_INST_LEN];
+    rep.readBlock(target, bytes, d.len);
+    for (size_t i = 0; i < lanes; i++) {
+        if (!shared[i] || i == first) continue;
+        if (mems[i]->equalBlock(target, bytes, d.len)) mems[i]->markCode(target, d.len);
+        else {
+            makeSolo(i);
+            mask[i] = 0;
+        }
+    }
+    decoded.insert(d);
+    return decoded.lookup(target);
+}
+
+void LockstepCPU::execGroup(addr_t target) {
+    const DecodedInst* d = decode(target);
+
+    // 少见的情况交给标量 CPU：取指失败、非法指令、非法的运算 / 条件（保留 CPU 的报错行为）
+    bool simple = d != nullptr && d->icode <= ICode::POPQ;
+    if (simple && d->icode == ICode::OPQ) simple = d->ifunc <= ALU::XOR;
+    if (simple && (d->icode == ICode::RRMOVQ || d->icode == ICode::JXX)) simple = d->ifunc <= Cond::G;
+    if (!simple) {
+        for (size_t i = 0; i < lanes; i++)
+            if (mask[i]) stepScalar(i);
+        return;
+    }
+
+    for (size_t i = 0; i < lanes; i++)
+        if (mask[i]) lastPC[i] = target;
+
+    word_t* flags[3] = {zf.data(), sf.data(), of.data()};
+    const word_t* cflags[3] = {zf.data(), sf.data(), of.data()};
+    switch (d->icode) {
+        case ICode::HALT:
+            execHalt(mask.data(), stat.data(), stride);
+            break;
+        case ICode::NOP:
+            execMove(mask.data(), Cond::None, cflags, nullptr, 0, dst(Reg::NONE), d->valP, pc.data(), stride);
+            break;
+        case ICode::RRMOVQ:
+            execMove(mask.data(), d->ifunc, cflags, row(d->rA), 0, dst(d->rB), d->valP, pc.data(), stride);
+            break;
+        case ICode::IRMOVQ:
+            execMove(mask.data(), Cond::None, cflags, nullptr, d->valC, dst(d->rB), d->valP, pc.data(), stride);
+            break;
+        case ICode::OPQ:
+            execOpq(mask.data(), static_cast<ALU::Op>(d->ifunc), row(d->rA), row(d->rB), dst(d->rB), flags, d->valP,
+                    pc.data(), stride);
+            break;
+        case ICode::JXX:
+            execJump(mask.data(), d->ifunc, cflags, d->valC, d->valP, pc.data(), stride);
+            break;
+        default:
+            execMemory(*d);
+            break;
+    }
+}
+
+// 访存指令按 lane 逐个执行，语义与 BasicCPU 的 THREADED handler 相同（出错时 PC 不变，寄存器照常写回）
+void LockstepCPU::execMemory(const DecodedInst& d) {
+    word_t* rsp = row(Reg::RSP);
+    const word_t* ra = row(d.rA);
+    word_t* rb = row(d.rB);
+    bool writes = d.icode == ICode::RMMOVQ || d.icode == ICode::CALL || d.icode == ICode::PUSHQ;
+
+    for (size_t i = 0; i < lanes; i++) {
+        if (!mask[i]) continue;
+        Memory& mem = *mems[i];
+        bool error = false;
+        addr_t next = d.valP;
+
+        switch (d.icode) {
+            case ICode::RMMOVQ:
+                error = mem.writeWord(d.valC + rb[i], ra[i]);
+                break;
+            case ICode::MRMOVQ: {
+                word_t val = mem.readWord(d.valC + rb[i], error);
+                dst(d.rA)[i] = val;
+                break;
+            }
+            case ICode::CALL:
+                error = mem.writeWord(rsp[i] - 8, d.valP);
+                rsp[i] -= 8;
+                next = d.valC;
+                break;
+            case ICode::RET: {
+                word_t ret = mem.readWord(rsp[i], error);
+                rsp[i] += 8;
+                next = ret;
+                break;
+            }
+            case ICode::PUSHQ: {
+                word_t val = ra[i];  // pushq %rsp 压入的是原来的值
+                error = mem.writeWord(rsp[i] - 8, val);
+                rsp[i] -= 8;
+                break;
+            }
+            case ICode::POPQ: {
+                word_t val = mem.readWord(rsp[i], error);
+                rsp[i] += 8;
+                dst(d.rA)[i] = val;  // popq %rsp 时以读出的值为准
+                break;
+            }
+        }
+
+        if (error) stat[i] = static_cast<word_t>(Stat::ADR);
+        else pc[i] = next;
+        if (writes) checkCode(i);
+    }
+}
+
+// 用该 lane 的标量 CPU 执行一条指令
+void LockstepCPU::stepScalar(size_t lane) {
+    if (!scalar[lane]) {
+        scalar[lane].reset(new CPU(*mems[lane]));
+        scalar[lane]->engine = Engine::THREADED;
+    }
+    CPU& cpu = *scalar[lane];
+    copyTo(lane, cpu);
+    if (lastPC[lane] != NO_LAST) {
+        lastInst[lane] = DecodedInst();  // 只有 pc，回退到 SEQ 流程时重新解码
+        lastInst[lane].pc = lastPC[lane];
+        cpu.last = &lastInst[lane];
+        lastPC[lane] = NO_LAST;
+    }
+    cpu.step();
+
+    for (int r = 0; r < Reg::NONE; r++) regs[r * stride + lane] = cpu.reg.getReg(static_cast<Reg::ID>(r));
+    zf[lane] = -word_t(cpu.cc.zf());
+    sf[lane] = -word_t(cpu.cc.sf());
+    of[lane] = -word_t(cpu.cc.of());
+    pc[lane] = cpu.PC;
+    stat[lane] = static_cast<word_t>(cpu.stat);
+    scalarCount++;
+    checkCode(lane);
+}
+
+// 改写了已译码的代码的 lane 不再参与分组
+void LockstepCPU::checkCode(size_t lane) {
+    if (mems[lane]->codeEpoch == epochs[lane]) return;
+    epochs[lane] = mems[lane]->codeEpoch;
+    if (shared[lane]) makeSolo(lane);
+}
+
+void LockstepCPU::makeSolo(size_t lane) {
+    shared[lane] = 0;
+    soloLanes++;
+}
@@ -1,62 +1,259 @@
+#include <csignal>
+#include <fstream>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
 #include <vector>
 #include <string>
-#include <iterator>
+#include <unistd.h>
 #include "../include/global.h"
 #include "../include/register.h"
 #include "../include/memory.h"
 #include "../include/loader.h"
 #include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/batch.h"
+#include "../include/daemon.h"
+#include "../include/run_budget.h"
+#include "../include/stats.h"
+#include "../include/profile.h"
+
+// 常驻模式收到 SIGINT / SIGTERM 时退出事件循环，析构时删除套接字文件
+static Daemon* serving = nullptr;
+static void stopServing(int) { if (serving) serving->stop(); }
 
-void printStateJSON(const CPU& cpu, int steps) {
-    if (steps != 1) {
-        std::cout << "," << std::endl;
+int main(int argc, char* argv[]) {
+    Engine engine = Engine::SEQ;
+    bool delta = false;     // --trace delta：增量输出
+    bool binary = false;    // --trace binary：二进制 trace 写到标准输出，用 y86-trace 查看
+    int keyframe = 0;       // --keyframe N：每 N 步插入一个关键帧
+    bool sync = false;      // --sync：完整 trace 在模拟线程中逐步打印，而不是交给写线程
+    addr_t memSize = Memory::MAX_SIZE;  // --mem-size N：客户地址空间大小（字节，可写 0x 前缀）
+    std::string batchDir;   // --batch DIR：在进程内并行运行 DIR 下的全部程序，输出每个程序的结果与汇总耗时
+    std::string outDir;     // --out DIR：批量运行时把每个程序的完整 trace 写到 DIR/<程序名>.json
+    unsigned jobs = 0;      // --jobs N：批量运行的线程数，默认为硬件线程数
+    uint64_t slice = BatchOptions().slice;  // --slice N：批量运行时每片执行的指令数，0 表示不分片
+    std::string servePath;  // --serve PATH：常驻模式，在 Unix 域套接字 PATH 上接受请求（协议见 daemon.h）
+    bool runMode = false;   // --run：不输出逐步 trace，运行到停止后只输出终态与汇总（run_budget.h）
+    RunBudget budget;       // --max-steps N / --timeout SEC：运行模式的指令预算与墙钟期限，隐含 --run
+    bool stats = false;     // --stats：运行模式的汇总中加入执行统计（stats.h），隐含 --run
+    std::string profilePath;  // --profile FILE：按 PC 计数，把热点报告写到 FILE（profile.h），隐含 --run
+    bool annotate = false;  // --annotate：热点报告之后附上带执行次数的原 .yo 清单
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--engine" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "seq") engine = Engine::SEQ;
+            else if (name == "threaded") engine = Engine::THREADED;
+            else if (name == "jit") engine = Engine::JIT;
+            else {
+                std::cerr << "unknown engine: " << name << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "full") delta = binary = false;
+            else if (mode == "delta") { delta = true; binary = false; }
+            else if (mode == "binary") { binary = true; delta = false; }
+            else {
+                std::cerr << "unknown trace mode: " << mode << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--keyframe" && i + 1 < argc) {
+            keyframe = std::atoi(argv[++i]);
+        }
+        else if (arg == "--sync") {
+            sync = true;
+        }
+        else if (arg == "--batch" && i + 1 < argc) {
+            batchDir = argv[++i];
+        }
+        else if (arg == "--out" && i + 1 < argc) {
+            outDir = argv[++i];
+        }
+        else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::atoi(argv[++i]);
+        }
+        else if (arg == "--slice" && i + 1 < argc) {
+            slice = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (arg == "--serve" && i + 1 < argc) {
+            servePath = argv[++i];
+        }
+        else if (arg == "--run") {
+            runMode = true;
+        }
+        else if (arg == "--stats") {
+            stats = runMode = true;
+        }
+        else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+            runMode = true;
+        }
+        else if (arg == "--annotate") {
+            annotate = true;
+        }
+        else if (arg == "--max-steps" && i + 1 < argc) {
+            char* end;
+            budget.maxSteps = std::strtoull(argv[++i], &end, 0);
+            if (*end != '\0') {
+                std::cerr << "invalid step budget: " << argv[i] << std::endl;
+                return 1;
+            }
+            runMode = true;
+        }
+        else if (arg == "--timeout" && i + 1 < argc) {
+            char* end;
+            budget.seconds = std::strtod(argv[++i], &end);
+            if (*end != '\0' || budget.seconds <= 0) {
+                std::cerr << "invalid timeout: " << argv[i] << std::endl;
+                return 1;
+            }
+            runMode = true;
+        }
+        else if (arg == "--mem-size" && i + 1 < argc) {
+            char* end;
+            memSize = std::strtoull(argv[++i], &end, 0);
+            if (*end != '\0' || memSize == 0) {
+                std::cerr << "invalid memory size: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else {
+            std::cerr << "usage: " << argv[0] << " [--engine seq|threaded|jit] [--trace full|delta|binary] [--keyframe N] [--sync] [--mem-size N] < program.yo\n"
+                      << "       " << argv[0] << " --run [--max-steps N] [--timeout SEC] [--stats | --profile FILE [--annotate]] [--engine ...] [--mem-size N] < program.yo\n"
+                      << "       " << argv[0] << " --batch DIR [--out DIR] [--jobs N] [--slice N] [--engine ...] [--mem-size N]\n"
+                      << "       " << argv[0] << " --serve SOCKET [--engine ...] [--mem-size N]" << std::endl;
+            return 1;
+        }
     }
 
-    std::cout << "  {" << std::endl;
-    std::cout << "    \"PC\": " << cpu.PC << "," << std::endl;
-    std::cout << "    \"STAT\": " << (int)cpu.stat << "," << std::endl;
-    
-    std::cout << "    \"REG\": {";
-    const char* regNames[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", 
-                              "r8", "r9", "r10", "r11", "r12", "r13", "r14", "none"};
-    for (int i = 0; i < 15; i++) { 
-        std::cout << "\"" << regNames[i] << "\": " << cpu.reg.getReg(static_cast<Reg::ID>(i));
-        if (i < 14) std::cout << ", ";
+    if (stats && !profilePath.empty()) {
+        std::cerr << "--stats and --profile cannot be combined" << std::endl;
+        return 1;
+    }
+    if (annotate && profilePath.empty()) {
+        std::cerr << "--annotate requires --profile FILE" << std::endl;
+        return 1;
     }
-    std::cout << "}," << std::endl;
 
-    std::cout << "    \"CC\": {"
-              << "\"ZF\": " << (cpu.cc.zf ? 1 : 0) << ", "
-              << "\"SF\": " << (cpu.cc.sf ? 1 : 0) << ", "
-              << "\"OF\": " << (cpu.cc.of ? 1 : 0)
-              << "}," << std::endl;
+    if (!servePath.empty()) {
+        DaemonOptions options;
+        options.engine = engine;
+        options.memSize = memSize;
+        Daemon daemon(options);
+        if (!daemon.listen(servePath)) {
+            std::cerr << "cannot listen on " << servePath << std::endl;
+            return 1;
+        }
+        serving = &daemon;
+        std::signal(SIGINT, stopServing);
+        std::signal(SIGTERM, stopServing);
+        daemon.serve();
+        serving = nullptr;
+        return 0;
+    }
 
-    std::cout << "    \"MEM\": {";
-    bool firstMem = true;
-    for (int i = 0; i < Memory::MAX_SIZE; i += 8) {
-        bool error;
-        word_t val = cpu.mem.readWord(i, error);
-        if (!error && val != 0) {
-            if (!firstMem) std::cout << ", ";
-            std::cout << "\"" << i << "\": " << val;
-            firstMem = false;
+    if (!batchDir.empty()) {
+        BatchOptions options;
+        options.engine = engine;
+        options.threads = jobs;
+        options.slice = slice;
+        options.memSize = memSize;
+        options.outDir = outDir;
+        BatchRunner runner(options);
+        if (!runner.addDir(batchDir)) {
+            std::cerr << "cannot open directory: " << batchDir << std::endl;
+            return 1;
         }
+        runner.run();
+        runner.report(std::cout);
+        return 0;
     }
-    std::cout << "}" << std::endl;
 
-    std::cout << "  }";
-}
+    Memory mem(memSize);
+    CPU cpu(mem);
+    cpu.engine = engine;
 
-int main() {
-    std::cin >> std::noskipws;
-    std::string content((std::istreambuf_iterator<char>(std::cin)), 
-                         std::istreambuf_iterator<char>());
+    // 热点分析需要 .yo 原文中的注释列，整体读入后解析；其他情况直接从标准输入装入：
+    // 标准输入重定向自文件时直接 mmap 解析，不再整体读入 string；.ybo 镜像整块装入
+    Image image;
+    std::string text;
+    bool loaded;
+    if (!profilePath.empty()) {
+        text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        loaded = Loader::load(text.data(), text.size(), mem, &image);
+    }
+    else loaded = Loader::loadFd(STDIN_FILENO, mem, &image);
+    cpu.PC = image.entry;
 
-    Memory mem;
-    CPU cpu(mem);
+    if (runMode) {
+        if (!loaded) {
+            std::cerr << "cannot load program" << std::endl;
+            return 1;
+        }
+        // 标准输出只有汇总 JSON，诊断信息改到标准错误
+        std::string out;
+        if (stats) {
+            StatsCPU counted(mem);
+            counted.diag = &std::cerr;
+            counted.PC = cpu.PC;
+            counted.engine = engine == Engine::JIT ? Engine::THREADED : engine;
+            RunSummary summary = runToCompletion(counted, budget);
+            appendRunSummaryJSON(out, counted, summary);
+        }
+        else if (!profilePath.empty()) {
+            std::ofstream report(profilePath);
+            if (!report) {
+                std::cerr << "cannot write " << profilePath << std::endl;
+                return 1;
+            }
+            // .ybo 镜像没有清单，计数覆盖整个稠密区，报告中只有标号汇总
+            std::vector<SourceLine> listing;
+            if (!Loader::isImage(text.data(), text.size())) listing = Loader::scanListing(text.data(), text.size());
+            ProfileCPU counted(mem);
+            counted.diag = &std::cerr;
+            counted.PC = cpu.PC;
+            counted.engine = engine == Engine::JIT ? Engine::THREADED : engine;
+            counted.hooks.counts.assign(listing.empty() ? mem.denseSize() : Profile::codeEnd(listing, mem), 0);
+            RunSummary summary = runToCompletion(counted, budget);
+            appendRunSummaryJSON(out, counted, summary);
+
+            Profile profile(counted.hooks, std::move(listing), image.symbols);
+            profile.report(report);
+            if (annotate) {
+                report << "\n# listing\n";
+                profile.annotate(report, text.data(), text.size());
+            }
+        }
+        else {
+            cpu.diag = &std::cerr;
+            RunSummary summary = runToCompletion(cpu, budget);
+            appendRunSummaryJSON(out, cpu, summary);
+        }
+        std::cout << out;
+        return 0;
+    }
+
+    if (binary) {
+        // 加载失败时输出 0 步的 trace
+        BinaryTraceWriter writer(cpu, stdout, keyframe > 0 ? keyframe : BinaryTraceWriter::DEFAULT_KEYFRAME_INTERVAL);
+        int steps = 0;
+        if (loaded) {
+            while (cpu.stat == Stat::AOK && steps < 10000) {
+                cpu.step();
+                steps++;
+                writer.record(steps);
+            }
+        }
+        writer.finish();
+        return 0;
+    }
 
-    if (!Loader::load(content, mem)) {
+    if (!loaded) {
         std::cout << "[]" << std::endl; 
         return 0;
     }
@@ -64,10 +261,29 @@ int main() {
     std::cout << "[" << std::endl;
 
     int steps = 0;
-    while (cpu.stat == Stat::AOK && steps < 10000) {
-        cpu.step();
-        steps++;
-        printStateJSON(cpu, steps);
+    if (delta) {
+        DeltaTracer tracer(cpu, keyframe);
+        while (cpu.stat == Stat::AOK && steps < 10000) {
+            cpu.step();
+            steps++;
+            tracer.print(steps);
+        }
+    }
+    else if (sync) {
+        while (cpu.stat == Stat::AOK && steps < 10000) {
+            cpu.step();
+            steps++;
+            printStateJSON(cpu, steps);
+        }
+    }
+    else {
+        AsyncTraceWriter writer(cpu, stdout);
+        while (cpu.stat == Stat::AOK && steps < 10000) {
+            cpu.step();
+            steps++;
+            writer.record(steps);
+        }
+        writer.finish();
     }
 
     std::cout << "\n]" << std::endl;
@@ -1,57 +1,209 @@
 #include "../include/global.h"
 #include "../include/memory.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
-Memory::Memory() : data(MAX_SIZE, 0) {}
+static addr_t roundSize(addr_t size){
+    if (size < 8) return 8;
+    if (size > ~addr_t(7)) return ~addr_t(7);
+    return (size + 7) & ~addr_t(7);  // 按内存字对齐，保证位图中每个字都完整落在地址空间内
+}
+
+Memory::BasicMemory(addr_t size)
+    : data(std::min<addr_t>(roundSize(size), addr_t(DENSE_LIMIT)), 0), codeMap(data.size(), 0),
+      liveBits((data.size() / 8 + 63) / 64, 0), limit(roundSize(size)) {}
+
+void Memory::reset() {
+    std::fill(data.begin(), data.end(), 0);  // vector类没有.fill成员函数
+    std::fill(liveBits.begin(), liveBits.end(), 0);
+    tables.clear();  // 释放全部页
+    pages = 0;
+    lastPageNo = ~addr_t(0);
+    lastPage = nullptr;
+    clearCode();
+    codeEpoch++;
+}
+
+bool Memory::markCode(addr_t addr, addr_t len){
+    if (addr >= data.size() || len > data.size() - addr) return false;
+    std::fill(codeMap.begin() + addr, codeMap.begin() + addr + len, 1);
+    return true;
+}
 
-void Memory::reset() {std::fill(data.begin(), data.end(), 0);}  // vector类没有.fill成员函数
+Memory::Page* Memory::findPage(addr_t addr) const{
+    addr_t no = addr >> PAGE_BITS;
+    if (no == lastPageNo) return lastPage;  // 连续访问通常落在同一页
+    auto it = tables.find(no >> TABLE_BITS);
+    lastPageNo = no;
+    lastPage = it == tables.end() ? nullptr : (*it->second)[no & ((addr_t(1) << TABLE_BITS) - 1)].get();
+    return lastPage;
+}
+
+Memory::Page* Memory::touchPage(addr_t addr){
+    Page* page = findPage(addr);
+    if (page != nullptr) return page;
+
+    addr_t no = addr >> PAGE_BITS;
+    std::unique_ptr<Table>& table = tables[no >> TABLE_BITS];
+    if (!table) table.reset(new Table());
+    std::unique_ptr<Page>& slot = (*table)[no & ((addr_t(1) << TABLE_BITS) - 1)];
+    slot.reset(new Page());
+    pages++;
+    lastPage = slot.get();
+    return lastPage;
+}
+
+void Memory::writePagedByte(addr_t addr, byte_t val){
+    Page* page = val ? touchPage(addr) : findPage(addr);  // 向未分配的页写 0 不必分配
+    if (page != nullptr) page->bytes[addr & (PAGE_SIZE - 1)] = val;
+}
+
+byte_t Memory::readPagedByte(addr_t addr) const{
+    const Page* page = findPage(addr);
+    return page == nullptr ? 0 : page->bytes[addr & (PAGE_SIZE - 1)];
+}
+
+void Memory::updateLive(addr_t wordAddr){
+    if (wordAddr < data.size()){
+        updateDenseLive(wordAddr);
+        return;
+    }
+
+    Page* page = findPage(wordAddr);
+    if (page == nullptr) return;
+    addr_t offset = wordAddr & (PAGE_SIZE - 1);
+    addr_t slot = offset / 8;
+    if (WordIO::loadAligned(&page->bytes[offset])) page->live[slot / 64] |= uint64_t(1) << (slot % 64);
+    else page->live[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+}
+
+void Memory::rescanLive(){
+    for (addr_t a = 0; a < data.size(); a += 8) updateLive(a);  // 只有 data 会被绕过写接口改写
+}
+
+void Memory::clearCode(){
+    std::fill(codeMap.begin(), codeMap.end(), 0);
+    icache.clear();
+}
 
 bool Memory::writeByte(addr_t addr, byte_t val){
-    if (addr >= MAX_SIZE) {return true;} // Error: Out of Bounds
-    else {
+    if (addr >= limit) {return true;} // Error: Out of Bounds
+    else if (addr < data.size()) {
+        if (codeMap[addr]){
+            icache.invalidate(addr, 1);
+            codeEpoch++;
+        }
         data[addr] = val;
-        return false;
     }
+    else {
+        writePagedByte(addr, val);
+    }
+    updateLive(addr & ~addr_t(7));
+    if (writeLog) writeLog->push_back(addr & ~addr_t(7));
+    return false;
 }
 
 byte_t Memory::readByte(addr_t addr, bool& error) const{
-    if (addr >= MAX_SIZE) {
+    if (addr >= limit) {
         error = true;
         return 0;
     } // Error: Out of Bounds
     else {
         error = false;
-        return data[addr];
+        return addr < data.size() ? data[addr] : readPagedByte(addr);
     }
 }
 
-bool Memory::writeWord(addr_t addr, word_t val){
-    if (addr > MAX_SIZE - 8) {return true;}    // 不能写成 addr + 8 > MAX_SIZE, 存在上溢出风险！(0xFFFFFFFFFFFFFFF8 + 8 = 0 < MAX_SIZE)
-    else {
-        for (int i=0; i<8; i++){
-            data[addr + i] = val >> (8 * i) & 0xFF;
-            // 1个字节1个字节存储，小端序，所以每次要右移1个字节，即8位
+// 不在连续区内：越界，或者落在页上 / 跨越连续区与页的边界
+bool Memory::writeWordSlow(addr_t addr, word_t val){
+    if (addr > limit - 8) {return true;}    // 不能写成 addr + 8 > limit, 存在上溢出风险！(0xFFFFFFFFFFFFFFF8 + 8 = 0 < limit)
+    byte_t bytes[8];
+    WordIO::store(bytes, val);
+    return writeBlock(addr, bytes, 8);
+}
+
+bool Memory::writeBlock(addr_t addr, const byte_t* src, size_t len){
+    if (addr > limit || len > limit - addr) {return true;}  // 同样避免 addr + len 上溢出
+    if (len == 0) return false;
+
+    // 连续区部分
+    addr_t end = addr + len;
+    addr_t denseEnd = std::min<addr_t>(end, data.size());
+    if (addr < denseEnd){
+        for (addr_t a = addr; a < denseEnd; a++){
+            if (codeMap[a]){
+                icache.invalidate(addr, denseEnd - addr);
+                codeEpoch++;
+                break;
+            }
         }
-        return false;
+        std::memcpy(&data[addr], src, denseEnd - addr);
+    }
+
+    // 分页部分：逐页拷贝，整段为 0 且页未分配时跳过
+    for (addr_t a = std::max<addr_t>(addr, data.size()); a < end; ){
+        addr_t chunk = std::min<addr_t>(end - a, PAGE_SIZE - (a & (PAGE_SIZE - 1)));
+        const byte_t* p = src + (a - addr);
+        bool zero = std::all_of(p, p + chunk, [](byte_t b) { return b == 0; });
+        Page* page = zero ? findPage(a) : touchPage(a);
+        if (page != nullptr) std::memcpy(&page->bytes[a & (PAGE_SIZE - 1)], p, chunk);
+        a += chunk;
     }
+
+    for (addr_t w = addr & ~addr_t(7); w < end; w += 8){
+        updateLive(w);
+        if (writeLog) writeLog->push_back(w);
+    }
+    return false;
 }
 
-word_t Memory::readWord(addr_t addr, bool& error) const{
-    if (addr > MAX_SIZE - 8) {
+word_t Memory::readWordSlow(addr_t addr, bool& error) const{
+    if (addr > limit - 8) {
         error = true;
         return 0;
     }
-    else {
-        error = false;
-        word_t value = 0;
-        for (int i=0; i<8; i++){
-            value |= static_cast<uint64_t>(data[addr + i]) << (8 * i);
-            // 低地址取得低位，高地址取得高位，需要左移1个字节
-            // 需要将 data[addr + i] (uint8_t) 强制类型转换为 uint64_t
-            // 这牵扯到 C/C++ 的 整数提升规则 (Integral Promotion):
-            // 所有小于 int 的整数类型，参与运算时都会先提升为 int
-            // 因此如果左移位数超过32，未经过类型转换会出现问题
+    // 页上或跨越边界
+    error = false;
+    byte_t bytes[8];
+    readBlock(addr, bytes, 8);
+    return WordIO::load(bytes);
+}
+
+bool Memory::readBlock(addr_t addr, byte_t* dst, size_t len) const{
+    if (addr > limit || len > limit - addr) {return true;}
+
+    addr_t end = addr + len;
+    addr_t denseEnd = std::min<addr_t>(end, data.size());
+    if (addr < denseEnd) std::memcpy(dst, &data[addr], denseEnd - addr);
+
+    // 分页部分：未分配的页读出 0
+    for (addr_t a = std::max<addr_t>(addr, data.size()); a < end; ){
+        addr_t chunk = std::min<addr_t>(end - a, PAGE_SIZE - (a & (PAGE_SIZE - 1)));
+        const Page* page = findPage(a);
+        if (page != nullptr) std::memcpy(dst + (a - addr), &page->bytes[a & (PAGE_SIZE - 1)], chunk);
+        else std::memset(dst + (a - addr), 0, chunk);
+        a += chunk;
+    }
+    return false;
+}
+
+bool Memory::equalBlock(addr_t addr, const byte_t* src, size_t len) const{
+    if (addr > limit || len > limit - addr) return false;
+
+    addr_t end = addr + len;
+    addr_t denseEnd = std::min<addr_t>(end, data.size());
+    if (addr < denseEnd && std::memcmp(src, &data[addr], denseEnd - addr) != 0) return false;
+
+    for (addr_t a = std::max<addr_t>(addr, data.size()); a < end; ){
+        addr_t chunk = std::min<addr_t>(end - a, PAGE_SIZE - (a & (PAGE_SIZE - 1)));
+        const byte_t* p = src + (a - addr);
+        const Page* page = findPage(a);
+        if (page != nullptr){
+            if (std::memcmp(p, &page->bytes[a & (PAGE_SIZE - 1)], chunk) != 0) return false;
         }
-        return value;
+        else if (!std::all_of(p, p + chunk, [](byte_t b) { return b == 0; })) return false;
+        a += chunk;
     }
-}
\ No newline at end of file
+    return true;
+}
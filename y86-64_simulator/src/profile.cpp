@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "../include/cpu_impl.h"
+#include "../include/profile.h"
+
+// 热点分析实例（默认实例 CPU 在 src/cpu.cpp 中实例化）
+template class BasicCPU<Memory, ProfileHooks>;
+
+Profile::Profile(const ProfileHooks& hooks, std::vector<SourceLine> listing, const Symbols& symbols)
+    : hooks(hooks), listing(std::move(listing)), symbols(symbols) {
+    std::stable_sort(this->symbols.begin(), this->symbols.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    this->symbols.erase(std::unique(this->symbols.begin(), this->symbols.end(),
+                                    [](const auto& a, const auto& b) { return a.first == b.first; }),
+                        this->symbols.end());
+    for (uint64_t c : hooks.counts) total += c;
+    total += hooks.outside;
+}
+
+addr_t Profile::codeEnd(const std::vector<SourceLine>& listing, const Memory& mem) {
+    addr_t end = 0;
+    for (const SourceLine& l : listing) {
+        DecodedInst d;
+        if (ProfileCPU::predecode(mem, l.addr, d) && d.icode <= ICode::POPQ && d.len == l.bytes)
+            end = std::max(end, l.addr + l.bytes);
+    }
+    return end;
+}
+
+std::string Profile::where(addr_t pc) const {
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), pc,
+                               [](addr_t a, const auto& s) { return a < s.first; });
+    if (it == symbols.begin()) return std::string();
+    --it;
+    if (it->first == pc) return it->second;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "+0x%llx", static_cast<unsigned long long>(pc - it->first));
+    return it->second + buf;
+}
+
+void Profile::report(std::ostream& out, size_t top) const {
+    char buf[64];
+    auto percent = [&](uint64_t c) { return total ? 100.0 * c / total : 0.0; };
+
+    out << "# " << total << " instructions";
+    if (hooks.outside) out << ", " << hooks.outside << " outside the listing";
+    out << "\n";
+
+    // 按标号：[symbols[i], symbols[i + 1]) 内的计数之和
+    std::vector<std::pair<uint64_t, std::string>> regions;
+    addr_t first = symbols.empty() ? hooks.counts.size() : symbols[0].first;
+    uint64_t sum = 0;
+    for (addr_t a = 0; a < first && a < hooks.counts.size(); a++) sum += hooks.counts[a];
+    if (sum) regions.push_back({sum, "(no label)"});
+    for (size_t i = 0; i < symbols.size(); i++) {
+        addr_t end = i + 1 < symbols.size() ? symbols[i + 1].first : hooks.counts.size();
+        sum = 0;
+        for (addr_t a = symbols[i].first; a < end && a < hooks.counts.size(); a++) sum += hooks.counts[a];
+        if (sum) regions.push_back({sum, symbols[i].second});
+    }
+    std::stable_sort(regions.begin(), regions.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    out << "\n# by label\n" << "       count        %  label\n";
+    for (const auto& r : regions) {
+        snprintf(buf, sizeof(buf), "%12llu  %6.2f%%  ", static_cast<unsigned long long>(r.first), percent(r.first));
+        out << buf << r.second << "\n";
+    }
+
+    // 按指令：清单中的行，计数相同时按地址
+    std::vector<const SourceLine*> hot;
+    for (const SourceLine& l : listing)
+        if (count(l.addr)) hot.push_back(&l);
+    std::stable_sort(hot.begin(), hot.end(), [&](const SourceLine* a, const SourceLine* b) {
+        return count(a->addr) > count(b->addr) || (count(a->addr) == count(b->addr) && a->addr < b->addr);
+    });
+    if (hot.size() > top) hot.resize(top);
+
+    out << "\n# hot spots\n" << "       count        %  address  line  location              source\n";
+    for (const SourceLine* l : hot) {
+        uint64_t c = count(l->addr);
+        snprintf(buf, sizeof(buf), "%12llu  %6.2f%%  0x%05llx  %4d  ", static_cast<unsigned long long>(c), percent(c),
+                 static_cast<unsigned long long>(l->addr), l->line);
+        std::string loc = where(l->addr);
+        loc.resize(std::max<size_t>(loc.size(), 20), ' ');
+        out << buf << loc << "  " << l->source << "\n";
+    }
+}
+
+void Profile::annotate(std::ostream& out, const char* text, size_t size) const {
+    // 清单按行号递增，与逐行输出同步前进
+    size_t next = 0;
+    int number = 0;
+    char buf[64];
+    const char* end = text + size;
+    for (const char* line = text; line < end; ) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (eol == nullptr) eol = end;
+        number++;
+
+        uint64_t c = 0;
+        bool code = false;
+        if (next < listing.size() && listing[next].line == number) {
+            c = count(listing[next].addr);
+            code = true;
+            next++;
+        }
+        if (code && c) snprintf(buf, sizeof(buf), "%12llu %6.2f%% | ", static_cast<unsigned long long>(c), total ? 100.0 * c / total : 0.0);
+        else snprintf(buf, sizeof(buf), "%20s | ", "");
+        out << buf;
+        out.write(line, eol - line);
+        out << "\n";
+        line = eol + 1;
+    }
+}
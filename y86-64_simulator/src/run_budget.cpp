@@ -0,0 +1,21 @@
+#include <cstdio>
+#include "../include/run_budget.h"
+#include "../include/stats.h"
+#include "../include/trace.h"
+
+void appendRunSummaryJSON(std::string& out, const CPU& cpu, const RunSummary& summary, const ExecStats* stats) {
+    static const char* const reasons[] = {"stat", "steps", "deadline"};
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\n  \"STEPS\": %llu,\n  \"STOP\": \"%s\",\n  \"SECONDS\": %.6f,\n  \"MIPS\": %.1f,\n",
+             static_cast<unsigned long long>(summary.steps), reasons[static_cast<int>(summary.reason)], summary.seconds,
+             summary.seconds > 0 ? summary.steps / summary.seconds / 1e6 : 0.0);
+    out += buf;
+    if (stats) {
+        out += "  \"STATS\": ";
+        appendStatsJSON(out, *stats, 1);
+        out += ",\n";
+    }
+    out += "  \"FINAL\":\n";
+    appendStateJSON(out, cpu, 1);
+    out += "\n}\n";
+}
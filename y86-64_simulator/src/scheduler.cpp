@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "../include/scheduler.h"
+
+WorkStealingScheduler::WorkStealingScheduler(unsigned threads, uint64_t slice) : slice(slice) {
+    this->threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkStealingScheduler::run(const std::vector<SliceTask*>& tasks) {
+    unsigned n = std::max<unsigned>(1, std::min<size_t>(threads, tasks.size()));
+    uint64_t budget = slice ? slice : UINT64_MAX;
+
+    // 任务同一时刻至多在一个队列中，每个队列的容量取任务总数即可
+    std::vector<std::unique_ptr<WorkStealingDeque<SliceTask*>>> queues;
+    for (unsigned w = 0; w < n; w++) queues.emplace_back(new WorkStealingDeque<SliceTask*>(tasks.size()));
+    // 按下标顺序压入，各线程从队首按下标从小到大执行自己的任务
+    for (size_t i = 0; i < tasks.size(); i++) queues[i % n]->push(tasks[i]);
+
+    std::atomic<size_t> remaining{tasks.size()};
+    std::atomic<uint64_t> sliceTotal{0}, stealTotal{0};
+
+    auto worker = [&](unsigned self) {
+        WorkStealingDeque<SliceTask*>& own = *queues[self];
+        uint64_t seed = 0x9E3779B97F4A7C15ull * (self + 1);
+        uint64_t slices = 0, steals = 0;
+        SliceTask* task = nullptr;
+
+        // 从自己队列的队首取任务；steal 只在与窃取者竞争失败时返回 false，队列非空就重试
+        auto takeOwn = [&]() {
+            while (!own.empty())
+                if (own.steal(task)) return true;
+            return false;
+        };
+
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (task == nullptr && !takeOwn()) {
+                // 自己的队列为空：从随机位置开始依次尝试窃取
+                seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+                for (unsigned k = 0; k < n && task == nullptr; k++) {
+                    unsigned victim = (seed + k) % n;
+                    if (victim != self && queues[victim]->steal(task)) steals++;
+                }
+                if (task == nullptr) {
+                    std::this_thread::yield();  // 剩余任务都在其他线程手中执行
+                    continue;
+                }
+            }
+
+            slices++;
+            if (task->resume(budget)) {
+                remaining.fetch_sub(1, std::memory_order_release);
+                task = nullptr;
+                continue;
+            }
+
+            // 未完成：放回队尾，先执行排在前面的任务（轮转）；队列为空时直接继续执行同一个任务
+            if (!own.empty()) {
+                own.push(task);
+                task = nullptr;
+            }
+        }
+        sliceTotal += slices;
+        stealTotal += steals;
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < n; w++) pool.emplace_back(worker, w);
+    worker(0);  // 当前线程也参与
+    for (auto& t : pool) t.join();
+
+    sliceCount = sliceTotal.load();
+    stealCount = stealTotal.load();
+}
@@ -0,0 +1,38 @@
+#include <cstdio>
+#include "../include/cpu_impl.h"
+#include "../include/stats.h"
+
+// 统计实例（默认实例 CPU 在 src/cpu.cpp 中实例化）
+template class BasicCPU<Memory, ExecStats>;
+
+void appendStatsJSON(std::string& out, const ExecStats& stats, int indent) {
+    static const char* const names[12] = {"halt", "nop", "rrmovq", "irmovq", "rmmovq", "mrmovq",
+                                          "opq", "jxx", "call", "ret", "pushq", "popq"};
+    std::string pad(2 * indent + 2, ' ');
+    char buf[160];
+
+    out += "{\n" + pad + "\"INSTRUCTIONS\": " + std::to_string(stats.steps) + ",\n";
+    out += pad + "\"ICODE\": {";
+    uint64_t invalid = 0;
+    for (int i = 12; i < 16; i++) invalid += stats.icodes[i];
+    for (int i = 0; i < 12; i++) out += std::string("\"") + names[i] + "\": " + std::to_string(stats.icodes[i]) + ", ";
+    out += "\"invalid\": " + std::to_string(invalid) + "},\n";
+
+    uint64_t cmov = stats.cmovTaken + stats.cmovNotTaken;
+    snprintf(buf, sizeof(buf), "\"JXX\": {\"TAKEN\": %llu, \"NOT_TAKEN\": %llu},\n",
+             static_cast<unsigned long long>(stats.jxxTaken), static_cast<unsigned long long>(stats.jxxNotTaken));
+    out += pad + buf;
+    snprintf(buf, sizeof(buf), "\"CMOV\": {\"TAKEN\": %llu, \"NOT_TAKEN\": %llu, \"RATE\": %.4f},\n",
+             static_cast<unsigned long long>(stats.cmovTaken), static_cast<unsigned long long>(stats.cmovNotTaken),
+             cmov ? static_cast<double>(stats.cmovTaken) / cmov : 0.0);
+    out += pad + buf;
+    snprintf(buf, sizeof(buf), "\"MEM\": {\"READS\": %llu, \"WRITES\": %llu},\n",
+             static_cast<unsigned long long>(stats.reads), static_cast<unsigned long long>(stats.writes));
+    out += pad + buf;
+    out += pad + "\"MAX_CALL_DEPTH\": " + std::to_string(stats.maxDepth) + "\n";
+    out += std::string(2 * indent, ' ') + "}";
+}
+
+void appendRunSummaryJSON(std::string& out, const StatsCPU& cpu, const RunSummary& summary) {
+    appendRunSummaryJSON<ExecStats>(out, cpu, summary, &cpu.hooks);
+}
@@ -0,0 +1,500 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/trace.h"
+
+// 各种状态来源（CPU / 二进制 trace 解码结果 / 异步写线程的影子状态）共用同一份输出格式
+// out 为 std::ostream 或 TextBuffer；reg(i) 返回第 i 个寄存器，forEachMem(f) 按地址升序对每个非零内存字调用 f(addr, value)
+template<typename Out, typename RegFn, typename MemFn>
+static void printState(Out& out, int steps, addr_t pc, int stat, RegFn reg, bool zf, bool sf, bool of, MemFn forEachMem) {
+    if (steps != 1) {
+        out << ",\n";
+    }
+
+    out << "  {\n";
+    out << "    \"PC\": " << pc << ",\n";
+    out << "    \"STAT\": " << stat << ",\n";
+    
+    out << "    \"REG\": {";
+    const char* regNames[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", 
+                              "r8", "r9", "r10", "r11", "r12", "r13", "r14", "none"};
+    for (int i = 0; i < 15; i++) { 
+        out << "\"" << regNames[i] << "\": " << reg(i);
+        if (i < 14) out << ", ";
+    }
+    out << "},\n";
+
+    out << "    \"CC\": {"
+        << "\"ZF\": " << (zf ? 1 : 0) << ", "
+        << "\"SF\": " << (sf ? 1 : 0) << ", "
+        << "\"OF\": " << (of ? 1 : 0)
+        << "},\n";
+
+    out << "    \"MEM\": {";
+    bool firstMem = true;
+    forEachMem([&](addr_t addr, word_t val) {
+        if (!firstMem) out << ", ";
+        out << "\"" << addr << "\": " << val;
+        firstMem = false;
+    });
+    out << "}\n";
+
+    out << "  }";
+}
+
+void printStateJSON(const CPU& cpu, int steps) {
+    printState(std::cout, steps, cpu.PC, (int)cpu.stat,
+               [&](int i) { return cpu.reg.getReg(static_cast<Reg::ID>(i)); },
+               cpu.cc.zf(), cpu.cc.sf(), cpu.cc.of(),
+               [&](auto f) { cpu.mem.forEachLiveWord(f); });
+}
+
+void printStateJSON(const TraceState& s, int steps) {
+    printState(std::cout, steps, s.PC, s.stat,
+               [&](int i) { return s.regs[i]; },
+               s.zf, s.sf, s.of,
+               [&](auto f) { for (const auto& kv : s.mem) f(kv.first, kv.second); });
+}
+
+static const char* REG_NAMES[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+                                  "r8", "r9", "r10", "r11", "r12", "r13", "r14"};
+
+DeltaTracer::DeltaTracer(CPU& cpu, int keyframeInterval)
+    : cpu(cpu), interval(keyframeInterval), words(cpu.mem.size()) {
+    cpu.mem.writeLog = &writes;
+}
+
+DeltaTracer::~DeltaTracer() {
+    cpu.mem.writeLog = nullptr;
+}
+
+void DeltaTracer::print(int steps) {
+    if (steps != 1) std::cout << ",\n";
+
+    if (steps == 1 || (interval > 0 && (steps - 1) % interval == 0)) keyframe();
+    else delta();
+
+    writes.clear();
+}
+
+void DeltaTracer::keyframe() {
+    std::cout << "  {\n";
+    std::cout << "    \"KEY\": 1,\n";
+    std::cout << "    \"PC\": " << cpu.PC << ",\n";
+    std::cout << "    \"STAT\": " << (int)cpu.stat << ",\n";
+
+    std::cout << "    \"REG\": {";
+    for (int i = 0; i < 15; i++) {
+        regs[i] = cpu.reg.getReg(static_cast<Reg::ID>(i));
+        std::cout << "\"" << REG_NAMES[i] << "\": " << regs[i];
+        if (i < 14) std::cout << ", ";
+    }
+    std::cout << "},\n";
+
+    zf = cpu.cc.zf();
+    sf = cpu.cc.sf();
+    of = cpu.cc.of();
+    std::cout << "    \"CC\": {\"ZF\": " << zf << ", \"SF\": " << sf << ", \"OF\": " << of << "},\n";
+
+    std::cout << "    \"MEM\": {";
+    bool first = true;
+    words.reset();
+    cpu.mem.forEachLiveWord([&](addr_t addr, word_t val) {
+        words.writeWord(addr, val);
+        if (!first) std::cout << ", ";
+        std::cout << "\"" << addr << "\": " << val;
+        first = false;
+    });
+    std::cout << "}\n";
+
+    std::cout << "  }";
+}
+
+void DeltaTracer::delta() {
+    std::cout << "  {\"PC\": " << cpu.PC << ", \"STAT\": " << (int)cpu.stat;
+
+    bool first = true;
+    for (int i = 0; i < 15; i++) {
+        word_t v = cpu.reg.getReg(static_cast<Reg::ID>(i));
+        if (v == regs[i]) continue;
+        std::cout << (first ? ", \"REG\": {" : ", ") << "\"" << REG_NAMES[i] << "\": " << v;
+        regs[i] = v;
+        first = false;
+    }
+    if (!first) std::cout << "}";
+
+    if (cpu.cc.zf() != zf || cpu.cc.sf() != sf || cpu.cc.of() != of) {
+        zf = cpu.cc.zf();
+        sf = cpu.cc.sf();
+        of = cpu.cc.of();
+        std::cout << ", \"CC\": {\"ZF\": " << zf << ", \"SF\": " << sf << ", \"OF\": " << of << "}";
+    }
+
+    // 同一内存字可能被记录多次，与上次输出的值比较即可去重
+    first = true;
+    for (addr_t a : writes) {
+        bool error;
+        word_t v = cpu.mem.readWord(a, error);
+        if (v == words.readWord(a, error)) continue;
+        std::cout << (first ? ", \"MEM\": {" : ", ") << "\"" << a << "\": " << v;
+        words.writeWord(a, v);
+        first = false;
+    }
+    if (!first) std::cout << "}";
+
+    std::cout << "}";
+}
+
+static const char TRACE_MAGIC[8] = {'Y', '8', '6', 'T', 'R', 'A', 'C', 'E'};
+static const char INDEX_MAGIC[8] = {'Y', '8', '6', 'T', 'I', 'D', 'X', '\0'};
+static const uint32_t TRACE_VERSION = 1;
+static const uint8_t REC_KEYFRAME = 1;
+static const uint8_t REC_DELTA = 2;
+static const size_t TRAILER_SIZE = 4 * 8;
+
+static uint8_t packCC(bool zf, bool sf, bool of) {
+    return (zf ? 1 : 0) | (sf ? 2 : 0) | (of ? 4 : 0);
+}
+
+BinaryTraceWriter::BinaryTraceWriter(CPU& cpu, FILE* out, int keyframeInterval)
+    : cpu(cpu), out(out), interval(keyframeInterval), words(cpu.mem.size()) {
+    cpu.mem.writeLog = &writes;
+    cpu.diag = &std::cerr;  // trace 通常写到标准输出，诊断信息不能混入二进制数据
+    buf.insert(buf.end(), TRACE_MAGIC, TRACE_MAGIC + 8);
+    put<uint32_t>(TRACE_VERSION);
+    put<uint32_t>(0);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+    finish();
+    cpu.mem.writeLog = nullptr;
+    cpu.diag = &std::cout;
+}
+
+// 按宿主字节序写出（x86-64 / ARM64 均为小端序）
+template<typename T>
+void BinaryTraceWriter::put(T v) {
+    uint8_t b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));
+    buf.insert(buf.end(), b, b + sizeof(T));
+}
+
+void BinaryTraceWriter::flushBuf() {
+    fwrite(buf.data(), 1, buf.size(), out);
+    offset += buf.size();
+    buf.clear();
+}
+
+void BinaryTraceWriter::record(int step) {
+    steps = step;
+    if (step == 1 || (interval > 0 && (step - 1) % interval == 0)) keyframe();
+    else delta();
+    writes.clear();
+
+    if (buf.size() >= (64 << 10)) flushBuf();
+}
+
+void BinaryTraceWriter::keyframe() {
+    index.push_back({steps, offset + buf.size()});
+
+    put<uint8_t>(REC_KEYFRAME);
+    put<uint64_t>(steps);
+    put<uint64_t>(cpu.PC);
+    put<uint8_t>(static_cast<uint8_t>(cpu.stat));
+    cc = packCC(cpu.cc.zf(), cpu.cc.sf(), cpu.cc.of());
+    put<uint8_t>(cc);
+    for (int i = 0; i < 15; i++) {
+        regs[i] = cpu.reg.getReg(static_cast<Reg::ID>(i));
+        put<int64_t>(regs[i]);
+    }
+
+    words.reset();
+    uint32_t n = 0;
+    cpu.mem.forEachLiveWord([&](addr_t, word_t) { n++; });
+    put<uint32_t>(n);
+    cpu.mem.forEachLiveWord([&](addr_t addr, word_t val) {
+        words.writeWord(addr, val);
+        put<uint64_t>(addr);
+        put<int64_t>(val);
+    });
+}
+
+void BinaryTraceWriter::delta() {
+    put<uint8_t>(REC_DELTA);
+    put<uint64_t>(cpu.PC);
+    put<uint8_t>(static_cast<uint8_t>(cpu.stat));
+    cc = packCC(cpu.cc.zf(), cpu.cc.sf(), cpu.cc.of());
+    put<uint8_t>(cc);
+
+    uint16_t mask = 0;
+    word_t changed[15];
+    int nchanged = 0;
+    for (int i = 0; i < 15; i++) {
+        word_t v = cpu.reg.getReg(static_cast<Reg::ID>(i));
+        if (v == regs[i]) continue;
+        mask |= 1 << i;
+        changed[nchanged++] = regs[i] = v;
+    }
+    put<uint16_t>(mask);
+    for (int i = 0; i < nchanged; i++) put<int64_t>(changed[i]);
+
+    // 数量先占位，写完再回填
+    size_t countAt = buf.size();
+    put<uint32_t>(0);
+    uint32_t n = 0;
+    for (addr_t a : writes) {
+        bool error;
+        word_t v = cpu.mem.readWord(a, error);
+        if (v == words.readWord(a, error)) continue;
+        words.writeWord(a, v);
+        put<uint64_t>(a);
+        put<int64_t>(v);
+        n++;
+    }
+    std::memcpy(&buf[countAt], &n, sizeof(n));
+}
+
+void BinaryTraceWriter::finish() {
+    if (finished) return;
+    finished = true;
+
+    uint64_t indexOffset = offset + buf.size();
+    for (const auto& e : index) {
+        put<uint64_t>(e.first);
+        put<uint64_t>(e.second);
+    }
+    put<uint64_t>(steps);
+    put<uint64_t>(index.size());
+    put<uint64_t>(indexOffset);
+    buf.insert(buf.end(), INDEX_MAGIC, INDEX_MAGIC + 8);
+    flushBuf();
+    fflush(out);
+}
+
+BinaryTraceReader::~BinaryTraceReader() {
+    if (data) munmap(const_cast<uint8_t*>(data), size);
+}
+
+bool BinaryTraceReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(16 + TRAILER_SIZE)) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    data = static_cast<const uint8_t*>(p);
+    size = st.st_size;
+
+    const uint8_t* trailer = data + size - TRAILER_SIZE;
+    uint64_t indexOffset;
+    std::memcpy(&total, trailer, 8);
+    std::memcpy(&keyframes, trailer + 8, 8);
+    std::memcpy(&indexOffset, trailer + 16, 8);
+    if (std::memcmp(data, TRACE_MAGIC, 8) != 0 || std::memcmp(trailer + 24, INDEX_MAGIC, 8) != 0 ||
+        indexOffset > size - TRAILER_SIZE || (size - TRAILER_SIZE - indexOffset) != keyframes * 16)
+        return false;
+
+    indexAt = data + indexOffset;
+    end = indexOffset;
+    pos = 16;
+    return true;
+}
+
+template<typename T>
+bool BinaryTraceReader::get(T& v) {
+    if (pos + sizeof(T) > end) return false;
+    std::memcpy(&v, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+bool BinaryTraceReader::decode(TraceState& s) {
+    uint8_t type, stat, cc;
+    if (!get(type)) return false;
+
+    if (type == REC_KEYFRAME) {
+        if (!get(s.step) || !get(s.PC) || !get(stat) || !get(cc)) return false;
+        for (int i = 0; i < 15; i++)
+            if (!get(s.regs[i])) return false;
+        s.mem.clear();
+    }
+    else if (type == REC_DELTA) {
+        uint16_t mask;
+        if (!get(s.PC) || !get(stat) || !get(cc) || !get(mask)) return false;
+        for (int i = 0; i < 15; i++)
+            if ((mask & (1 << i)) && !get(s.regs[i])) return false;
+        s.step++;
+    }
+    else return false;
+
+    s.stat = stat;
+    s.zf = cc & 1;
+    s.sf = cc & 2;
+    s.of = cc & 4;
+
+    uint32_t n;
+    if (!get(n)) return false;
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t addr;
+        int64_t val;
+        if (!get(addr) || !get(val)) return false;
+        if (val) s.mem[addr] = val;
+        else s.mem.erase(addr);
+    }
+    return true;
+}
+
+bool BinaryTraceReader::seek(uint64_t step, TraceState& s) {
+    if (step < 1 || step > total || keyframes == 0) return false;
+
+    // 找到 step 不超过目标的最后一个关键帧
+    uint64_t lo = 0, hi = keyframes;
+    while (hi - lo > 1) {
+        uint64_t mid = (lo + hi) / 2;
+        uint64_t k;
+        std::memcpy(&k, indexAt + mid * 16, 8);
+        if (k <= step) lo = mid;
+        else hi = mid;
+    }
+    uint64_t off;
+    std::memcpy(&off, indexAt + lo * 16 + 8, 8);
+    pos = off;
+
+    if (!decode(s)) return false;
+    while (s.step < step)
+        if (!decode(s)) return false;
+    return true;
+}
+
+bool BinaryTraceReader::next(TraceState& s) {
+    return s.step < total && decode(s);
+}
+
+// 追加式文本缓冲，提供与 std::ostream 相同的 << 接口，供 printState 在写线程中格式化
+class TextBuffer{
+    public:
+        std::string s;
+
+        TextBuffer& operator<<(const char* p) { s.append(p); return *this; }
+        TextBuffer& operator<<(char c) { s.push_back(c); return *this; }
+
+        template<typename I, typename = std::enable_if_t<std::is_integral<I>::value>>
+        TextBuffer& operator<<(I v) {
+            char tmp[24];
+            auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+            s.append(tmp, r.ptr);
+            return *this;
+        }
+};
+
+void appendStateJSON(std::string& out, const CPU& cpu, int steps) {
+    TextBuffer buf;
+    buf.s.swap(out);
+    printState(buf, steps, cpu.PC, (int)cpu.stat,
+               [&](int i) { return cpu.reg.getReg(static_cast<Reg::ID>(i)); },
+               cpu.cc.zf(), cpu.cc.sf(), cpu.cc.of(),
+               [&](auto f) { cpu.mem.forEachLiveWord(f); });
+    buf.s.swap(out);
+}
+
+AsyncTraceWriter::AsyncTraceWriter(CPU& cpu, FILE* out)
+    : cpu(cpu), out(out), words(cpu.mem.size()) {
+    cpu.mem.forEachLiveWord([&](addr_t addr, word_t val) { words.writeWord(addr, val); });
+    cpu.mem.writeLog = &writes;
+    cpu.diag = &diag;
+    worker = std::thread(&AsyncTraceWriter::run, this);
+}
+
+AsyncTraceWriter::~AsyncTraceWriter() {
+    finish();
+    cpu.mem.writeLog = nullptr;
+    cpu.diag = &std::cout;
+}
+
+void AsyncTraceWriter::record(int) {
+    Snapshot snap;
+
+    // 本步执行时输出的诊断信息，按 regs 的大小分段
+    if (diag.tellp() > 0) {
+        std::string text = diag.str();
+        diag.str("");
+        snap.kind = Snapshot::TEXT;
+        for (size_t at = 0; at < text.size(); at += sizeof(snap.regs)) {
+            snap.writes = static_cast<uint8_t>(std::min(sizeof(snap.regs), text.size() - at));
+            std::memcpy(snap.regs, text.data() + at, snap.writes);
+            ring.push(snap);
+        }
+    }
+
+    snap.PC = cpu.PC;
+    for (int i = 0; i < 15; i++) snap.regs[i] = cpu.reg.getReg(static_cast<Reg::ID>(i));
+    snap.stat = static_cast<uint8_t>(cpu.stat);
+    snap.cc = packCC(cpu.cc.zf(), cpu.cc.sf(), cpu.cc.of());
+
+    // 先放续接记录，最后一条记录带上本步的寄存器并触发输出
+    size_t i = 0;
+    do {
+        snap.writes = 0;
+        for (; i < writes.size() && snap.writes < Snapshot::MAX_WRITES; i++) {
+            bool error;
+            snap.addr[snap.writes] = writes[i];
+            snap.val[snap.writes] = cpu.mem.readWord(writes[i], error);
+            snap.writes++;
+        }
+        snap.kind = i < writes.size() ? Snapshot::CONT : Snapshot::STEP;
+        ring.push(snap);
+    } while (i < writes.size());
+
+    writes.clear();
+}
+
+void AsyncTraceWriter::run() {
+    TextBuffer buf;
+    int steps = 0;
+    Snapshot snap;
+
+    while (true) {
+        if (!ring.tryPop(snap)) {
+            if (done.load(std::memory_order_acquire) && ring.empty()) break;
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (snap.kind == Snapshot::TEXT) {
+            buf.s.append(reinterpret_cast<const char*>(snap.regs), snap.writes);
+            continue;
+        }
+        for (int i = 0; i < snap.writes; i++) words.writeWord(snap.addr[i], snap.val[i]);
+        if (snap.kind == Snapshot::CONT) continue;
+
+        printState(buf, ++steps, snap.PC, snap.stat,
+                   [&](int i) { return snap.regs[i]; },
+                   snap.cc & 1, snap.cc & 2, snap.cc & 4,
+                   [&](auto f) { words.forEachLiveWord(f); });
+
+        if (buf.s.size() >= (1 << 20)) {
+            fwrite(buf.s.data(), 1, buf.s.size(), out);
+            buf.s.clear();
+        }
+    }
+
+    fwrite(buf.s.data(), 1, buf.s.size(), out);
+    fflush(out);
+}
+
+void AsyncTraceWriter::finish() {
+    if (finished) return;
+    finished = true;
+    done.store(true, std::memory_order_release);
+    worker.join();
+}
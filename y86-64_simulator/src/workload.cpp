@@ -0,0 +1,207 @@
+#include <cstdlib>
+#include "../include/workload.h"
+#include "../include/yo_builder.h"
+
+namespace Workload{
+
+static const char* const NAMES[SHAPE_COUNT] = {"arith", "recurse", "stream", "branchy", "cmov"};
+
+const char* shapeName(Shape shape) {
+    return shape < SHAPE_COUNT ? NAMES[shape] : "?";
+}
+
+bool parseShape(const std::string& name, Shape& shape) {
+    for (int i = 0; i < SHAPE_COUNT; i++) {
+        if (name == NAMES[i]) {
+            shape = static_cast<Shape>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseCount(const std::string& text, uint64_t& count) {
+    char* end;
+    count = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) return false;
+    uint64_t scale = 1;
+    if (*end == 'k') scale = 1000;
+    else if (*end == 'm') scale = 1000000;
+    else if (*end == 'g') scale = 1000000000;
+    if (scale != 1) end++;
+    count *= scale;
+    return *end == '\0';
+}
+
+// 主机端的伪随机数（xorshift64），只用于生成数组内容与初值
+static uint64_t next(uint64_t& x) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+// 每轮 per 条、另有 fixed 条一次性指令时，约 instructions 条所需的轮数
+static uint64_t rounds(uint64_t instructions, uint64_t fixed, uint64_t per) {
+    return instructions > fixed + per ? (instructions - fixed) / per : 1;
+}
+
+// 10 条 / 轮：8 条相互依赖的 OPq / rrmovq
+static void arith(YoBuilder& b, uint64_t instructions, uint64_t& x) {
+    b.irmovq(rounds(instructions, 8, 10), Reg::R14);
+    b.irmovq(1, Reg::R13);
+    b.irmovq(next(x), Reg::RAX);
+    b.irmovq(next(x), Reg::RBX);
+    b.irmovq(next(x), Reg::RCX);
+    b.irmovq(next(x), Reg::RDX);
+    b.irmovq(next(x), Reg::RSI);
+    b.label("loop");
+    b.opq(ALU::ADD, Reg::RAX, Reg::RBX);
+    b.opq(ALU::XOR, Reg::RBX, Reg::RCX);
+    b.opq(ALU::SUB, Reg::RCX, Reg::RDX);
+    b.opq(ALU::ADD, Reg::RDX, Reg::RSI);
+    b.opq(ALU::XOR, Reg::RSI, Reg::RAX);
+    b.opq(ALU::ADD, Reg::RCX, Reg::RDI);
+    b.rrmovq(Reg::RBX, Reg::RBP);
+    b.opq(ALU::AND, Reg::RAX, Reg::RBP);
+    b.opq(ALU::SUB, Reg::R13, Reg::R14);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+}
+
+// 每轮：6 条外层 + rsum(array, 256)，其中每个元素 11 条、递归终点 4 条
+// 每层递归压栈 16 字节（返回地址与 %rbx），最深约 4 KiB，栈从 0x2000 向下不会碰到 0xc00 处的数组末尾
+static void recurse(YoBuilder& b, uint64_t instructions, uint64_t& x) {
+    const int N = 256;
+    b.irmovq(0x2000, Reg::RSP);
+    b.irmovq(rounds(instructions, 5, 6 + N * 11 + 4), Reg::R14);
+    b.irmovq(1, Reg::R13);
+    b.irmovq(8, Reg::R8);
+    b.label("loop");
+    b.irmovq(0x400, Reg::RDI);
+    b.irmovq(N, Reg::RSI);
+    b.call("rsum");
+    b.opq(ALU::ADD, Reg::RAX, Reg::R10);
+    b.opq(ALU::SUB, Reg::R13, Reg::R14);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+
+    // long rsum(long *start, long count)
+    b.label("rsum");
+    b.opq(ALU::XOR, Reg::RAX, Reg::RAX);
+    b.opq(ALU::AND, Reg::RSI, Reg::RSI);
+    b.jxx(Cond::LE, "return");
+    b.pushq(Reg::RBX);
+    b.mrmovq(0, Reg::RDI, Reg::RBX);
+    b.opq(ALU::ADD, Reg::R8, Reg::RDI);
+    b.opq(ALU::SUB, Reg::R13, Reg::RSI);
+    b.call("rsum");
+    b.opq(ALU::ADD, Reg::RBX, Reg::RAX);
+    b.popq(Reg::RBX);
+    b.label("return");
+    b.ret();
+
+    b.org(0x400);
+    b.label("array");
+    for (int i = 0; i < N; i++) b.quad(next(x) >> 16);
+}
+
+// 每轮：4 条外层 + 512 个元素各 6 条；数组原地改写为前缀和，下一轮在此基础上继续累加
+static void stream(YoBuilder& b, uint64_t instructions, uint64_t& x) {
+    const int N = 512;
+    b.irmovq(rounds(instructions, 4, 4 + N * 6), Reg::R14);
+    b.irmovq(1, Reg::R13);
+    b.irmovq(8, Reg::R8);
+    b.label("loop");
+    b.irmovq(0x800, Reg::RDI);
+    b.irmovq(N, Reg::RCX);
+    b.label("inner");
+    b.mrmovq(0, Reg::RDI, Reg::RAX);
+    b.opq(ALU::ADD, Reg::RAX, Reg::RBX);
+    b.rmmovq(Reg::RBX, 0, Reg::RDI);
+    b.opq(ALU::ADD, Reg::R8, Reg::RDI);
+    b.opq(ALU::SUB, Reg::R13, Reg::RCX);
+    b.jxx(Cond::NE, "inner");
+    b.opq(ALU::SUB, Reg::R13, Reg::R14);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+
+    b.org(0x800);
+    b.label("array");
+    for (int i = 0; i < N; i++) b.quad(next(x) & 0xffff);
+}
+
+// %rax 为左移的 Galois LFSR（x^64 + x^4 + x^3 + x + 1）：最高位为 1 时左移后异或 0x1b
+// 平均每轮约 10.5 条：两个方向不可预测的分支（最高位、第 8 位）
+static void branchy(YoBuilder& b, uint64_t instructions, uint64_t& x) {
+    b.irmovq(rounds(instructions, 6, 21) * 2, Reg::R14);
+    b.irmovq(1, Reg::R13);
+    b.irmovq(0x1b, Reg::R12);
+    b.irmovq(0x100, Reg::R8);
+    b.irmovq(next(x) | 1, Reg::RAX);
+    b.label("loop");
+    b.opq(ALU::AND, Reg::RAX, Reg::RAX);
+    b.jxx(Cond::GE, "shift");
+    b.opq(ALU::ADD, Reg::RAX, Reg::RAX);
+    b.opq(ALU::XOR, Reg::R12, Reg::RAX);
+    b.jmp("test");
+    b.label("shift");
+    b.opq(ALU::ADD, Reg::RAX, Reg::RAX);
+    b.label("test");
+    b.rrmovq(Reg::RAX, Reg::RCX);
+    b.opq(ALU::AND, Reg::R8, Reg::RCX);
+    b.jxx(Cond::E, "zero");
+    b.opq(ALU::ADD, Reg::R13, Reg::RBX);
+    b.jmp("next");
+    b.label("zero");
+    b.opq(ALU::SUB, Reg::R13, Reg::RDX);
+    b.label("next");
+    b.opq(ALU::SUB, Reg::R13, Reg::R14);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+}
+
+// 与 BRANCHY 相同的 LFSR，反馈项用 cmovl 选择；%rbx / %rdx 用 cmovg / cmovl 维护最大值与最小值
+// 13 条 / 轮，唯一的分支是循环本身
+static void cmov(YoBuilder& b, uint64_t instructions, uint64_t& x) {
+    b.irmovq(rounds(instructions, 8, 13), Reg::R14);
+    b.irmovq(1, Reg::R13);
+    b.irmovq(0x1b, Reg::R12);
+    b.irmovq(next(x) | 1, Reg::RAX);
+    b.irmovq(INT64_MIN, Reg::RBX);
+    b.irmovq(INT64_MAX, Reg::RDX);
+    b.irmovq(0, Reg::R11);
+    b.label("loop");
+    b.opq(ALU::AND, Reg::RAX, Reg::RAX);
+    b.rrmovq(Reg::R11, Reg::RSI);
+    b.cmov(Cond::L, Reg::R12, Reg::RSI);
+    b.opq(ALU::ADD, Reg::RAX, Reg::RAX);
+    b.opq(ALU::XOR, Reg::RSI, Reg::RAX);
+    b.rrmovq(Reg::RAX, Reg::RCX);
+    b.opq(ALU::SUB, Reg::RBX, Reg::RCX);
+    b.cmov(Cond::G, Reg::RAX, Reg::RBX);
+    b.rrmovq(Reg::RAX, Reg::RCX);
+    b.opq(ALU::SUB, Reg::RDX, Reg::RCX);
+    b.cmov(Cond::L, Reg::RAX, Reg::RDX);
+    b.opq(ALU::SUB, Reg::R13, Reg::R14);
+    b.jxx(Cond::NE, "loop");
+    b.halt();
+}
+
+std::string generate(Shape shape, uint64_t instructions, uint64_t seed) {
+    YoBuilder b;
+    b.comment(std::string("y86gen ") + shapeName(shape) + " " + std::to_string(instructions) + " seed " +
+              std::to_string(seed));
+    uint64_t x = seed * 0x9e3779b97f4a7c15ull + 0x2545f4914f6cdd1dull;  // 非 0 的初始状态
+    switch (shape) {
+        case ARITH:   arith(b, instructions, x); break;
+        case RECURSE: recurse(b, instructions, x); break;
+        case STREAM:  stream(b, instructions, x); break;
+        case BRANCHY: branchy(b, instructions, x); break;
+        case CMOV:    cmov(b, instructions, x); break;
+        default:      return std::string();
+    }
+    return b.text();
+}
+
+}
@@ -0,0 +1,78 @@
+// y86gen：合成负载生成器（形状见 workload.h）与参考终态计算
+//
+// 用法：./y86gen SHAPE COUNT [SEED]
+//   在标准输出写出约执行 COUNT 条指令的 .yo（COUNT 可带 k / m / g 后缀）
+//       ./y86gen --final program.yo [--engine seq|threaded|jit]
+//   不限步数运行到停止，输出 {"STEPS": 步数, "FINAL": 终态}，终态与 printStateJSON 的格式相同
+//   未指定引擎时分别用 THREADED 与 JIT 运行，结果不一致时退出码为 2
+// corpus/ 下的程序与 .final.json 由 make corpus 用本工具生成
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+#include "../include/trace.h"
+#include "../include/workload.h"
+
+static bool finalState(const std::string& path, Engine engine, std::string& out) {
+    Memory mem;
+    CPU cpu(mem);
+    Image info;
+    if (!Loader::loadFile(path, mem, &info)) return false;
+    cpu.PC = info.entry;
+    cpu.engine = engine;
+    uint64_t steps = cpu.run(UINT64_MAX);
+
+    out = "{\n  \"STEPS\": " + std::to_string(steps) + ",\n  \"FINAL\":\n";
+    appendStateJSON(out, cpu, 1);
+    out += "\n}\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && std::string(argv[1]) == "--final") {
+        std::vector<Engine> engines = {Engine::THREADED, Engine::JIT};
+        if (argc == 5 && std::string(argv[3]) == "--engine") {
+            std::string name = argv[4];
+            if (name == "seq") engines = {Engine::SEQ};
+            else if (name == "threaded") engines = {Engine::THREADED};
+            else if (name == "jit") engines = {Engine::JIT};
+            else {
+                std::cerr << "unknown engine: " << name << std::endl;
+                return 1;
+            }
+        }
+        else if (argc != 3) {
+            std::cerr << "usage: " << argv[0] << " --final program.yo [--engine seq|threaded|jit]" << std::endl;
+            return 1;
+        }
+
+        std::string first, other;
+        for (size_t i = 0; i < engines.size(); i++) {
+            if (!finalState(argv[2], engines[i], i == 0 ? first : other)) {
+                std::cerr << "cannot load " << argv[2] << std::endl;
+                return 1;
+            }
+            if (i > 0 && other != first) {
+                std::cerr << argv[2] << ": engines disagree on the final state" << std::endl;
+                return 2;
+            }
+        }
+        std::cout << first;
+        return 0;
+    }
+
+    Workload::Shape shape;
+    uint64_t count, seed = 1;
+    if (argc < 3 || argc > 4 || !Workload::parseShape(argv[1], shape) || !Workload::parseCount(argv[2], count) ||
+        (argc == 4 && !Workload::parseCount(argv[3], seed))) {
+        std::cerr << "usage: " << argv[0] << " arith|recurse|stream|branchy|cmov COUNT [SEED]\n"
+                  << "       " << argv[0] << " --final program.yo [--engine seq|threaded|jit]" << std::endl;
+        return 1;
+    }
+    std::cout << Workload::generate(shape, count, seed);
+    return 0;
+}
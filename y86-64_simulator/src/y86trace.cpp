@@ -0,0 +1,55 @@
+// y86-trace：把二进制 trace（y86-64_simulator --trace binary）的任意步数区间还原为 JSON
+//
+// 用法：./y86-trace trace.bin [FIRST [LAST]]
+//   输出第 FIRST..LAST 步（从 1 开始，含两端，默认全部），格式与 y86-64_simulator 的默认输出相同
+//   ./y86-trace trace.bin --info   只输出总步数
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../include/trace.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "usage: " << argv[0] << " trace.bin [FIRST [LAST] | --info]" << std::endl;
+        return 1;
+    }
+
+    BinaryTraceReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << "cannot read trace " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (argc == 3 && std::string(argv[2]) == "--info") {
+        std::cout << "steps: " << reader.steps() << std::endl;
+        return 0;
+    }
+
+    uint64_t first = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    uint64_t last = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : reader.steps();
+    if (last > reader.steps()) last = reader.steps();
+
+    if (first < 1 || first > last) {
+        std::cout << "[]" << std::endl;
+        return 0;
+    }
+
+    TraceState s;
+    if (!reader.seek(first, s)) {
+        std::cerr << "corrupted trace " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "[" << std::endl;
+    int n = 1;
+    printStateJSON(s, n);
+    while (s.step < last) {
+        if (!reader.next(s)) {
+            std::cerr << "corrupted trace " << argv[1] << std::endl;
+            return 1;
+        }
+        printStateJSON(s, ++n);
+    }
+    std::cout << "\n]" << std::endl;
+    return 0;
+}
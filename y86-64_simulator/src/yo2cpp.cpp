@@ -0,0 +1,404 @@
+// yo2cpp：把 .yo 程序提前编译为 C++ 源文件
+//
+// 从入口（.yo 为 0，.ybo 为镜像中记录的入口）出发沿控制流（顺序执行、jXX、call 及其返回点）找出所有可达指令，
+// 每条指令生成一个标签，jXX / call 直接 goto 目标标签，ret 经 switch 分派。
+// 生成的程序链接 Memory / Register / CPU / printStateJSON，输出与 y86-64_simulator 逐字节相同；
+// 以下情形在该指令之前转入解释器（CPU::step）继续执行，保证与 SEQ 完全一致：
+//   访存越界、写入已编译指令的字节（自修改代码）、非法指令、跳转到未编译的地址
+//
+// 用法：./yo2cpp prog.yo > prog.cpp   或   ./yo2cpp < prog.yo > prog.cpp
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+#include "../include/cpu.h"
+
+static const char* REG_NAMES[] = {"RAX", "RCX", "RDX", "RBX", "RSP", "RBP", "RSI", "RDI",
+                                  "R8", "R9", "R10", "R11", "R12", "R13", "R14", "NONE"};
+
+static const char* OP_NAMES[] = {"halt", "nop", "rrmovq", "irmovq", "rmmovq", "mrmovq",
+                                 "opq", "jxx", "call", "ret", "pushq", "popq"};
+
+static std::string hex(addr_t v){
+    std::ostringstream os;
+    os << "0x" << std::hex << v;
+    return os.str();
+}
+
+static std::string label(addr_t pc){
+    std::ostringstream os;
+    os << "L_" << std::hex << pc;
+    return os.str();
+}
+
+static std::string reg(uint8_t id){
+    return std::string("Reg::") + REG_NAMES[id & 0xF];
+}
+
+static std::string getReg(uint8_t id){
+    return "cpu.reg.getReg(" + reg(id) + ")";
+}
+
+// 与 CPU::cond 相同的条件
+static std::string condExpr(int fn){
+    switch (fn){
+        case Cond::None: return "true";
+        case Cond::LE: return "(cpu.cc.sf() != cpu.cc.of()) || cpu.cc.zf()";
+        case Cond::L: return "cpu.cc.sf() != cpu.cc.of()";
+        case Cond::E: return "cpu.cc.zf()";
+        case Cond::NE: return "!cpu.cc.zf()";
+        case Cond::GE: return "cpu.cc.sf() == cpu.cc.of()";
+        default: return "cpu.cc.sf() == cpu.cc.of() && !cpu.cc.zf()";
+    }
+}
+
+// 是否能直接编译；其余情况在该指令处转入解释器
+static bool compilable(const DecodedInst& d){
+    switch (d.icode){
+        case ICode::HALT:
+        case ICode::NOP:
+        case ICode::IRMOVQ:
+        case ICode::RMMOVQ:
+        case ICode::MRMOVQ:
+        case ICode::CALL:
+        case ICode::RET:
+        case ICode::PUSHQ:
+        case ICode::POPQ:
+            return true;
+        case ICode::RRMOVQ:
+        case ICode::JXX:
+            return d.ifunc <= Cond::G;
+        case ICode::OPQ:
+            return d.ifunc <= ALU::XOR;
+        default:
+            return false;
+    }
+}
+
+class Compiler{
+    public:
+        Compiler(const Memory& m, addr_t entry, std::ostream& o) : mem(m), entry(entry), out(o) {}
+
+        void discover(){
+            std::vector<addr_t> work = {entry};
+            while (!work.empty()){
+                addr_t pc = work.back();
+                work.pop_back();
+                if (insts.count(pc)) continue;
+
+                DecodedInst d;
+                if (!CPU::predecode(mem, pc, d) || !compilable(d)) continue;
+                insts[pc] = d;
+
+                switch (d.icode){
+                    case ICode::HALT:
+                    case ICode::RET:
+                        break;
+                    case ICode::JXX:
+                        work.push_back(d.valC);
+                        if (d.ifunc != Cond::None) work.push_back(d.valP);
+                        break;
+                    case ICode::CALL:
+                        work.push_back(d.valC);
+                        work.push_back(d.valP);  // 返回点
+                        break;
+                    default:
+                        work.push_back(d.valP);
+                        break;
+                }
+            }
+        }
+
+        void emit(const std::string& source){
+            emitPreamble(source);
+
+            out << "int main() {\n";
+            out << "    loadImage();\n";
+            out << "    cpu.PC = " << hex(entry) << "ULL;\n";
+            out << "    std::cout << \"[\" << std::endl;\n\n";
+            out << "    goto " << target(entry) << ";\n\n";
+
+            for (auto it = insts.begin(); it != insts.end(); ++it){
+                auto next = std::next(it);
+                addr_t fallthrough = (next == insts.end()) ? ~addr_t(0) : next->first;
+                emitInst(it->second, fallthrough);
+            }
+
+            // ret 的间接跳转
+            bool hasRet = false;
+            for (const auto& kv : insts) hasRet |= (kv.second.icode == ICode::RET);
+            if (hasRet){
+                out << "dispatch:\n";
+                out << "    switch (cpu.PC) {\n";
+                for (const auto& kv : insts)
+                    out << "        case " << hex(kv.first) << "ULL: goto " << label(kv.first) << ";\n";
+                out << "        default: goto interp;\n";
+                out << "    }\n\n";
+            }
+
+            out << "interp:\n";
+            out << "    while (cpu.stat == Stat::AOK && steps < MAX_STEPS) {\n";
+            out << "        cpu.step();\n";
+            out << "        steps++;\n";
+            out << "        printStateJSON(cpu, steps);\n";
+            out << "    }\n\n";
+
+            out << "done:\n";
+            out << "    std::cout << \"\\n]\" << std::endl;\n";
+            out << "    return 0;\n";
+            out << "}\n";
+        }
+
+    private:
+        const Memory& mem;
+        addr_t entry;
+        std::ostream& out;
+        std::map<addr_t, DecodedInst> insts;
+
+        std::string target(addr_t pc) const {
+            return insts.count(pc) ? label(pc) : std::string("interp");
+        }
+
+        void emitPreamble(const std::string& source){
+            out << "// 由 yo2cpp 从 " << source << " 生成，请勿手工修改\n";
+            out << "#include <iostream>\n";
+            out << "#include \"global.h\"\n";
+            out << "#include \"memory.h\"\n";
+            out << "#include \"cpu.h\"\n";
+            out << "#include \"trace.h\"\n\n";
+            out << "#pragma GCC diagnostic ignored \"-Wunused-label\"  // 只有跳转目标的标签会被引用\n\n";
+
+            out << "static const int MAX_STEPS = 10000;\n\n";
+            out << "static const addr_t MEM_SIZE = " << hex(mem.size()) << "ULL;\n";
+            out << "static Memory mem(MEM_SIZE);\n";
+            out << "static CPU cpu(mem);\n";
+            out << "static int steps = 0;\n";
+            addr_t codeEnd = 1;
+            for (const auto& kv : insts) codeEnd = std::max<addr_t>(codeEnd, kv.first + kv.second.len);
+            out << "static const addr_t CODE_END = " << hex(codeEnd) << "ULL;\n";
+            out << "static bool isCode[CODE_END];  // 已编译指令占用的字节\n\n";
+
+            // 内存镜像：按非零字节段输出
+            std::vector<std::pair<addr_t, addr_t>> segs;
+            mem.forEachLiveWord([&](addr_t w, word_t val){
+                for (int i = 0; i < 8; i++){
+                    if ((static_cast<uint64_t>(val) >> (8 * i) & 0xFF) == 0) continue;
+                    addr_t a = w + i;
+                    if (!segs.empty() && a - segs.back().second <= 16) segs.back().second = a + 1;
+                    else segs.push_back({a, a + 1});
+                }
+            });
+            for (size_t i = 0; i < segs.size(); i++){
+                out << "static const byte_t SEG" << i << "[] = {";
+                std::vector<byte_t> bytes(segs[i].second - segs[i].first);
+                mem.readBlock(segs[i].first, bytes.data(), bytes.size());
+                for (size_t k = 0; k < bytes.size(); k++){
+                    if (k % 16 == 0) out << "\n    ";
+                    out << static_cast<int>(bytes[k]) << ",";
+                }
+                out << "\n};\n";
+            }
+            out << "\n";
+
+            out << "static void loadImage() {\n";
+            for (size_t i = 0; i < segs.size(); i++){
+                out << "    for (size_t i = 0; i < sizeof(SEG" << i << "); i++) mem.writeByte("
+                    << hex(segs[i].first) << " + i, SEG" << i << "[i]);\n";
+            }
+            for (const auto& kv : insts){
+                out << "    for (addr_t a = " << hex(kv.first) << "; a < " << hex(kv.first + kv.second.len)
+                    << "; a++) isCode[a] = true;\n";
+            }
+            out << "}\n\n";
+
+            out << "// 写入 [a, a+8) 是否会覆盖已编译的指令（调用前已保证 a 不越界）\n";
+            out << "static inline bool touchesCode(addr_t a) {\n";
+            out << "    for (int i = 0; i < 8; i++)\n";
+            out << "        if (a + i < CODE_END && isCode[a + i]) return true;\n";
+            out << "    return false;\n";
+            out << "}\n\n";
+
+            out << "// 与 y86-64_simulator 的主循环相同：每步之后输出一次状态\n";
+            out << "#define STEP()                                                      \\\n";
+            out << "    do {                                                            \\\n";
+            out << "        steps++;                                                    \\\n";
+            out << "        printStateJSON(cpu, steps);                                 \\\n";
+            out << "        if (cpu.stat != Stat::AOK || steps >= MAX_STEPS) goto done; \\\n";
+            out << "    } while (0)\n\n";
+        }
+
+        // 访存越界（或写入代码字节）时转入解释器，由它完成该指令并报告 ADR
+        void emitBoundsCheck(const DecodedInst& d, bool store){
+            out << "        if (a > MEM_SIZE - 8" << (store ? " || touchesCode(a)" : "")
+                << ") { cpu.PC = " << hex(d.pc) << "ULL; goto interp; }\n";
+        }
+
+        void emitInst(const DecodedInst& d, addr_t fallthrough){
+            out << label(d.pc) << ":  // " << hex(d.pc) << ": " << OP_NAMES[d.icode] << "\n";
+            out << "    {\n";
+
+            std::string next = hex(d.valP) + "ULL";
+            switch (d.icode){
+                case ICode::HALT:
+                    out << "        cpu.stat = Stat::HLT;\n";
+                    break;
+
+                case ICode::NOP:
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::RRMOVQ:
+                    if (d.ifunc == Cond::None) out << "        cpu.reg.setReg(" << reg(d.rB) << ", " << getReg(d.rA) << ");\n";
+                    else out << "        if (" << condExpr(d.ifunc) << ") cpu.reg.setReg(" << reg(d.rB) << ", " << getReg(d.rA) << ");\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::IRMOVQ:
+                    out << "        cpu.reg.setReg(" << reg(d.rB) << ", static_cast<word_t>(" << hex(d.valC) << "ULL));\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::RMMOVQ:
+                    out << "        addr_t a = " << hex(d.valC) << "ULL + static_cast<addr_t>(" << getReg(d.rB) << ");\n";
+                    emitBoundsCheck(d, true);
+                    out << "        mem.writeWord(a, " << getReg(d.rA) << ");\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::MRMOVQ:
+                    out << "        addr_t a = " << hex(d.valC) << "ULL + static_cast<addr_t>(" << getReg(d.rB) << ");\n";
+                    emitBoundsCheck(d, false);
+                    out << "        bool err;\n";
+                    out << "        cpu.reg.setReg(" << reg(d.rA) << ", mem.readWord(a, err));\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::OPQ:
+                    // 与 CPU::execALU 相同（永远是 b OP a），条件码与 CPU::setCC 一样只做记录
+                    out << "        word_t a = " << getReg(d.rA) << ", b = " << getReg(d.rB) << ";\n";
+                    switch (d.ifunc){
+                        case ALU::ADD:
+                            out << "        word_t e = static_cast<word_t>(static_cast<uint64_t>(b) + static_cast<uint64_t>(a));\n";
+                            out << "        cpu.cc.record(ALU::ADD, a, b, e);\n";
+                            break;
+                        case ALU::SUB:
+                            out << "        word_t e = static_cast<word_t>(static_cast<uint64_t>(b) - static_cast<uint64_t>(a));\n";
+                            out << "        cpu.cc.record(ALU::SUB, a, b, e);\n";
+                            break;
+                        case ALU::AND:
+                            out << "        word_t e = b & a;\n";
+                            out << "        cpu.cc.record(ALU::AND, a, b, e);\n";
+                            break;
+                        default:
+                            out << "        word_t e = b ^ a;\n";
+                            out << "        cpu.cc.record(ALU::XOR, a, b, e);\n";
+                            break;
+                    }
+                    out << "        cpu.reg.setReg(" << reg(d.rB) << ", e);\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::JXX:
+                    out << "        bool taken = " << condExpr(d.ifunc) << ";\n";
+                    out << "        cpu.PC = taken ? " << hex(d.valC) << "ULL : " << next << ";\n";
+                    out << "        STEP();\n";
+                    out << "        if (taken) goto " << target(d.valC) << ";\n";
+                    out << "    }\n";
+                    if (d.ifunc != Cond::None && d.valP != fallthrough) out << "    goto " << target(d.valP) << ";\n";
+                    out << "\n";
+                    return;
+
+                case ICode::CALL:
+                    out << "        addr_t a = static_cast<addr_t>(" << getReg(Reg::RSP) << ") - 8;\n";
+                    emitBoundsCheck(d, true);
+                    out << "        mem.writeWord(a, " << next << ");\n";
+                    out << "        cpu.reg.setReg(Reg::RSP, a);\n";
+                    out << "        cpu.PC = " << hex(d.valC) << "ULL;\n";
+                    out << "    }\n";
+                    out << "    STEP();\n";
+                    out << "    goto " << target(d.valC) << ";\n\n";
+                    return;
+
+                case ICode::RET:
+                    out << "        addr_t a = static_cast<addr_t>(" << getReg(Reg::RSP) << ");\n";
+                    emitBoundsCheck(d, false);
+                    out << "        bool err;\n";
+                    out << "        cpu.PC = mem.readWord(a, err);\n";
+                    out << "        cpu.reg.setReg(Reg::RSP, a + 8);\n";
+                    out << "    }\n";
+                    out << "    STEP();\n";
+                    out << "    goto dispatch;\n\n";
+                    return;
+
+                case ICode::PUSHQ:
+                    out << "        word_t v = " << getReg(d.rA) << ";\n";
+                    out << "        addr_t a = static_cast<addr_t>(" << getReg(Reg::RSP) << ") - 8;\n";
+                    emitBoundsCheck(d, true);
+                    out << "        mem.writeWord(a, v);\n";
+                    out << "        cpu.reg.setReg(Reg::RSP, a);\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+
+                case ICode::POPQ:
+                    out << "        addr_t a = static_cast<addr_t>(" << getReg(Reg::RSP) << ");\n";
+                    emitBoundsCheck(d, false);
+                    out << "        bool err;\n";
+                    out << "        word_t v = mem.readWord(a, err);\n";
+                    out << "        cpu.reg.setReg(Reg::RSP, a + 8);\n";
+                    out << "        cpu.reg.setReg(" << reg(d.rA) << ", v);  // popq %rsp 时以读出的值为准\n";
+                    out << "        cpu.PC = " << next << ";\n";
+                    break;
+            }
+
+            out << "    }\n";
+            out << "    STEP();\n";
+            if (d.valP != fallthrough) out << "    goto " << target(d.valP) << ";\n";
+            out << "\n";
+        }
+};
+
+int main(int argc, char* argv[]) {
+    std::string source = "<stdin>";
+    int fd = STDIN_FILENO;
+
+    if (argc > 2) {
+        std::cerr << "usage: " << argv[0] << " [program.yo] > program.cpp" << std::endl;
+        return 1;
+    }
+    if (argc == 2) {
+        source = argv[1];
+        fd = open(argv[1], O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "cannot open " << source << std::endl;
+            return 1;
+        }
+    }
+
+    Memory mem;
+    Image image;
+    bool loaded = Loader::loadFd(fd, mem, &image);
+    if (fd != STDIN_FILENO) close(fd);
+    if (!loaded) {
+        // 与 y86-64_simulator 相同：加载失败只输出空数组
+        std::cout << "// 由 yo2cpp 从 " << source << " 生成：加载失败\n"
+                  << "#include <iostream>\n\n"
+                  << "int main() {\n"
+                  << "    std::cout << \"[]\" << std::endl;\n"
+                  << "    return 0;\n"
+                  << "}\n";
+        return 0;
+    }
+
+    Compiler compiler(mem, image.entry, std::cout);
+    compiler.discover();
+    compiler.emit(source);
+    return 0;
+}
@@ -0,0 +1,56 @@
+// yo2ybo：把 .yo 文本转换为 .ybo 预编译镜像（格式见 loader.h）
+//
+// 用法：./yo2ybo program.yo program.ybo [--entry ADDR]
+//   ADDR 可以是十六进制地址或 .yo 中的标号，默认 0
+// y86-64_simulator / yo2cpp 根据文件头自动识别 .ybo，装入时整块复制内存段而不再解析文本
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../include/global.h"
+#include "../include/memory.h"
+#include "../include/loader.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3 && !(argc == 5 && std::string(argv[3]) == "--entry")) {
+        std::cerr << "usage: " << argv[0] << " program.yo program.ybo [--entry ADDR|LABEL]" << std::endl;
+        return 1;
+    }
+
+    Memory mem;
+    Image info;
+    if (!Loader::loadFile(argv[1], mem, &info)) {
+        std::cerr << "cannot load " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (argc == 5) {
+        std::string entry = argv[4];
+        bool found = false;
+        for (const auto& sym : info.symbols) {
+            if (sym.second == entry) {
+                info.entry = sym.first;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            char* end;
+            info.entry = std::strtoull(entry.c_str(), &end, 16);
+            if (entry.empty() || *end != '\0') {
+                std::cerr << "unknown entry " << entry << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::string image = Loader::buildImage(mem, info);
+    FILE* f = fopen(argv[2], "wb");
+    if (f == nullptr || fwrite(image.data(), 1, image.size(), f) != image.size()) {
+        std::cerr << "cannot write " << argv[2] << std::endl;
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    return 0;
+}
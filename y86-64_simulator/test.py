@@ -10,14 +10,27 @@ import pprint
 def main():
     args = parse_args()
     os.makedirs('temp_answer', exist_ok=True)
-    for filename in os.listdir('test'):
-        testname = filename.split('.')[0]
+    if args.lib:
+        # 通过 ctypes 直接调用 libY86.so，在进程内生成与模拟器相同的 trace
+        run_lib(args.lib)
+    elif args.batch:
+        # 一个进程内并行运行全部程序，trace 直接写到 temp_answer
         try:
-            # import ipdb; ipdb.set_trace()
-            subprocess.run(args.bin.split(" "), stdin=open(f"test/{filename}"), stdout=open(f"temp_answer/{testname}.json", 'w'), timeout=1)
+            result = subprocess.run(args.bin.split(" ") + ["--batch", "test", "--out", "temp_answer"],
+                                    stdout=subprocess.PIPE, text=True, timeout=10)
+            print(result.stdout.splitlines()[-1])
         except Exception as e:
             print(f"Execution failed: {e}")
             return
+    else:
+        for filename in os.listdir('test'):
+            testname = filename.split('.')[0]
+            try:
+                # import ipdb; ipdb.set_trace()
+                subprocess.run(args.bin.split(" "), stdin=open(f"test/{filename}"), stdout=open(f"temp_answer/{testname}.json", 'w'), timeout=1)
+            except Exception as e:
+                print(f"Execution failed: {e}")
+                return
 
     def try_read(file):
         # try to read it as json, if failed, try to read it as yaml
@@ -28,6 +41,10 @@ def main():
             pass
             
     res = {file: try_read(f"temp_answer/{file}") for file in os.listdir('temp_answer')}
+    if args.delta:
+        # 模拟器以 --trace delta 运行，先还原为完整状态再比较
+        from trace_expand import expand
+        res = {file: expand(states) if states is not None else None for file, states in res.items()}
     answer = {file: try_read(f"answer/{file}") for file in os.listdir('answer')}
 
     if not args.save_mid:
@@ -56,6 +73,57 @@ def main():
             return
     print("All correct!")
 
+REG_NAMES = ['rax', 'rcx', 'rdx', 'rbx', 'rsp', 'rbp', 'rsi', 'rdi',
+             'r8', 'r9', 'r10', 'r11', 'r12', 'r13', 'r14']
+
+def run_lib(path):
+    import ctypes
+    lib = ctypes.CDLL(os.path.abspath(path))
+    lib.y86_create.restype = ctypes.c_void_p
+    lib.y86_create.argtypes = [ctypes.c_uint64, ctypes.c_int]
+    lib.y86_destroy.argtypes = [ctypes.c_void_p]
+    lib.y86_load.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t]
+    lib.y86_run.restype = ctypes.c_uint64
+    lib.y86_run.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+    lib.y86_stat.argtypes = [ctypes.c_void_p]
+    lib.y86_pc.restype = ctypes.c_uint64
+    lib.y86_pc.argtypes = [ctypes.c_void_p]
+    lib.y86_cc.argtypes = [ctypes.c_void_p]
+    lib.y86_get_regs.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int64)]
+    lib.y86_live_words.restype = ctypes.c_size_t
+    lib.y86_live_words.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint64),
+                                   ctypes.POINTER(ctypes.c_int64), ctypes.c_size_t]
+
+    regs = (ctypes.c_int64 * 15)()
+    cap = 1024
+    addrs, values = (ctypes.c_uint64 * cap)(), (ctypes.c_int64 * cap)()
+    sim = lib.y86_create(0, 0)
+    for filename in os.listdir('test'):
+        testname = filename.split('.')[0]
+        with open(f"test/{filename}", 'rb') as f:
+            text = f.read()
+        states = []
+        if lib.y86_load(sim, text, len(text)) == 0:
+            while lib.y86_stat(sim) == 1 and len(states) < 10000:
+                lib.y86_run(sim, 1)
+                lib.y86_get_regs(sim, regs)
+                n = lib.y86_live_words(sim, addrs, values, cap)
+                if n > cap:
+                    cap = n
+                    addrs, values = (ctypes.c_uint64 * cap)(), (ctypes.c_int64 * cap)()
+                    lib.y86_live_words(sim, addrs, values, cap)
+                cc = lib.y86_cc(sim)
+                states.append({
+                    'CC': {'OF': cc >> 2 & 1, 'SF': cc >> 1 & 1, 'ZF': cc & 1},
+                    'MEM': {addrs[i]: values[i] for i in range(n)},
+                    'PC': lib.y86_pc(sim),
+                    'REG': {name: regs[i] for i, name in enumerate(REG_NAMES)},
+                    'STAT': lib.y86_stat(sim),
+                })
+        with open(f"temp_answer/{testname}.json", 'w') as f:
+            json.dump(states, f)
+    lib.y86_destroy(sim)
+
 # https://gist.github.com/ines/04b47597eb9d011ade5e77a068389521
 def diff_strings(a: str, b: str, *, use_loguru_colors: bool = False) -> str:
     output = []
@@ -85,10 +153,16 @@ def diff_strings(a: str, b: str, *, use_loguru_colors: bool = False) -> str:
 
 def parse_args():
     parser = argparse.ArgumentParser()
-    parser.add_argument('--bin', type=str, help='path to the executable file',required=True)
+    parser.add_argument('--bin', type=str, help='path to the executable file')
+    parser.add_argument('--lib', type=str, help='path to libY86.so, driven through ctypes instead of --bin')
     parse_args
     parser.add_argument('--save_mid',action='store_true',help='save the intermediate files')
-    return parser.parse_args()
+    parser.add_argument('--delta',action='store_true',help='the executable prints a delta trace (--trace delta)')
+    parser.add_argument('--batch',action='store_true',help='run the whole test directory in one process (--batch test --out temp_answer)')
+    args = parser.parse_args()
+    if args.bin is None and args.lib is None:
+        parser.error('one of --bin or --lib is required')
+    return args
                 
 if __name__ == "__main__":
     main()
\ No newline at end of file
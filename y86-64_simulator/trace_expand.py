@@ -0,0 +1,48 @@
+import sys
+import json
+import argparse
+
+REG_NAMES = ["rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+             "r8", "r9", "r10", "r11", "r12", "r13", "r14"]
+
+def expand(deltas):
+    """把 --trace delta 的输出还原为每步完整状态（与 answer/*.json 格式相同）"""
+    states = []
+    reg, cc, mem = {}, {}, {}
+    for d in deltas:
+        if d.get('KEY'):
+            reg = dict(d['REG'])
+            cc = dict(d['CC'])
+            mem = {str(k): v for k, v in d['MEM'].items()}
+        else:
+            reg.update(d.get('REG', {}))
+            cc.update(d.get('CC', {}))
+            for k, v in d.get('MEM', {}).items():
+                if v == 0:
+                    mem.pop(str(k), None)
+                else:
+                    mem[str(k)] = v
+        states.append({
+            'PC': d['PC'],
+            'STAT': d['STAT'],
+            'REG': {name: reg[name] for name in REG_NAMES},
+            'CC': {'ZF': cc['ZF'], 'SF': cc['SF'], 'OF': cc['OF']},
+            'MEM': {k: mem[k] for k in sorted(mem, key=int)},
+        })
+    return states
+
+def main():
+    parser = argparse.ArgumentParser(description='expand a delta trace into the full-state JSON format')
+    parser.add_argument('input', nargs='?', help='delta trace (default: stdin)')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = parser.parse_args()
+
+    src = open(args.input) if args.input else sys.stdin
+    states = expand(json.load(src))
+
+    dst = open(args.output, 'w') if args.output else sys.stdout
+    json.dump(states, dst, indent=2)
+    dst.write('\n')
+
+if __name__ == "__main__":
+    main()